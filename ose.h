@@ -50,6 +50,12 @@ extern "C" {
 #include "sys/ose_endian.h"
 #endif
 
+#ifdef OSE_CONF_PROFILE
+#include "sys/ose_time.h"
+#elif !defined(OSE_TIMED)
+#define OSE_TIMED(stat)
+#endif
+
 /**
    Debug mode
 */
@@ -257,6 +263,12 @@ typedef enum
 #define OSE_BUNDLE_HEADER OSE_BUNDLE_ID OSE_TIMETAG_NULL
 #define OSE_BUNDLE_HEADER_LEN (OSE_BUNDLE_ID_LEN + OSE_TIMETAG_LEN)
 
+/* '#' can't appear in an OSC method name, so the index message of
+   a dictionary can't be confused with an entry */
+#define OSE_DICT_INDEX_ADDRESS "/#dict"
+#define OSE_DICT_INDEX_ADDRESS_LEN 6
+#define OSE_DICT_INDEX_ADDRESS_SIZE 8
+
 #define OSE_EMPTY_TYPETAG_STRING ",\0\0\0"
 #define OSE_EMPTY_TYPETAG_STRING_LEN 1
 #define OSE_EMPTY_TYPETAG_STRING_SIZE 4
@@ -77,6 +77,28 @@ OSE_BUILTIN_DEFN(rot)
 OSE_BUILTIN_DEFN(swap)
 OSE_BUILTIN_DEFN(tuck)
 
+/* the variants of the stack operations that don't check the number
+   of elements, for the bodies that apply runs without a frame, whose
+   elements have been counted once, up front */
+#define OSE_BUILTIN_DEFN_UNCHECKED(name)                    \
+    void ose_builtin_##name##Unchecked(ose_bundle bundle)   \
+    {                                                       \
+        ose_##name##Unchecked(OSEVM_STACK(bundle));         \
+    }
+
+OSE_BUILTIN_DEFN_UNCHECKED(2drop)
+OSE_BUILTIN_DEFN_UNCHECKED(2dup)
+OSE_BUILTIN_DEFN_UNCHECKED(2over)
+OSE_BUILTIN_DEFN_UNCHECKED(2swap)
+OSE_BUILTIN_DEFN_UNCHECKED(drop)
+OSE_BUILTIN_DEFN_UNCHECKED(dup)
+OSE_BUILTIN_DEFN_UNCHECKED(nip)
+OSE_BUILTIN_DEFN_UNCHECKED(notrot)
+OSE_BUILTIN_DEFN_UNCHECKED(over)
+OSE_BUILTIN_DEFN_UNCHECKED(rot)
+OSE_BUILTIN_DEFN_UNCHECKED(swap)
+OSE_BUILTIN_DEFN_UNCHECKED(tuck)
+
 OSE_BUILTIN_DEFN(bundleAll)
 OSE_BUILTIN_DEFN(bundleFromBottom)
 OSE_BUILTIN_DEFN(bundleFromTop)
@@ -84,6 +106,7 @@ OSE_BUILTIN_DEFN(clear)
 OSE_BUILTIN_DEFN(clearPayload)
 OSE_BUILTIN_DEFN(join)
 OSE_BUILTIN_DEFN(pop)
+OSE_BUILTIN_DEFN(popSwap)
 OSE_BUILTIN_DEFN(popAll)
 OSE_BUILTIN_DEFN(popAllDrop)
 OSE_BUILTIN_DEFN(popAllBundle)
@@ -131,6 +154,11 @@ OSE_BUILTIN_DEFN(splitStringFromStart)
 OSE_BUILTIN_DEFN(swap4Bytes)
 OSE_BUILTIN_DEFN(swap8Bytes)
 OSE_BUILTIN_DEFN(swapNBytes)
+OSE_BUILTIN_DEFN(swapBlobByteOrder32)
+OSE_BUILTIN_DEFN(swapBlobByteOrder64)
+OSE_BUILTIN_DEFN(compressBlob)
+OSE_BUILTIN_DEFN(decompressBlob)
+OSE_BUILTIN_DEFN(swapItemsByteOrder)
 OSE_BUILTIN_DEFN(trimStringEnd)
 OSE_BUILTIN_DEFN(trimStringStart)
 OSE_BUILTIN_DEFN(match)
@@ -142,6 +170,17 @@ OSE_BUILTIN_DEFN(route)
 OSE_BUILTIN_DEFN(routeWithDelegation)
 OSE_BUILTIN_DEFN(gather)
 OSE_BUILTIN_DEFN(nth)
+OSE_BUILTIN_DEFN(peephole)
+OSE_BUILTIN_DEFN(sort)
+OSE_BUILTIN_DEFN(sortByAddress)
+OSE_BUILTIN_DEFN(sortByItem)
+OSE_BUILTIN_DEFN(topK)
+OSE_BUILTIN_DEFN(toDict)
+OSE_BUILTIN_DEFN(dictGet)
+OSE_BUILTIN_DEFN(dictPut)
+OSE_BUILTIN_DEFN(dictDelete)
+OSE_BUILTIN_DEFN(diff)
+OSE_BUILTIN_DEFN(patch)
 
 OSE_BUILTIN_DEFN(makeBlob)
 OSE_BUILTIN_DEFN(pushBundle)
@@ -338,7 +377,11 @@ void ose_builtin_dotimes(ose_bundle osevm)
     ose_bundle vm_c = OSEVM_CONTROL(osevm);
     ose_bundle vm_s = OSEVM_STACK(osevm);
     int32_t n = ose_popInt32(vm_s);
-    if(n > 0)
+    if(n > 0 && osevm_loopVerifiedBody(osevm, n))
+    {
+        ose_drop(vm_s);
+    }
+    else if(n > 0)
     {
         ose_pushInt32(vm_c, n - 1);
         ose_copyElem(vm_s, vm_c);
@@ -432,6 +475,50 @@ void ose_builtin_copyElem(ose_bundle osevm)
     ose_copyElem(src, dest);
 }
 
+static int32_t bodyHash(const char *p, int32_t n)
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    while(n-- > 0)
+    {
+        h ^= (unsigned char)*p++;
+        h *= 16777619u;
+    }
+    return (int32_t)h;
+}
+
+/* if the function body in the blob at offset bo of the message at
+   offset mo on top of the stack was verified when it was assigned,
+   checks once that the stack has the elements it needs, and applies
+   it without a frame. Returns false if it has to be applied the
+   usual way. */
+static bool applyVerified(ose_bundle osevm, int32_t mo, int32_t bo)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    const char * const b = ose_getBundlePtr(vm_s);
+    const int32_t size = ose_readInt32(vm_s, bo);
+    const int32_t need = osevm_lookupNeed(osevm, b + mo + 4, size,
+                                          bodyHash(b + bo + 4, size));
+    int32_t nelems = 0, o;
+    if(need < 0)
+    {
+        return false;
+    }
+    for(o = OSE_BUNDLE_HEADER_LEN;
+        o < mo && nelems < need;
+        o += ose_readInt32(vm_s, o) + 4)
+    {
+        ++nelems;
+    }
+    if(nelems < need)
+    {
+        ose_drop(vm_s);
+        ose_errno_set(osevm, OSE_ERR_ELEM_COUNT);
+        return true;
+    }
+    return osevm_applyVerifiedBody(osevm, bo);
+}
+
 void ose_builtin_apply(ose_bundle osevm)
 {
     ose_bundle vm_i = OSEVM_INPUT(osevm);
@@ -446,24 +533,34 @@ void ose_builtin_apply(ose_bundle osevm)
         char elemtype = ose_peekType(vm_s);
         if(elemtype == OSETT_BUNDLE)
         {
-            /* move input to dump */
-            ose_copyBundle(vm_i, vm_d);
-            ose_clear(vm_i);
+            int32_t stackoffset = OSE_BUNDLE_HEADER_LEN;
+            const int32_t stacksize = ose_readSize(vm_s);
+            ose_assert(stackoffset < stacksize);
+            int32_t s = ose_readInt32(vm_s, stackoffset);
+            while(stackoffset + s + 4 < stacksize)
+            {
+                stackoffset += s + 4;
+                s = ose_readInt32(vm_s, stackoffset);
+            }
+            /* if there's no more input and nothing left in control
+               but our own command, this is a tail call: returning
+               to this frame would do nothing other than restore the
+               env that the /</_e below would then overwrite, so
+               run the bundle in the current frame instead of
+               pushing a new one onto the dump */
+            const bool tail = ose_bundleIsEmpty(vm_i)
+                && !ose_bundleHasAtLeastNElems(vm_c, 2);
+            if(!tail)
+            {
+                /* move input to dump */
+                ose_copyBundle(vm_i, vm_d);
+                ose_clear(vm_i);
+            }
             {
                 /* move the contents of the bundle on the stack to
                    the input, and unpack it in reverse order */
                 char *sp = ose_getBundlePtr(vm_s);
                 char *ip = ose_getBundlePtr(vm_i);
-                int32_t stackoffset = OSE_BUNDLE_HEADER_LEN;
-                int32_t stacksize = ose_readSize(vm_s);
-                ose_assert(stackoffset < stacksize);
-                int32_t s = ose_readInt32(vm_s, stackoffset);
-                while(stackoffset + s + 4 < stacksize)
-                {
-                    stackoffset += s + 4;
-                    s = ose_readInt32(vm_s, stackoffset);
-                }
-
                 int32_t o1, o2;
                 o1 = stackoffset + 4 + OSE_BUNDLE_HEADER_LEN;
                 ose_incSize(vm_i, s - OSE_BUNDLE_HEADER_LEN);
@@ -478,6 +575,10 @@ void ose_builtin_apply(ose_bundle osevm)
                 }
                 ose_dropAtOffset(vm_s, stackoffset);
             }
+            if(tail)
+            {
+                break;
+            }
 
             /* copy environment to dump */
             ose_copyBundle(vm_e, vm_d);
@@ -546,7 +647,15 @@ void ose_builtin_apply(ose_bundle osevm)
                                p + 4,
                                OSE_BUNDLE_ID_LEN))
                 {
-                    /* blob is a bundle */
+                    /* blob is a bundle. If it was verified when
+                       it was assigned, the elements it needs are
+                       checked for once, here, rather than by each
+                       of the builtins it calls. */
+                    if(applyVerified(osevm, o,
+                                     p - ose_getBundlePtr(vm_s)))
+                    {
+                        break;
+                    }
                     ose_blobToElem(vm_s);
                     continue;
                 }
@@ -594,6 +703,10 @@ void ose_builtin_map(ose_bundle osevm)
     ose_bundle vm_s = OSEVM_STACK(osevm);
     ose_bundle vm_c = OSEVM_CONTROL(osevm);
     ose_rassert(ose_bundleHasAtLeastNElems(vm_s, 2), 1);
+    if(osevm_loopVerifiedBody(osevm, -1))
+    {
+        return;
+    }
     ose_swap(vm_s);
     char t = ose_peekType(vm_s);
     if(t == OSETT_BUNDLE)
@@ -655,8 +768,7 @@ void ose_builtin_map(ose_bundle osevm)
             ose_swap(vm_s);
             ose_copyElem(vm_s, vm_c);
             ose_swap(vm_s);
-            ose_pop(vm_s);
-            ose_swap(vm_s);
+            ose_popSwap(vm_s);
             ose_copyElem(vm_s, vm_c);
             ose_drop(vm_s);
             ose_swap(vm_s);
@@ -670,6 +782,326 @@ void ose_builtin_map(ose_bundle osevm)
     }
 }
 
+/*
+  /map/parallel
+
+  Maps a function over the items of a message the way /map does,
+  but splits the items into chunks, and maps the function over each
+  chunk on a worker VM, with the loops run by ose_parallelFor. The
+  workers are built in the upper two thirds of the free space of
+  the stack, and each gets a copy of the env. Their results are copied
+  back in order, so the stack ends up as it would after /map.
+
+  This is only done for a function body whose
+  stack effect osevm_verifyBody can work out, and that needs at
+  most the item it's applied to. If a worker changes its env or
+  output, suspends, or comes close to running out of stack, or if the
+  results don't fit, the workers are thrown away and /map is called
+  instead. The hooks of the VM are called from
+  the threads of the workers.
+*/
+
+#ifndef OSEVM_HAVE_SIZES
+struct mapParallel
+{
+    ose_bundle osevm;
+    /* offsets of the list and function on the stack */
+    int32_t mo, fo;
+    int32_t nitems;
+    int32_t nchunks;
+    /* where the workers are built, and their sizes */
+    int32_t wo;
+    int32_t wsize;
+    int32_t csize;
+    int32_t ssize;
+    ose_bundle workers[OSEVM_MAP_CHUNKS];
+    /* the size of the results of each worker, or -1 */
+    int32_t rsize[OSEVM_MAP_CHUNKS];
+};
+
+/* maps the function over items start up to end of the list, on a
+   worker built at p. Returns the size of the results, or -1. */
+static int32_t mapParallelChunk(struct mapParallel *m,
+                                ose_bundle *worker,
+                                char *p,
+                                int32_t start,
+                                int32_t end)
+{
+    ose_bundle vm_s = OSEVM_STACK(m->osevm);
+    ose_bundle vm_e = OSEVM_ENV(m->osevm);
+    const char * const sb = ose_getBundlePtr(vm_s);
+    const int32_t es = ose_readSize(vm_e);
+    ose_bundle w = ose_newBundleFromCBytes(m->wsize, p);
+    w = osevm_init(w, m->csize, m->ssize,
+                   es + OSE_CONTEXT_MESSAGE_OVERHEAD,
+                   m->csize, m->csize, m->csize);
+    *worker = w;
+    ose_bundle w_s = OSEVM_STACK(w);
+    ose_bundle w_e = OSEVM_ENV(w);
+    ose_bundle w_o = OSEVM_OUTPUT(w);
+    const int32_t fs = ose_readInt32(vm_s, m->fo) + 4;
+    int32_t o, i, grow = 0;
+
+    /* copy the env, and the records of the stack effects of the
+       bodies in it */
+    ose_addToSize(w_e, es - OSE_BUNDLE_HEADER_LEN);
+    memcpy(ose_getBundlePtr(w_e) + OSE_BUNDLE_HEADER_LEN,
+           ose_getBundlePtr(vm_e) + OSE_BUNDLE_HEADER_LEN,
+           es - OSE_BUNDLE_HEADER_LEN);
+    memcpy(ose_getBundlePtr(w) + OSEVM_CACHE_NEED,
+           ose_getBundlePtr(m->osevm) + OSEVM_CACHE_NEED,
+           16 * OSEVM_CACHE_NEED_NRECORDS);
+
+    /* the items of the chunk are kept in a message of their own in
+       the output, out of the way of the function, and popped from it
+       one at a time, last first, as /map would */
+    {
+        const int32_t tto = m->mo + 4
+            + ose_getPaddedStringLen(vm_s, m->mo + 4);
+        int32_t po = tto + ose_getPaddedStringLen(vm_s, tto);
+        int32_t pstart = po;
+        for(i = 0; i < end; i++)
+        {
+            if(i == start)
+            {
+                pstart = po;
+            }
+            po += ose_getPayloadItemSize(vm_s, sb[tto + 1 + i], po);
+        }
+        const int32_t ttsize = ose_pnbytes(1 + end - start);
+        const int32_t s = OSE_ADDRESS_ANONVAL_SIZE + ttsize
+            + (po - pstart);
+        char *b = ose_getBundlePtr(w_o);
+        o = ose_readSize(w_o);
+        ose_addToSize(w_o, s + 4);
+        ose_writeInt32(w_o, o, s);
+        o += 4;
+        memcpy(b + o, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
+        o += OSE_ADDRESS_ANONVAL_SIZE;
+        b[o] = OSETT_ID;
+        memcpy(b + o + 1, sb + tto + 1 + start, end - start);
+        o += ttsize;
+        memcpy(b + o, sb + pstart, po - pstart);
+    }
+    for(i = end - 1; i >= start; i--)
+    {
+        const int32_t ss = ose_readSize(w_s);
+        int32_t os;
+        ose_pop(w_o);
+        ose_moveElem(w_o, w_s);
+        os = ose_readSize(w_o);
+        o = ose_readSize(w_s);
+        ose_addToSize(w_s, fs);
+        memcpy(ose_getBundlePtr(w_s) + o, sb + m->fo, fs);
+        ose_pushString(OSEVM_INPUT(w), "/!/apply");
+        osevm_run(w);
+        if(osevm_isSuspended(w)
+           || ose_readSize(w_o) != os
+           || ose_readSize(w_e) != es
+           || memcmp(ose_getBundlePtr(w_e), ose_getBundlePtr(vm_e), es))
+        {
+            return -1;
+        }
+        /* nothing checks the stack of a worker for overflow, so give
+           up on this chunk if the stack may not hold another item,
+           the function, and twice as much as any application so far
+           has added to it */
+        if(ose_readSize(w_s) - ss > grow)
+        {
+            grow = ose_readSize(w_s) - ss;
+        }
+        if(i > start
+           && ose_spaceAvailable(w_s) < 2 * grow + fs
+           + ose_readInt32(w_o, OSE_BUNDLE_HEADER_LEN))
+        {
+            return -1;
+        }
+    }
+    return ose_readSize(w_s) - OSE_BUNDLE_HEADER_LEN;
+}
+
+static void mapParallelChunks(void *context, int32_t start, int32_t end)
+{
+    struct mapParallel *m = (struct mapParallel *)context;
+    char *p = ose_getBundlePtr(OSEVM_STACK(m->osevm)) + m->wo;
+    int32_t c;
+    for(c = start; c < end; c++)
+    {
+        /* chunk 0 is the end of the list, since /map starts there */
+        m->rsize[c] =
+            mapParallelChunk(m, m->workers + c, p + c * m->wsize,
+                             m->nitems - ((c + 1) * m->nitems)
+                             / m->nchunks,
+                             m->nitems - (c * m->nitems) / m->nchunks);
+    }
+}
+
+/* decides whether the list and function on the stack can be mapped
+   in parallel, and if so, how to split them up */
+static bool mapParallelInit(struct mapParallel *m, ose_bundle osevm)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    const char * const b = ose_getBundlePtr(vm_s);
+    const int32_t s = ose_readSize(vm_s);
+    const int32_t ts = s + ose_spaceAvailable(vm_s);
+    const int32_t es = ose_readSize(OSEVM_ENV(osevm));
+    int32_t o = OSE_BUNDLE_HEADER_LEN, bo, need, tto, chunk;
+    m->osevm = osevm;
+    m->mo = m->fo = -1;
+    while(o < s)
+    {
+        m->mo = m->fo;
+        m->fo = o;
+        o += ose_readInt32(vm_s, o) + 4;
+    }
+    if(m->mo < 0
+       || ose_getBundleElemType(vm_s, m->mo) != OSETT_MESSAGE)
+    {
+        return false;
+    }
+    tto = m->mo + 4 + ose_getPaddedStringLen(vm_s, m->mo + 4);
+    if(tto >= m->mo + 4 + ose_readInt32(vm_s, m->mo))
+    {
+        return false;
+    }
+    m->nitems = strlen(b + tto) - 1;
+    if(m->nitems < 2)
+    {
+        return false;
+    }
+
+    /* the function has to be a body, either on its own, or in a
+       blob, as it is when it's been looked up */
+    if(ose_getBundleElemType(vm_s, m->fo) == OSETT_BUNDLE)
+    {
+        bo = m->fo;
+    }
+    else
+    {
+        tto = m->fo + 4 + ose_getPaddedStringLen(vm_s, m->fo + 4);
+        bo = tto + ose_getPaddedStringLen(vm_s, tto);
+        if(tto >= m->fo + 4 + ose_readInt32(vm_s, m->fo)
+           || b[tto + 1] != OSETT_BLOB
+           || ose_readInt32(vm_s, bo) < OSE_BUNDLE_HEADER_LEN
+           || strncmp(b + bo + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+        {
+            return false;
+        }
+    }
+    need = osevm_verifyBody(osevm, vm_s, bo);
+    if(need < 0 || need > 1)
+    {
+        return false;
+    }
+
+    /* the results have to fit in the lower third of the free space,
+       and each worker gets an equal share of the rest. Its control
+       and dump have to hold its share of the list and the function a
+       couple of times over, and its stack gets what's left, which
+       has to be enough for its share of the list, the function, and
+       its share of the space for the results, since nothing checks
+       it for overflow */
+    m->wo = (s + (ts - s) / 3 + 3) & ~3;
+    m->nchunks = m->nitems < OSEVM_MAP_CHUNKS
+        ? m->nitems : OSEVM_MAP_CHUNKS;
+    while(m->nchunks >= 2)
+    {
+        chunk = ose_readInt32(vm_s, m->mo) / m->nchunks
+            + 2 * ose_readInt32(vm_s, m->fo) + 64;
+        m->wsize = ((ts - m->wo) / m->nchunks) & ~3;
+        m->csize = (OSE_CONTEXT_MESSAGE_OVERHEAD + 2 * chunk + 3) & ~3;
+        m->ssize = (m->wsize - OSE_CONTEXT_ALIGNMENT * 2
+                    - osevm_computeSizeReqs(0, 0, es, 0, 0, 0, 0)
+                    - OSE_CONTEXT_MESSAGE_OVERHEAD
+                    - 4 * m->csize) & ~3;
+        if(m->ssize >= OSE_CONTEXT_MESSAGE_OVERHEAD + chunk
+           + (m->wo - m->mo) / m->nchunks)
+        {
+            return true;
+        }
+        m->nchunks /= 2;
+    }
+    return false;
+}
+
+/* replaces the list and function with the results of the workers,
+   followed by the function and the emptied list, as /map would
+   leave them. Returns false, without changing anything, if a worker
+   failed or the results don't fit below the workers */
+static bool mapParallelDone(struct mapParallel *m)
+{
+    ose_bundle vm_s = OSEVM_STACK(m->osevm);
+    char *b = ose_getBundlePtr(vm_s);
+    const int32_t s = ose_readSize(vm_s);
+    const int32_t ms = ose_readInt32(vm_s, m->mo) + 4;
+    const int32_t fs = ose_readInt32(vm_s, m->fo) + 4;
+    const int32_t as = ose_getPaddedStringLen(vm_s, m->mo + 4);
+    /* the emptied list */
+    const int32_t es = 4 + as + 4;
+    int32_t rs = 0, o, c;
+    for(c = 0; c < m->nchunks; c++)
+    {
+        if(m->rsize[c] < 0)
+        {
+            return false;
+        }
+        rs += m->rsize[c];
+    }
+    if(s + es + 4 > m->wo
+       || m->mo + rs + fs + es + 4 > m->wo)
+    {
+        return false;
+    }
+    /* build the emptied list past the end, so that it can be moved
+       along with the function */
+    *((int32_t *)(b + s)) = ose_htonl(es - 4);
+    memcpy(b + s + 4, b + m->mo + 4, as);
+    memset(b + s + 4 + as, 0, 4);
+    b[s + 4 + as] = OSETT_ID;
+    memmove(b + m->mo + rs, b + m->mo + ms, fs + es);
+    o = m->mo;
+    for(c = 0; c < m->nchunks; c++)
+    {
+        memcpy(b + o,
+               ose_getBundlePtr(OSEVM_STACK(m->workers[c]))
+               + OSE_BUNDLE_HEADER_LEN,
+               m->rsize[c]);
+        o += m->rsize[c];
+    }
+    o += fs + es;
+    ose_addToSize(vm_s, o - s);
+    return true;
+}
+#endif
+
+void ose_builtin_mapParallel(ose_bundle osevm)
+{
+    ose_rassert(ose_bundleHasAtLeastNElems(OSEVM_STACK(osevm), 2), 1);
+#ifndef OSEVM_HAVE_SIZES
+    {
+        ose_bundle vm_s = OSEVM_STACK(osevm);
+        struct mapParallel m;
+        if(mapParallelInit(&m, osevm))
+        {
+            const int32_t ts = ose_readSize(vm_s)
+                + ose_spaceAvailable(vm_s);
+            bool done;
+            ose_parallelFor(m.nchunks, mapParallelChunks, &m);
+            done = mapParallelDone(&m);
+            /* clear the workers, and anything that was left behind
+               past the end of the stack */
+            memset(ose_getBundlePtr(vm_s) + ose_readSize(vm_s) + 4, 0,
+                   ts - ose_readSize(vm_s) - 4);
+            if(done)
+            {
+                return;
+            }
+        }
+    }
+#endif
+    ose_builtin_map(osevm);
+}
+
 void ose_builtin_return(ose_bundle osevm)
 {
     ose_bundle vm_i = OSEVM_INPUT(osevm);
@@ -681,12 +1113,23 @@ void ose_builtin_return(ose_bundle osevm)
     /* restore control */
     ose_replaceBundle(vm_d, vm_c);
 
-    ose_bundleAll(vm_s);
-    ose_moveElem(vm_d, vm_s);
-    ose_swap(vm_s);
-    ose_push(vm_s);
-    ose_unpackDrop(vm_s);
-    ose_unpackDrop(vm_s);
+    /* the saved stack is almost always empty, in which case the
+       current stack is already the result, and there's no need to
+       bundle it up and unpack it again */
+    if(ose_readInt32(vm_d, ose_getLastBundleElemOffset(vm_d))
+       == OSE_BUNDLE_HEADER_LEN)
+    {
+        ose_drop(vm_d);
+    }
+    else
+    {
+        ose_bundleAll(vm_s);
+        ose_moveElem(vm_d, vm_s);
+        ose_swap(vm_s);
+        ose_push(vm_s);
+        ose_unpackDrop(vm_s);
+        ose_unpackDrop(vm_s);
+    }
 
     /* put the env on the stack */
     ose_copyBundle(vm_e, vm_s);
@@ -709,12 +1152,60 @@ void ose_builtin_version(ose_bundle osevm)
     ose_pushString(vm_s, ose_date_compiled);
 }
 
+void ose_builtin_suspend(ose_bundle osevm)
+{
+    osevm_suspend(osevm);
+}
+
+static void pushContextStats(ose_bundle vm_s,
+                             ose_bundle context,
+                             const char * const address)
+{
+    const int32_t size = ose_readSize(context);
+    const int32_t total = size + ose_spaceAvailable(context);
+#ifdef OSE_CONF_CONTEXT_STATS
+    int32_t peaksize, peakelems, overflows;
+    ose_getContextStats(context, &peaksize, &peakelems, &overflows);
+    ose_pushMessage(vm_s, address, strlen(address), 5,
+                    OSETT_INT32, size,
+                    OSETT_INT32, total,
+                    OSETT_INT32, peaksize,
+                    OSETT_INT32, peakelems,
+                    OSETT_INT32, overflows);
+#else
+    ose_pushMessage(vm_s, address, strlen(address), 2,
+                    OSETT_INT32, size,
+                    OSETT_INT32, total);
+#endif
+}
+
+/*
+  Pushes a bundle with a message for each context of the VM, with
+  the size of its bundle and the total space available to it, and
+  if OSE_CONF_CONTEXT_STATS is defined, its peak size, peak number
+  of elements, and number of near overflows.
+*/
+void ose_builtin_stats(ose_bundle osevm)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    pushContextStats(vm_s, OSEVM_INPUT(osevm), OSEVM_ADDR_INPUT);
+    pushContextStats(vm_s, vm_s, OSEVM_ADDR_STACK);
+    pushContextStats(vm_s, OSEVM_ENV(osevm), OSEVM_ADDR_ENV);
+    pushContextStats(vm_s, OSEVM_CONTROL(osevm), OSEVM_ADDR_CONTROL);
+    pushContextStats(vm_s, OSEVM_DUMP(osevm), OSEVM_ADDR_DUMP);
+    pushContextStats(vm_s, OSEVM_OUTPUT(osevm), OSEVM_ADDR_OUTPUT);
+    ose_pushInt32(vm_s, 6);
+    ose_bundleFromTop(vm_s);
+}
+
 void ose_builtin_assignStackToEnv(ose_bundle osevm)
 {
     ose_bundle vm_s = OSEVM_STACK(osevm);
     ose_bundle vm_e = OSEVM_ENV(osevm);
 
     const char * const str = ose_peekString(vm_s);
+    bool named = false;
+    int32_t need = -1, size = 0, hash = 0;
     if((OSE_ADDRESS_ANONVAL_LEN > 0
         && !strcmp(str, OSE_ADDRESS_ANONVAL))
        || strlen(str) == 0)
@@ -732,6 +1223,7 @@ void ose_builtin_assignStackToEnv(ose_bundle osevm)
             ose_pushString(vm_e, ose_peekString(vm_s));
         }
         ose_drop(vm_e);
+        named = true;
     }
     while(1)
     {
@@ -743,6 +1235,16 @@ void ose_builtin_assignStackToEnv(ose_bundle osevm)
         ose_swap(vm_s);
         if(ose_peekType(vm_s) == OSETT_BUNDLE)
         {
+            if(n == 2 && named)
+            {
+                /* a function body whose stack effect can be worked
+                   out now gets a record of it in the cache of the
+                   VM, for apply */
+                const int32_t o = ose_getLastBundleElemOffset(vm_s);
+                need = osevm_verifyBody(osevm, vm_s, o);
+                size = ose_readInt32(vm_s, o);
+                hash = bodyHash(ose_getBundlePtr(vm_s) + o + 4, size);
+            }
             ose_elemToBlob(vm_s);
         }
         ose_swap(vm_s);
@@ -751,6 +1253,14 @@ void ose_builtin_assignStackToEnv(ose_bundle osevm)
     ose_moveStringToAddress(vm_s);
     ose_moveElem(vm_s, vm_e);
     ose_clear(vm_s);
+    if(named)
+    {
+        /* the name is now the address of what was assigned */
+        osevm_recordNeed(osevm,
+                         ose_getBundlePtr(vm_e)
+                         + ose_getLastBundleElemOffset(vm_e) + 4,
+                         size, hash, need);
+    }
 }
 
 void ose_builtin_lookupInEnv(ose_bundle osevm)
@@ -761,7 +1271,7 @@ void ose_builtin_lookupInEnv(ose_bundle osevm)
     const char * const address = ose_peekString(vm_s);
     int32_t mo = 0;
     {
-        mo = ose_getFirstOffsetForMatch(vm_e, address);
+        mo = ose_getFirstOffsetForPaddedMatch(vm_e, address);
     }
     if(mo >= OSE_BUNDLE_HEADER_LEN)
     {
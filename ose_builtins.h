@@ -49,6 +49,18 @@ OSE_BUILTIN_DECL(rollMatch)
 OSE_BUILTIN_DECL(rot)
 OSE_BUILTIN_DECL(swap)
 OSE_BUILTIN_DECL(tuck)
+OSE_BUILTIN_DECL(2dropUnchecked)
+OSE_BUILTIN_DECL(2dupUnchecked)
+OSE_BUILTIN_DECL(2overUnchecked)
+OSE_BUILTIN_DECL(2swapUnchecked)
+OSE_BUILTIN_DECL(dropUnchecked)
+OSE_BUILTIN_DECL(dupUnchecked)
+OSE_BUILTIN_DECL(nipUnchecked)
+OSE_BUILTIN_DECL(notrotUnchecked)
+OSE_BUILTIN_DECL(overUnchecked)
+OSE_BUILTIN_DECL(rotUnchecked)
+OSE_BUILTIN_DECL(swapUnchecked)
+OSE_BUILTIN_DECL(tuckUnchecked)
 
 OSE_BUILTIN_DECL(bundleAll)
 OSE_BUILTIN_DECL(bundleFromBottom)
@@ -57,6 +69,7 @@ OSE_BUILTIN_DECL(clear)
 OSE_BUILTIN_DECL(clearPayload)
 OSE_BUILTIN_DECL(join)
 OSE_BUILTIN_DECL(pop)
+OSE_BUILTIN_DECL(popSwap)
 OSE_BUILTIN_DECL(popAll)
 OSE_BUILTIN_DECL(popAllDrop)
 OSE_BUILTIN_DECL(popAllBundle)
@@ -104,6 +117,11 @@ OSE_BUILTIN_DECL(splitStringFromStart)
 OSE_BUILTIN_DECL(swap4Bytes)
 OSE_BUILTIN_DECL(swap8Bytes)
 OSE_BUILTIN_DECL(swapNBytes)
+OSE_BUILTIN_DECL(swapBlobByteOrder32)
+OSE_BUILTIN_DECL(swapBlobByteOrder64)
+OSE_BUILTIN_DECL(compressBlob)
+OSE_BUILTIN_DECL(decompressBlob)
+OSE_BUILTIN_DECL(swapItemsByteOrder)
 OSE_BUILTIN_DECL(trimStringEnd)
 OSE_BUILTIN_DECL(trimStringStart)
 OSE_BUILTIN_DECL(match)
@@ -115,6 +133,17 @@ OSE_BUILTIN_DECL(route)
 OSE_BUILTIN_DECL(routeWithDelegation)
 OSE_BUILTIN_DECL(gather)
 OSE_BUILTIN_DECL(nth)
+OSE_BUILTIN_DECL(peephole)
+OSE_BUILTIN_DECL(sort)
+OSE_BUILTIN_DECL(sortByAddress)
+OSE_BUILTIN_DECL(sortByItem)
+OSE_BUILTIN_DECL(topK)
+OSE_BUILTIN_DECL(toDict)
+OSE_BUILTIN_DECL(dictGet)
+OSE_BUILTIN_DECL(dictPut)
+OSE_BUILTIN_DECL(dictDelete)
+OSE_BUILTIN_DECL(diff)
+OSE_BUILTIN_DECL(patch)
 
 OSE_BUILTIN_DECL(makeBlob)
 OSE_BUILTIN_DECL(pushBundle)
@@ -158,8 +187,11 @@ void ose_builtin_assign(ose_bundle osevm);
 void ose_builtin_lookup(ose_bundle osevm);
 void ose_builtin_apply(ose_bundle osevm);
 void ose_builtin_map(ose_bundle osevm);
+void ose_builtin_mapParallel(ose_bundle osevm);
 void ose_builtin_return(ose_bundle osevm);
 void ose_builtin_version(ose_bundle osevm);
+void ose_builtin_suspend(ose_bundle osevm);
+void ose_builtin_stats(ose_bundle osevm);
 
 void ose_builtin_assignStackToEnv(ose_bundle osevm);
 void ose_builtin_lookupInEnv(ose_bundle osevm);
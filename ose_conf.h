@@ -194,6 +194,28 @@ extern "C" {
 */
 /* #define OSE_CONF_DEBUG */
 
+/**
+   Context statistics
+
+   Each context message keeps the peak size of its bundle, the peak
+   number of elements in it, and the number of times it has come
+   close to running out of space, which can be read with
+   #ose_getContextStats(), or from a VM with /stats. This adds 12
+   bytes to every context message.
+*/
+/* #define OSE_CONF_CONTEXT_STATS */
+
+/**
+   Profiling
+
+   Blocks of the library wrapped in OSE_TIMED add the ticks they
+   take to a struct ose_timestat, such as the time each VM spends
+   applying control elements, which osevm_getApplyTime reads.
+   Without this, OSE_TIMED compiles to nothing. The ticks are
+   converted to nanoseconds with the functions in sys/ose_time.h.
+*/
+/* #define OSE_CONF_PROFILE */
+
 /**
    The address of anonymous values. When a value is pushed onto the
    stack with a function like #ose_pushInt32(), it goes on as a
@@ -75,6 +75,33 @@ static int32_t writeContextMessage(ose_bundle bundle,
         p += 4;
         strncpy(p, address, alen);
         p += palen;
+#ifdef OSE_CONF_CONTEXT_STATS
+        /*
+          ,
+          i : peak size of the bundle
+          i : peak number of elements in the bundle
+          i : number of near overflows
+          i : status
+          i : offset of data section relative to start of bundle
+          i : total number of bytes
+          b : bundle (blob)
+          b : free space (blob)
+        */
+        strcpy(p, ",iiiiiibb");
+        p += 12;
+
+        /* peak size */
+        *((int32_t *)p) = ose_htonl(OSE_BUNDLE_HEADER_LEN);
+        p += 4;
+
+        /* peak elems */
+        *((int32_t *)p) = 0;
+        p += 4;
+
+        /* near overflows */
+        *((int32_t *)p) = 0;
+        p += 4;
+#else
         /*
           ,
           i : unused
@@ -90,6 +117,7 @@ static int32_t writeContextMessage(ose_bundle bundle,
         /* unused */
         *((int32_t *)p) = 0;
         p += 4; 
+#endif
 
         /* status */
         *((int32_t *)p) = 0;
@@ -261,6 +289,110 @@ int32_t ose_readSize(ose_constbundle bundle)
 }
 #endif
 
+#ifdef OSE_CONF_CONTEXT_STATS
+/* counts the elements that end before offset end */
+static int32_t countElems(ose_constbundle bundle, const int32_t end)
+{
+    int32_t n = 0;
+    int32_t o = OSE_BUNDLE_HEADER_LEN;
+    while(o < end)
+    {
+        const int32_t s = ose_readInt32_outOfBounds(bundle, o);
+        if(s < 0 || o + s + 4 > end)
+        {
+            break;
+        }
+        o += s + 4;
+        n++;
+    }
+    return n;
+}
+
+/*
+  Called when a bundle grows from os to ns1 bytes. Counting the
+  elements means walking all of them, so it's only done when the
+  bundle grows past the near overflow threshold, which is where the
+  count matters, rather than at every new peak, which would make
+  steady growth quadratic. The new bytes may not have been written
+  yet, so the elements are counted up to the old size.
+*/
+static void updateStats(ose_bundle bundle,
+                        const int32_t os,
+                        const int32_t ns1)
+{
+    const int32_t ts =
+        ose_readInt32_outOfBounds(bundle, OSE_CONTEXT_TOTAL_SIZE_OFFSET);
+    const int32_t threshold = ts - ts / OSE_CONTEXT_STATS_HEADROOM;
+    if(ns1 > ose_readInt32_outOfBounds(bundle,
+                                       OSE_CONTEXT_PEAK_SIZE_OFFSET))
+    {
+        ose_writeInt32_outOfBounds(bundle,
+                                   OSE_CONTEXT_PEAK_SIZE_OFFSET,
+                                   ns1);
+    }
+    if(ns1 > threshold && os <= threshold)
+    {
+        const int32_t n = countElems(bundle, os);
+        if(n > ose_readInt32_outOfBounds(bundle,
+                                         OSE_CONTEXT_PEAK_ELEMS_OFFSET))
+        {
+            ose_writeInt32_outOfBounds(bundle,
+                                       OSE_CONTEXT_PEAK_ELEMS_OFFSET,
+                                       n);
+        }
+        ose_writeInt32_outOfBounds(bundle,
+                                   OSE_CONTEXT_OVERFLOWS_OFFSET,
+                                   ose_readInt32_outOfBounds(bundle,
+                                                             OSE_CONTEXT_OVERFLOWS_OFFSET)
+                                   + 1);
+    }
+}
+
+void ose_getContextStats(ose_constbundle bundle,
+                         int32_t *peaksize,
+                         int32_t *peakelems,
+                         int32_t *overflows)
+{
+    ose_assert(ose_getBundlePtr(bundle));
+    ose_assert(ose_isBundle(bundle));
+    {
+        const int32_t s = ose_readSize(bundle);
+        const int32_t n = countElems(bundle, s);
+        const int32_t ps =
+            ose_readInt32_outOfBounds(bundle, OSE_CONTEXT_PEAK_SIZE_OFFSET);
+        const int32_t pn =
+            ose_readInt32_outOfBounds(bundle, OSE_CONTEXT_PEAK_ELEMS_OFFSET);
+        if(peaksize)
+        {
+            *peaksize = ps > s ? ps : s;
+        }
+        if(peakelems)
+        {
+            *peakelems = pn > n ? pn : n;
+        }
+        if(overflows)
+        {
+            *overflows =
+                ose_readInt32_outOfBounds(bundle,
+                                          OSE_CONTEXT_OVERFLOWS_OFFSET);
+        }
+    }
+}
+
+void ose_resetContextStats(ose_bundle bundle)
+{
+    ose_assert(ose_getBundlePtr(bundle));
+    ose_assert(ose_isBundle(bundle));
+    {
+        const int32_t s = ose_readSize(bundle);
+        ose_writeInt32_outOfBounds(bundle, OSE_CONTEXT_PEAK_SIZE_OFFSET, s);
+        ose_writeInt32_outOfBounds(bundle, OSE_CONTEXT_PEAK_ELEMS_OFFSET,
+                                   countElems(bundle, s));
+        ose_writeInt32_outOfBounds(bundle, OSE_CONTEXT_OVERFLOWS_OFFSET, 0);
+    }
+}
+#endif
+
 void ose_addToSize(ose_bundle bundle, const int32_t amt)
 {
     ose_assert(ose_getBundlePtr(bundle));
@@ -278,6 +410,12 @@ void ose_addToSize(ose_bundle bundle, const int32_t amt)
         {
             ose_writeInt32_outOfBounds(bundle, os, 0);
         }
+#ifdef OSE_CONF_CONTEXT_STATS
+        else
+        {
+            updateStats(bundle, os, ns1);
+        }
+#endif
         ose_writeInt32_outOfBounds(bundle, -4, ns1);
         ose_writeInt32_outOfBounds(bundle, ns1, ns2);
         ose_assert(ose_readSize(bundle) >= OSE_BUNDLE_HEADER_LEN);
@@ -298,6 +436,9 @@ void ose_incSize(ose_bundle bundle, const int32_t amt)
             ose_readInt32_outOfBounds(bundle,
                                       OSE_CONTEXT_TOTAL_SIZE_OFFSET) - ns1;
         ose_assert(ns2 >= 0);
+#ifdef OSE_CONF_CONTEXT_STATS
+        updateStats(bundle, os, ns1);
+#endif
         ose_writeInt32_outOfBounds(bundle, -4, ns1);
         ose_writeInt32_outOfBounds(bundle, ns1, ns2);
         ose_assert(ose_readSize(bundle) >= OSE_BUNDLE_HEADER_LEN);
@@ -366,28 +507,41 @@ void ose_copyBundle(ose_constbundle src, ose_bundle dest)
     }
 }
 
-int32_t ose_routeElemAtOffset(const int32_t srcoffset,
+int32_t ose_getRoutedElemSize(const int32_t srcoffset,
                               ose_constbundle src,
-                              const int32_t prefixlen,
-                              ose_bundle dest)
+                              const int32_t prefixlen)
+{
+    ose_assert(ose_getBundlePtr(src));
+    ose_assert(prefixlen >= 0);
+    ose_assert(prefixlen <= strlen(ose_getBundlePtr(src) + srcoffset + 4));
+    {
+        const char * const sb = ose_getBundlePtr(src);
+        const int32_t ss = ose_readInt32(src, srcoffset);
+        const int32_t addrlen = (int32_t)strlen(sb + srcoffset + 4);
+        const int32_t addrdiff = addrlen - prefixlen;
+        const int32_t newaddrlen = (addrdiff
+                                    ? addrdiff
+                                    : OSE_ADDRESS_ANONVAL_LEN);
+        return (ss - ose_pnbytes(addrlen)) + ose_pnbytes(newaddrlen);
+    }
+}
+
+int32_t ose_writeRoutedElemAtOffset(const int32_t srcoffset,
+                                    ose_constbundle src,
+                                    const int32_t prefixlen,
+                                    ose_bundle dest,
+                                    const int32_t destoffset)
 {
     ose_assert(ose_getBundlePtr(src));
-    ose_assert(ose_isBundle(src));
-    ose_assert(ose_bundleHasAtLeastNElems(src, 1));
     ose_assert(ose_getBundlePtr(dest));
-    ose_assert(ose_isBundle(dest));
-    ose_assert(srcoffset >= OSE_BUNDLE_HEADER_LEN);
-    ose_assert(srcoffset < ose_readSize(src));
-    ose_assert(ose_readInt32(src, srcoffset) > prefixlen);
-    ose_assert(ose_readInt32(src, srcoffset) + 4 + OSE_BUNDLE_HEADER_LEN <= ose_readSize(src));
     ose_assert(prefixlen >= 0);
     ose_assert(prefixlen <= strlen(ose_getBundlePtr(src) + srcoffset + 4));
     {
         const char * const sb = ose_getBundlePtr(src);
-        char *db = ose_getBundlePtr(dest);        
+        char *db = ose_getBundlePtr(dest);
         const int32_t so = srcoffset;
         const int32_t ss = ose_readInt32(src, so);
-        const int32_t d_o = ose_readSize(dest);
+        const int32_t d_o = destoffset;
         
         const int32_t addrlen = (int32_t)strlen(sb + srcoffset + 4);
         const int32_t addrdiff = addrlen - prefixlen;
@@ -401,7 +555,6 @@ int32_t ose_routeElemAtOffset(const int32_t srcoffset,
         int32_t i = so + 4 + prefixlen;
         int32_t c = d_o + 4;
         
-        ose_addToSize(dest, newsize + 4);
         ose_writeInt32(dest, d_o, newsize);
         
         if(addrdiff)
@@ -425,6 +578,33 @@ int32_t ose_routeElemAtOffset(const int32_t srcoffset,
     }
 }
 
+int32_t ose_routeElemAtOffset(const int32_t srcoffset,
+                              ose_constbundle src,
+                              const int32_t prefixlen,
+                              ose_bundle dest)
+{
+    ose_assert(ose_getBundlePtr(src));
+    ose_assert(ose_isBundle(src));
+    ose_assert(ose_bundleHasAtLeastNElems(src, 1));
+    ose_assert(ose_getBundlePtr(dest));
+    ose_assert(ose_isBundle(dest));
+    ose_assert(srcoffset >= OSE_BUNDLE_HEADER_LEN);
+    ose_assert(srcoffset < ose_readSize(src));
+    ose_assert(ose_readInt32(src, srcoffset) > prefixlen);
+    ose_assert(ose_readInt32(src, srcoffset) + 4 + OSE_BUNDLE_HEADER_LEN <= ose_readSize(src));
+    ose_assert(prefixlen >= 0);
+    ose_assert(prefixlen <= strlen(ose_getBundlePtr(src) + srcoffset + 4));
+    {
+        const int32_t d_o = ose_readSize(dest);
+        const int32_t newsize = ose_getRoutedElemSize(srcoffset,
+                                                      src,
+                                                      prefixlen);
+        ose_addToSize(dest, newsize + 4);
+        return ose_writeRoutedElemAtOffset(srcoffset, src, prefixlen,
+                                           dest, d_o);
+    }
+}
+
 void ose_appendBundle(ose_bundle src, ose_bundle dest)
 {
     ose_assert(ose_getBundlePtr(src));
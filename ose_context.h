@@ -100,6 +100,17 @@ extern "C" {
 #define OSE_CONTEXT_TOTAL_SIZE_OFFSET -8
 #define OSE_CONTEXT_PARENT_BUNDLE_OFFSET_OFFSET -12
 #define OSE_CONTEXT_STATUS_OFFSET -16
+#ifdef OSE_CONF_CONTEXT_STATS
+#define OSE_CONTEXT_OVERFLOWS_OFFSET -20
+#define OSE_CONTEXT_PEAK_ELEMS_OFFSET -24
+#define OSE_CONTEXT_PEAK_SIZE_OFFSET -28
+
+/**
+   @brief A bundle that grows to within 1/OSE_CONTEXT_STATS_HEADROOM
+   of its total size counts as a near overflow.
+*/
+#define OSE_CONTEXT_STATS_HEADROOM 8
+#endif
 
 #define ose_context_get_status(b)               \
     ose_ntohl(*((int32_t *)(ose_getBundlePtr(b) + \
@@ -116,6 +127,19 @@ extern "C" {
    @brief The number of bytes between the beginning of a context
    message and the bundle (blob).
 */
+#ifdef OSE_CONF_CONTEXT_STATS
+#define OSE_CONTEXT_BUNDLE_OFFSET                   \
+    (4          /* size */                          \
+     + 4            /* padded address len */        \
+     + 12           /* padded typetag str */        \
+     + 4            /* int - peak size */           \
+     + 4            /* int - peak elems */          \
+     + 4            /* int - near overflows */      \
+     + 4            /* int - status */              \
+     + 4            /* int - offset to bundle */    \
+     + 4            /* int - total size */          \
+     + 4)           /* blob size */
+#else
 #define OSE_CONTEXT_BUNDLE_OFFSET                   \
     (4          /* size */                          \
      + 4            /* padded address len */        \
@@ -125,6 +149,7 @@ extern "C" {
      + 4            /* int - offset to bundle */    \
      + 4            /* int - total size */          \
      + 4)           /* blob size */
+#endif
 
 
 
@@ -215,6 +240,34 @@ void ose_dropContextMessage(ose_bundle bundle);
 */
 int32_t ose_spaceAvailable(ose_constbundle bundle);
 
+#ifdef OSE_CONF_CONTEXT_STATS
+/**
+   @brief Get the statistics kept in the context message of a
+   bundle since it was created or last reset.
+
+   The peak size and number of near overflows are updated by
+   #ose_incSize and #ose_addToSize. The elements are only counted
+   when the bundle comes close to overflowing, and again here, so
+   the peak number of elements is the largest of those counts.
+
+   @param bundle The bundle.
+   @param peaksize The largest size the bundle has had.
+   @param peakelems The largest number of elements it has been seen
+   to have.
+   @param overflows The number of times it has grown to within
+   1/#OSE_CONTEXT_STATS_HEADROOM of its total size.
+*/
+void ose_getContextStats(ose_constbundle bundle,
+                         int32_t *peaksize,
+                         int32_t *peakelems,
+                         int32_t *overflows);
+
+/**
+   @brief Reset the statistics of a bundle to its current state.
+*/
+void ose_resetContextStats(ose_bundle bundle);
+#endif
+
 
 
 
@@ -409,6 +462,25 @@ int32_t ose_routeElemAtOffset(int32_t srcoffset,
                               int32_t prefixlen,
                               ose_bundle dest);
 
+/**
+   @brief Returns the size of the element at @p srcoffset once
+   @p prefixlen chars have been removed from the front of its
+   address.
+*/
+int32_t ose_getRoutedElemSize(int32_t srcoffset,
+                              ose_constbundle src,
+                              int32_t prefixlen);
+/**
+   @brief Like #ose_routeElemAtOffset, but writes the element at
+   @p destoffset without changing the size of @p dest. The space
+   must already be there, and zeroed.
+*/
+int32_t ose_writeRoutedElemAtOffset(int32_t srcoffset,
+                                    ose_constbundle src,
+                                    int32_t prefixlen,
+                                    ose_bundle dest,
+                                    int32_t destoffset);
+
 
 
 
@@ -0,0 +1,265 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software
+  and associated documentation files (the "Software"), to deal in
+  the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute,
+  sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the
+  following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "ose.h"
+#include "ose_context.h"
+#include "ose_util.h"
+#include "ose_assert.h"
+#include "ose_match.h"
+#include "ose_dispatch.h"
+
+/* returns a pointer to the end of the segment that starts at s,
+   including its leading slash, if it has one */
+static const char *segmentEnd(const char *s)
+{
+    if(*s == '/')
+    {
+        s++;
+    }
+    while(*s && *s != '/')
+    {
+        s++;
+    }
+    return s;
+}
+
+static int32_t segmentType(const char * const s, int32_t len)
+{
+    int32_t i = (*s == '/') ? 1 : 0;
+    if(len - i == 1 && s[i] == '*')
+    {
+        return OSE_DISPATCH_NODETYPE_WILDCARD;
+    }
+    for(; i < len; i++)
+    {
+        switch(s[i])
+        {
+        case '*':
+        case '?':
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+            return OSE_DISPATCH_NODETYPE_PATTERN;
+        }
+    }
+    return OSE_DISPATCH_NODETYPE_EXACT;
+}
+
+void ose_dispatch_init(struct ose_dispatcher *d,
+                       struct ose_dispatch_node *nodes,
+                       int32_t maxnodes,
+                       char *strings,
+                       int32_t stringsize)
+{
+    ose_assert(d);
+    ose_assert(nodes);
+    ose_assert(maxnodes > 0);
+    d->nodes = nodes;
+    d->maxnodes = maxnodes;
+    d->strings = strings;
+    d->maxstrings = stringsize;
+    d->nstrings = 0;
+    /* root */
+    memset(nodes, 0, sizeof(struct ose_dispatch_node));
+    nodes->child = -1;
+    nodes->sibling = -1;
+    d->nnodes = 1;
+}
+
+int ose_dispatch_register(struct ose_dispatcher *d,
+                          const char * const pattern,
+                          ose_dispatch_fn fn,
+                          void *context)
+{
+    ose_assert(d);
+    ose_assert(pattern);
+    int32_t n = 0;
+    const char *p = pattern;
+    while(*p)
+    {
+        const char * const e = segmentEnd(p);
+        const int32_t len = e - p;
+        int32_t c = d->nodes[n].child;
+        int32_t last = -1;
+        while(c >= 0)
+        {
+            const struct ose_dispatch_node * const cn = d->nodes + c;
+            if(cn->seglen == len
+               && !memcmp(d->strings + cn->seg, p, len))
+            {
+                break;
+            }
+            last = c;
+            c = cn->sibling;
+        }
+        if(c < 0)
+        {
+            if(d->nnodes >= d->maxnodes
+               || d->nstrings + len + 1 > d->maxstrings)
+            {
+                return -1;
+            }
+            c = d->nnodes++;
+            {
+                struct ose_dispatch_node * const cn = d->nodes + c;
+                memcpy(d->strings + d->nstrings, p, len);
+                d->strings[d->nstrings + len] = '\0';
+                cn->seg = d->nstrings;
+                cn->seglen = len;
+                cn->child = -1;
+                cn->sibling = -1;
+                cn->type = segmentType(p, len);
+                cn->fn = NULL;
+                cn->context = NULL;
+                d->nstrings += len + 1;
+            }
+            if(last < 0)
+            {
+                d->nodes[n].child = c;
+            }
+            else
+            {
+                d->nodes[last].sibling = c;
+            }
+        }
+        n = c;
+        p = e;
+    }
+    d->nodes[n].fn = fn;
+    d->nodes[n].context = context;
+    return 0;
+}
+
+static int32_t dispatchNode(const struct ose_dispatcher *d,
+                            int32_t n,
+                            const char * const address,
+                            ose_constbundle bundle,
+                            const struct ose_dispatch_msg * const msg)
+{
+    const struct ose_dispatch_node * const node = d->nodes + n;
+    if(!*address)
+    {
+        if(node->fn)
+        {
+            node->fn(bundle, msg, node->context);
+            return 1;
+        }
+        return 0;
+    }
+    int32_t count = 0;
+    const char * const e = segmentEnd(address);
+    const int32_t len = e - address;
+    int32_t c = node->child;
+    while(c >= 0)
+    {
+        const struct ose_dispatch_node * const cn = d->nodes + c;
+        const char * const seg = d->strings + cn->seg;
+        switch(cn->type)
+        {
+        case OSE_DISPATCH_NODETYPE_EXACT:
+            if(cn->seglen == len && !memcmp(seg, address, len))
+            {
+                count += dispatchNode(d, c, e, bundle, msg);
+            }
+            break;
+        case OSE_DISPATCH_NODETYPE_WILDCARD:
+            count += dispatchNode(d, c, e, bundle, msg);
+            break;
+        case OSE_DISPATCH_NODETYPE_PATTERN:
+        {
+            /* match just this segment: the pattern has to be used
+               up, and the address matched up to its next slash */
+            int po, ao;
+            int r = ose_match_pattern(seg, address, &po, &ao);
+            if((r & OSE_MATCH_PATTERN_COMPLETE) && ao == len)
+            {
+                count += dispatchNode(d, c, e, bundle, msg);
+            }
+        }
+            break;
+        }
+        c = cn->sibling;
+    }
+    return count;
+}
+
+int32_t ose_dispatch_message(const struct ose_dispatcher *d,
+                             ose_constbundle bundle,
+                             int32_t offset)
+{
+    ose_assert(d);
+    ose_assert(ose_getBundleElemType(bundle, offset) == OSETT_MESSAGE);
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readInt32(bundle, offset);
+    struct ose_dispatch_msg msg;
+    msg.offset = offset;
+    msg.ttoffset = offset + 4 + ose_getPaddedStringLen(bundle, offset + 4);
+    msg.nitems = 0;
+    msg.payloadoffset = msg.ttoffset;
+    if(msg.ttoffset < offset + 4 + s)
+    {
+        const int32_t ntt = strlen(b + msg.ttoffset);
+        msg.nitems = ntt ? ntt - 1 : 0;
+        msg.payloadoffset = msg.ttoffset + ose_pnbytes(ntt);
+    }
+    msg.payloadsize = (offset + 4 + s) - msg.payloadoffset;
+    return dispatchNode(d, 0, b + offset + 4, bundle, &msg);
+}
+
+static int32_t dispatchElems(const struct ose_dispatcher *d,
+                             ose_constbundle bundle,
+                             int32_t o,
+                             const int32_t end)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    int32_t count = 0;
+    while(o < end)
+    {
+        const int32_t s = ose_readInt32(bundle, o);
+        if(s >= OSE_BUNDLE_HEADER_LEN
+           && !strncmp(b + o + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+        {
+            count += dispatchElems(d, bundle,
+                                   o + 4 + OSE_BUNDLE_HEADER_LEN,
+                                   o + 4 + s);
+        }
+        else
+        {
+            count += ose_dispatch_message(d, bundle, o);
+        }
+        o += s + 4;
+    }
+    return count;
+}
+
+int32_t ose_dispatch_bundle(const struct ose_dispatcher *d,
+                            ose_constbundle bundle)
+{
+    ose_assert(d);
+    ose_assert(ose_isBundle(bundle));
+    return dispatchElems(d, bundle, OSE_BUNDLE_HEADER_LEN,
+                         ose_readSize(bundle));
+}
@@ -0,0 +1,142 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software
+  and associated documentation files (the "Software"), to deal in
+  the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute,
+  sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the
+  following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+*/
+
+/** @file ose_dispatch.h
+    @brief Dispatch the messages of a bundle to C callbacks.
+
+    Callbacks are registered against address patterns, which are
+    split into segments and stored in a tree. A segment is either
+    an exact string, a lone "*", which matches any segment, or a
+    pattern, which is matched against a single segment of the
+    address with #ose_match_pattern. Dispatching a message walks the
+    tree once, and every callback whose pattern matches the address
+    of the message is called with the offsets of its parts in the
+    bundle, so nothing is copied.
+
+    The dispatcher does no allocation: the nodes of the tree and
+    the segment strings are stored in memory supplied by the
+    caller.
+*/
+
+#ifndef OSE_DISPATCH_H
+#define OSE_DISPATCH_H
+
+#include "ose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   @brief Where the parts of a message are in the bundle being
+   dispatched.
+*/
+struct ose_dispatch_msg
+{
+    /** offset of the message element (its size) */
+    int32_t offset;
+    /** offset of the typetag string, starting with the comma */
+    int32_t ttoffset;
+    /** number of items */
+    int32_t nitems;
+    /** offset and size of the payload */
+    int32_t payloadoffset;
+    int32_t payloadsize;
+};
+
+typedef void (*ose_dispatch_fn)(ose_constbundle bundle,
+                                const struct ose_dispatch_msg * const msg,
+                                void *context);
+
+#define OSE_DISPATCH_NODETYPE_EXACT 0
+#define OSE_DISPATCH_NODETYPE_WILDCARD 1
+#define OSE_DISPATCH_NODETYPE_PATTERN 2
+
+struct ose_dispatch_node
+{
+    /* offset of the segment, including its leading slash, in the
+       string storage */
+    int32_t seg;
+    int32_t seglen;
+    int32_t child;
+    int32_t sibling;
+    int32_t type;
+    ose_dispatch_fn fn;
+    void *context;
+};
+
+struct ose_dispatcher
+{
+    struct ose_dispatch_node *nodes;
+    int32_t nnodes;
+    int32_t maxnodes;
+    char *strings;
+    int32_t nstrings;
+    int32_t maxstrings;
+};
+
+/**
+   @brief Initialize a dispatcher that stores up to @p maxnodes tree
+   nodes in @p nodes, and the segment strings in the @p stringsize
+   bytes of @p strings.
+*/
+void ose_dispatch_init(struct ose_dispatcher *d,
+                       struct ose_dispatch_node *nodes,
+                       int32_t maxnodes,
+                       char *strings,
+                       int32_t stringsize);
+
+/**
+   @brief Register a callback for an address pattern. Registering
+   a second callback for the same pattern replaces the first.
+
+   @returns 0 on success, or -1 if the dispatcher is out of space.
+*/
+int ose_dispatch_register(struct ose_dispatcher *d,
+                          const char * const pattern,
+                          ose_dispatch_fn fn,
+                          void *context);
+
+/**
+   @brief Dispatch the message at @p offset in @p bundle.
+
+   @returns The number of callbacks that were called.
+*/
+int32_t ose_dispatch_message(const struct ose_dispatcher *d,
+                             ose_constbundle bundle,
+                             int32_t offset);
+
+/**
+   @brief Dispatch every message in @p bundle, including those in
+   nested bundles.
+
+   @returns The number of callbacks that were called.
+*/
+int32_t ose_dispatch_bundle(const struct ose_dispatcher *d,
+                            ose_constbundle bundle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,277 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software
+  and associated documentation files (the "Software"), to deal in
+  the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute,
+  sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the
+  following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "ose.h"
+#include "ose_assert.h"
+#include "ose_lz.h"
+
+#define MINMATCH 4
+#define MAXOFFSET 65535
+#define RUNMASK 15
+
+static uint32_t read32(const unsigned char * const p)
+{
+    uint32_t u;
+    memcpy(&u, p, 4);
+    return u;
+}
+
+static int32_t hash(const uint32_t u)
+{
+    return (u * 2654435761u) >> (32 - OSE_LZ_HASHLOG);
+}
+
+/* writes the run length that didn't fit in the token */
+static unsigned char *writeLength(unsigned char *op, int32_t len)
+{
+    while(len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+int32_t ose_lz_compressBound(int32_t n)
+{
+    return OSE_LZ_HEADER_LEN + n + n / 255 + 16;
+}
+
+int32_t ose_lz_compress(const char * const src,
+                        int32_t n,
+                        char * const dest,
+                        int32_t destsize)
+{
+    ose_assert(n >= 0);
+    const unsigned char * const s = (const unsigned char *)src;
+    unsigned char * const d = (unsigned char *)dest;
+    unsigned char *op = d + OSE_LZ_HEADER_LEN;
+    int32_t table[1 << OSE_LZ_HASHLOG];
+    int32_t ip = 0, anchor = 0;
+    if(destsize < OSE_LZ_HEADER_LEN)
+    {
+        return -1;
+    }
+    d[0] = (unsigned char)((uint32_t)n >> 24);
+    d[1] = (unsigned char)((uint32_t)n >> 16);
+    d[2] = (unsigned char)((uint32_t)n >> 8);
+    d[3] = (unsigned char)n;
+    memset(table, 0xff, sizeof(table));
+    while(ip + MINMATCH <= n)
+    {
+        const uint32_t u = read32(s + ip);
+        const int32_t h = hash(u);
+        const int32_t ref = table[h];
+        table[h] = ip;
+        if(ref < 0 || ip - ref > MAXOFFSET || read32(s + ref) != u)
+        {
+            /* skip ahead faster the longer it's been since the last
+               match, so that incompressible data goes quickly */
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+        int32_t len = MINMATCH;
+        while(ip + len < n && s[ref + len] == s[ip + len])
+        {
+            ++len;
+        }
+        {
+            const int32_t lit = ip - anchor;
+            const int32_t ml = len - MINMATCH;
+            if((op - d) + 1 + lit + lit / 255 + 1 + 2 + ml / 255 + 1
+               > destsize)
+            {
+                return -1;
+            }
+            unsigned char * const token = op++;
+            if(lit >= RUNMASK)
+            {
+                *token = RUNMASK << 4;
+                op = writeLength(op, lit - RUNMASK);
+            }
+            else
+            {
+                *token = (unsigned char)(lit << 4);
+            }
+            memcpy(op, s + anchor, lit);
+            op += lit;
+            *op++ = (unsigned char)(ip - ref);
+            *op++ = (unsigned char)((ip - ref) >> 8);
+            if(ml >= RUNMASK)
+            {
+                *token |= RUNMASK;
+                op = writeLength(op, ml - RUNMASK);
+            }
+            else
+            {
+                *token |= (unsigned char)ml;
+            }
+        }
+        ip += len;
+        anchor = ip;
+    }
+    /* the last sequence is just literals */
+    {
+        const int32_t lit = n - anchor;
+        if((op - d) + 1 + lit + lit / 255 + 1 > destsize)
+        {
+            return -1;
+        }
+        unsigned char * const token = op++;
+        if(lit >= RUNMASK)
+        {
+            *token = RUNMASK << 4;
+            op = writeLength(op, lit - RUNMASK);
+        }
+        else
+        {
+            *token = (unsigned char)(lit << 4);
+        }
+        memcpy(op, s + anchor, lit);
+        op += lit;
+    }
+    return op - d;
+}
+
+int32_t ose_lz_decompressedSize(const char * const src, int32_t n)
+{
+    const unsigned char * const s = (const unsigned char *)src;
+    if(n < OSE_LZ_HEADER_LEN)
+    {
+        return -1;
+    }
+    return (int32_t)(((uint32_t)s[0] << 24)
+                     | ((uint32_t)s[1] << 16)
+                     | ((uint32_t)s[2] << 8)
+                     | (uint32_t)s[3]);
+}
+
+/* reads the rest of a run length, or returns -1 if it runs off the
+   end of the input or goes over limit */
+static int32_t readLength(const unsigned char * const s,
+                          const int32_t n,
+                          int32_t *ip,
+                          const int32_t limit)
+{
+    int32_t len = 0;
+    unsigned char c;
+    do
+    {
+        if(*ip >= n || len > limit)
+        {
+            return -1;
+        }
+        c = s[(*ip)++];
+        len += c;
+    }while(c == 255);
+    return len;
+}
+
+int32_t ose_lz_decompress(const char * const src,
+                          int32_t n,
+                          char * const dest,
+                          int32_t destsize)
+{
+    const unsigned char * const s = (const unsigned char *)src;
+    unsigned char * const d = (unsigned char *)dest;
+    const int32_t size = ose_lz_decompressedSize(src, n);
+    int32_t ip = OSE_LZ_HEADER_LEN, op = 0;
+    if(size < 0 || size > destsize)
+    {
+        return -1;
+    }
+    while(ip < n)
+    {
+        const unsigned char token = s[ip++];
+        int32_t lit = token >> 4;
+        if(lit == RUNMASK)
+        {
+            const int32_t l = readLength(s, n, &ip, size);
+            if(l < 0)
+            {
+                return -1;
+            }
+            lit += l;
+        }
+        if(lit > n - ip || lit > size - op)
+        {
+            return -1;
+        }
+        memcpy(d + op, s + ip, lit);
+        ip += lit;
+        op += lit;
+        if(ip == n)
+        {
+            break;
+        }
+        if(n - ip < 2)
+        {
+            return -1;
+        }
+        const int32_t offset = s[ip] | (s[ip + 1] << 8);
+        ip += 2;
+        if(offset == 0 || offset > op)
+        {
+            return -1;
+        }
+        int32_t ml = token & RUNMASK;
+        if(ml == RUNMASK)
+        {
+            const int32_t l = readLength(s, n, &ip, size);
+            if(l < 0)
+            {
+                return -1;
+            }
+            ml += l;
+        }
+        ml += MINMATCH;
+        if(ml > size - op)
+        {
+            return -1;
+        }
+        if(offset >= ml)
+        {
+            memcpy(d + op, d + op - offset, ml);
+            op += ml;
+        }
+        else
+        {
+            /* the match overlaps its own output, which repeats the
+               last offset bytes */
+            const unsigned char *m = d + op - offset;
+            int32_t i;
+            for(i = 0; i < ml; i++)
+            {
+                d[op++] = *m++;
+            }
+        }
+    }
+    if(op != size)
+    {
+        return -1;
+    }
+    return op;
+}
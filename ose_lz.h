@@ -0,0 +1,101 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software
+  and associated documentation files (the "Software"), to deal in
+  the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute,
+  sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the
+  following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+*/
+
+/** @file ose_lz.h
+    @brief A small LZ compressor and decompressor for blobs.
+
+    The compressed format is a four byte, big endian count of the
+    bytes it decompresses to, followed by a sequence of literal runs
+    and back references into the last 64k of output, laid out as in
+    an LZ4 block. Matches are found with a single hash table of
+    recent positions, which lives on the stack, so no memory is
+    allocated.
+
+    Decompression checks every length and offset against the sizes
+    of the buffers it's given, so malformed input is rejected rather
+    than read or written past the ends of them.
+*/
+
+#ifndef OSE_LZ_H
+#define OSE_LZ_H
+
+#include "ose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   @brief The number of bits in the hash used to find matches. The
+   hash table takes four bytes per entry.
+*/
+#ifdef OSE_CONF_LZ_HASHLOG
+#define OSE_LZ_HASHLOG OSE_CONF_LZ_HASHLOG
+#else
+#define OSE_LZ_HASHLOG 12
+#endif
+
+#define OSE_LZ_HEADER_LEN 4
+
+/**
+   @brief The largest number of bytes that compressing @p n bytes can
+   produce.
+*/
+int32_t ose_lz_compressBound(int32_t n);
+
+/**
+   @brief Compress the @p n bytes at @p src into @p dest.
+
+   @returns The number of bytes written, or -1 if @p destsize is too
+   small. A @p destsize of #ose_lz_compressBound(n) is always big
+   enough.
+*/
+int32_t ose_lz_compress(const char * const src,
+                        int32_t n,
+                        char * const dest,
+                        int32_t destsize);
+
+/**
+   @brief The number of bytes that the @p n compressed bytes at @p src
+   decompress to, or -1 if there aren't enough of them to hold the
+   header.
+*/
+int32_t ose_lz_decompressedSize(const char * const src, int32_t n);
+
+/**
+   @brief Decompress the @p n bytes at @p src into @p dest, which must
+   not overlap them.
+
+   @returns The number of bytes written, or -1 if the input is
+   malformed, or doesn't fit in @p destsize bytes.
+*/
+int32_t ose_lz_decompress(const char * const src,
+                          int32_t n,
+                          char * const dest,
+                          int32_t destsize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
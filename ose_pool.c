@@ -0,0 +1,164 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software
+  and associated documentation files (the "Software"), to deal in
+  the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute,
+  sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the
+  following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "ose.h"
+#include "ose_context.h"
+#include "ose_util.h"
+#include "ose_stackops.h"
+#include "ose_assert.h"
+#include "ose_pool.h"
+
+/* each block starts with the index + 1 of the next free block */
+#define OSE_POOL_BLOCK_HEADER_LEN 8
+
+#define getBlock(c, i) ((c)->mem + (i) * (c)->blocksize)
+
+static void pushFree(struct ose_pool_class *c, uint32_t i)
+{
+    uint32_t *next = (uint32_t *)getBlock(c, i);
+    uint64_t old = __atomic_load_n(&c->head, __ATOMIC_RELAXED);
+    uint64_t new;
+    do
+    {
+        __atomic_store_n(next, (uint32_t)old, __ATOMIC_RELAXED);
+        new = (((old >> 32) + 1) << 32) | (i + 1);
+    } while(!__atomic_compare_exchange_n(&c->head, &old, new, true,
+                                         __ATOMIC_RELEASE,
+                                         __ATOMIC_RELAXED));
+}
+
+static bool popFree(struct ose_pool_class *c, uint32_t *i)
+{
+    uint64_t old = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+    uint64_t new;
+    do
+    {
+        const uint32_t ii = (uint32_t)old;
+        if(!ii)
+        {
+            return false;
+        }
+        /* the block may be taken by another thread before the
+           exchange, in which case this is stale, but the tag makes
+           the exchange fail */
+        const uint32_t next =
+            __atomic_load_n((uint32_t *)getBlock(c, ii - 1),
+                            __ATOMIC_RELAXED);
+        new = (((old >> 32) + 1) << 32) | next;
+    } while(!__atomic_compare_exchange_n(&c->head, &old, new, true,
+                                         __ATOMIC_ACQUIRE,
+                                         __ATOMIC_ACQUIRE));
+    *i = (uint32_t)old - 1;
+    return true;
+}
+
+void ose_pool_init(struct ose_pool *p)
+{
+    ose_assert(p);
+    memset(p, 0, sizeof(struct ose_pool));
+}
+
+int32_t ose_pool_addClass(struct ose_pool *p,
+                          char *mem,
+                          int32_t nbytes,
+                          int32_t capacity)
+{
+    ose_assert(p);
+    ose_assert(mem);
+    ose_assert(capacity > 0);
+    if(p->nclasses >= OSE_POOL_MAX_CLASSES)
+    {
+        return -1;
+    }
+    ose_assert(p->nclasses == 0
+               || p->classes[p->nclasses - 1].capacity <= capacity);
+    struct ose_pool_class *c = p->classes + p->nclasses;
+    /* align the blocks so that the bundle is at the same offset in
+       each of them */
+    while((uintptr_t)mem % OSE_CONTEXT_ALIGNMENT)
+    {
+        mem++;
+        nbytes--;
+    }
+    const int32_t bs = OSE_CONTEXT_MAX_OVERHEAD + capacity;
+    c->mem = mem;
+    c->blocksize = ose_pnbytes(OSE_POOL_BLOCK_HEADER_LEN + bs - 1);
+    c->nblocks = nbytes / c->blocksize;
+    c->head = 0;
+    c->capacity = capacity;
+    if(c->nblocks <= 0)
+    {
+        return 0;
+    }
+    for(int32_t i = c->nblocks - 1; i >= 0; i--)
+    {
+        char *block = getBlock(c, i);
+        ose_bundle b = ose_newBundleFromCBytes(bs, block
+                                               + OSE_POOL_BLOCK_HEADER_LEN);
+        c->bundleoffset = ose_getBundlePtr(b) - block;
+        ose_assert(ose_spaceAvailable(b) >= capacity);
+        pushFree(c, i);
+    }
+    p->nclasses++;
+    return c->nblocks;
+}
+
+bool ose_pool_get(struct ose_pool *p, int32_t nbytes, ose_bundle *bundle)
+{
+    ose_assert(p);
+    ose_assert(bundle);
+    for(int32_t i = 0; i < p->nclasses; i++)
+    {
+        struct ose_pool_class *c = p->classes + i;
+        uint32_t j;
+        if(c->capacity >= nbytes && popFree(c, &j))
+        {
+            *bundle = ose_makeBundle(getBlock(c, j) + c->bundleoffset);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ose_pool_put(struct ose_pool *p, ose_bundle bundle)
+{
+    ose_assert(p);
+    char *b = ose_getBundlePtr(bundle);
+    for(int32_t i = 0; i < p->nclasses; i++)
+    {
+        struct ose_pool_class *c = p->classes + i;
+        if(b >= c->mem && b < c->mem + c->nblocks * c->blocksize)
+        {
+            const uint32_t j = (b - c->mem) / c->blocksize;
+            ose_assert(b == getBlock(c, j) + c->bundleoffset);
+            /* bundles rely on the space past their end being
+               zeroed, so only the bytes in use need clearing */
+            ose_clear(bundle);
+            pushFree(c, j);
+            return;
+        }
+    }
+    ose_assert(0 && "bundle does not belong to this pool");
+}
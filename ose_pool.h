@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software
+  and associated documentation files (the "Software"), to deal in
+  the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute,
+  sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the
+  following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+*/
+
+/** @file ose_pool.h
+    @brief Pools of preinitialized bundles.
+
+    A pool hands out bundles from a few size classes, each of which
+    is a block of memory supplied by the caller and carved up into
+    bundles with #ose_newBundleFromCBytes once, when the class is
+    added. A bundle that is given back is only cleared, so getting
+    and putting bundles is cheap, and both are lock free and may be
+    called from any number of threads. Classes must all be added
+    before the pool is shared.
+*/
+
+#ifndef OSE_POOL_H
+#define OSE_POOL_H
+
+#include <stdbool.h>
+#include "ose.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef OSE_POOL_MAX_CLASSES
+#define OSE_POOL_MAX_CLASSES 4
+#endif
+
+struct ose_pool_class
+{
+    char *mem;
+    int32_t blocksize;
+    int32_t nblocks;
+    int32_t bundleoffset;
+    int32_t capacity;
+    /* free list: tag in the high word, index + 1 in the low word */
+    uint64_t head;
+};
+
+struct ose_pool
+{
+    struct ose_pool_class classes[OSE_POOL_MAX_CLASSES];
+    int32_t nclasses;
+};
+
+void ose_pool_init(struct ose_pool *p);
+
+/**
+   @brief Add a size class of bundles that can hold at least
+   @p capacity bytes each, using the @p nbytes bytes of @p mem. Size
+   classes must be added in order of increasing capacity.
+
+   @returns The number of bundles in the class, or -1 if no more
+   classes can be added.
+*/
+int32_t ose_pool_addClass(struct ose_pool *p,
+                          char *mem,
+                          int32_t nbytes,
+                          int32_t capacity);
+
+/**
+   @brief Get an empty bundle with room for at least @p nbytes bytes
+   from the smallest class that has one free.
+
+   @returns false if there is no such bundle.
+*/
+bool ose_pool_get(struct ose_pool *p, int32_t nbytes, ose_bundle *bundle);
+
+/**
+   @brief Give a bundle obtained from #ose_pool_get back to the pool.
+*/
+void ose_pool_put(struct ose_pool *p, ose_bundle bundle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
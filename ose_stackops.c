@@ -38,6 +38,7 @@
 #include "ose_assert.h"
 #include "ose_match.h"
 #include "ose_errno.h"
+#include "ose_lz.h"
 
 #define ose_readInt32_outOfBounds(b, o)\
     ose_ntohl(*((int32_t *)(ose_getBundlePtr((b)) + (o))))
@@ -668,6 +669,11 @@ struct ose_timetag ose_popTimetag(ose_bundle bundle)
 void ose_2drop(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    ose_2dropUnchecked(bundle);
+}
+
+void ose_2dropUnchecked(ose_bundle bundle)
+{
     int32_t onm1, snm1, on, sn, ss;
     be2(bundle, &onm1, &snm1, &on, &sn);
     ss = sn + snm1 + 8;
@@ -679,6 +685,11 @@ void ose_2drop(ose_bundle bundle)
 void ose_2dup(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    ose_2dupUnchecked(bundle);
+}
+
+void ose_2dupUnchecked(ose_bundle bundle)
+{
     int32_t onm1, snm1, on, sn;
     be2(bundle, &onm1, &snm1, &on, &sn);
     const int32_t ss = snm1 + sn + 8;
@@ -690,6 +701,11 @@ void ose_2dup(ose_bundle bundle)
 void ose_2over(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 4), 1);
+    ose_2overUnchecked(bundle);
+}
+
+void ose_2overUnchecked(ose_bundle bundle)
+{
     int32_t onm3, snm3, onm2, snm2, onm1, snm1, on, sn;
     be4(bundle, &onm3, &snm3, &onm2, &snm2, &onm1, &snm1, &on, &sn);
     const int32_t ss = snm3 + snm2 + 8;
@@ -701,6 +717,11 @@ void ose_2over(ose_bundle bundle)
 void ose_2swap(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 4), 1);
+    ose_2swapUnchecked(bundle);
+}
+
+void ose_2swapUnchecked(ose_bundle bundle)
+{
     int32_t onm3, snm3, onm2, snm2, onm1, snm1, on, sn;
     be4(bundle, &onm3, &snm3, &onm2, &snm2, &onm1, &snm1, &on, &sn);
     const int32_t ss = snm3 + snm2 + 8;
@@ -735,6 +756,11 @@ void ose_dropAtOffset(ose_bundle bundle, int32_t offset)
 void ose_drop(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 1), 1);
+    ose_dropUnchecked(bundle);
+}
+
+void ose_dropUnchecked(ose_bundle bundle)
+{
     int32_t o, s;
     be1(bundle, &o, &s);
     ose_drop_impl(bundle, o, s);
@@ -750,6 +776,11 @@ static void ose_dup_impl(ose_bundle bundle, int32_t o, int32_t s)
 void ose_dup(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 1), 1);
+    ose_dupUnchecked(bundle);
+}
+
+void ose_dupUnchecked(ose_bundle bundle)
+{
     int32_t o, s;
     be1(bundle, &o, &s);
     ose_dup_impl(bundle, o, s);
@@ -758,6 +789,11 @@ void ose_dup(ose_bundle bundle)
 void ose_nip(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    ose_nipUnchecked(bundle);
+}
+
+void ose_nipUnchecked(ose_bundle bundle)
+{
     int32_t onm1, snm1, on, sn;
     be2(bundle, &onm1, &snm1, &on, &sn);
     ose_swap_impl(bundle, onm1, snm1, on, sn);
@@ -785,6 +821,11 @@ static void ose_notrot_impl(ose_bundle bundle,
 void ose_notrot(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 3), 1);
+    ose_notrotUnchecked(bundle);
+}
+
+void ose_notrotUnchecked(ose_bundle bundle)
+{
     int32_t onm2, snm2, onm1, snm1, on, sn;
     be3(bundle, &onm2, &snm2, &onm1, &snm1, &on, &sn);
     ose_notrot_impl(bundle, onm2, snm2, onm1, snm1, on, sn);
@@ -804,6 +845,11 @@ static void ose_over_impl(ose_bundle bundle,
 void ose_over(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    ose_overUnchecked(bundle);
+}
+
+void ose_overUnchecked(ose_bundle bundle)
+{
     int32_t onm1, snm1, on, sn;
     be2(bundle, &onm1, &snm1, &on, &sn);
     ose_over_impl(bundle, onm1, snm1, on, sn);
@@ -871,7 +917,7 @@ int32_t ose_pickMatch_impl(ose_bundle bundle)
     int32_t s = ose_readSize(bundle);
     while(o < s)
     {
-        if(!strcmp(addr, ose_readString(bundle, o + 4)))
+        if(ose_paddedStringsEqual(addr, ose_readString(bundle, o + 4)))
         {
             ose_pickMatch_found_impl(bundle, o, s);
             return 1;
@@ -941,7 +987,7 @@ int32_t ose_rollMatch_impl(ose_bundle bundle)
     int32_t s = ose_readSize(bundle);
     while(o < s)
     {
-        if(!strcmp(addr, ose_readString(bundle, o + 4)))
+        if(ose_paddedStringsEqual(addr, ose_readString(bundle, o + 4)))
         {
             ose_drop(bundle);
             char *b = ose_getBundlePtr(bundle);
@@ -994,6 +1040,11 @@ static void ose_rot_impl(ose_bundle bundle,
 void ose_rot(ose_bundle bundle)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 3), 1);
+    ose_rotUnchecked(bundle);
+}
+
+void ose_rotUnchecked(ose_bundle bundle)
+{
     int32_t onm2, snm2, onm1, snm1, on, sn;
     be3(bundle, &onm2, &snm2, &onm1, &snm1, &on, &sn);
     ose_rot_impl(bundle, onm2, snm2, onm1, snm1, on, sn);
@@ -1045,6 +1096,11 @@ static void ose_swap_impl(ose_bundle bundle,
 void ose_swap(ose_bundle bundle)
 {
     ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    ose_swapUnchecked(bundle);
+}
+
+void ose_swapUnchecked(ose_bundle bundle)
+{
     int32_t onm1, snm1, on, sn;
     be2(bundle, &onm1, &snm1, &on, &sn);
     ose_swap_impl(bundle, onm1, snm1, on, sn);
@@ -1053,6 +1109,11 @@ void ose_swap(ose_bundle bundle)
 void ose_tuck(ose_bundle bundle)
 {
     ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    ose_tuckUnchecked(bundle);
+}
+
+void ose_tuckUnchecked(ose_bundle bundle)
+{
     int32_t onm1, snm1, on, sn;
     be2(bundle, &onm1, &snm1, &on, &sn);
     ose_swap_impl(bundle, onm1, snm1, on, sn);
@@ -1172,9 +1233,8 @@ void ose_join(ose_bundle bundle)
     }
 }
 
-void ose_pop(ose_bundle bundle)
+static void ose_pop_impl(ose_bundle bundle, const int32_t o)
 {
-    int32_t o = ose_getLastBundleElemOffset(bundle);
     char *b = ose_getBundlePtr(bundle);
     switch(ose_getBundleElemType(bundle, o)){
     case OSETT_MESSAGE:
@@ -1255,74 +1315,162 @@ void ose_pop(ose_bundle bundle)
     }
 }
 
-static void popAll_bundle(ose_bundle bundle, const int32_t o)
+void ose_pop(ose_bundle bundle)
 {
-    int32_t s = ose_readInt32(bundle, o);
-    ose_incSize(bundle, s - OSE_BUNDLE_HEADER_LEN);
-    char *b = ose_getBundlePtr(bundle);
-    memcpy(b + o + s + 4,
-           b + o + 4 + OSE_BUNDLE_HEADER_LEN,
-           s - OSE_BUNDLE_HEADER_LEN);
-    int32_t o1 = (o + s + 4) - (OSE_BUNDLE_HEADER_LEN + 4);
-    ose_writeInt32(bundle, o1, OSE_BUNDLE_HEADER_LEN);
-    memcpy(b + o1 + 4, OSE_BUNDLE_HEADER, OSE_BUNDLE_HEADER_LEN);
+    ose_pop_impl(bundle, ose_getLastBundleElemOffset(bundle));
+}
+
+void ose_popSwap(ose_bundle bundle)
+{
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_pop_impl(bundle, o);
+    /* the element that was popped from is still at o, unless it
+       was consumed, and what was popped follows it */
+    const int32_t s = ose_readSize(bundle);
+    if(o < s)
+    {
+        const int32_t s1 = ose_readInt32(bundle, o);
+        const int32_t o2 = o + s1 + 4;
+        if(o2 < s)
+        {
+            ose_swap_impl(bundle, o, s1, o2, ose_readInt32(bundle, o2));
+            return;
+        }
+    }
+    ose_swap(bundle);
+}
 
-    int32_t bs = ose_readSize(bundle);
-    int32_t o2 = o + s + 4;
-    int32_t s2 = 0;
-    while(o2 < bs)
+/*
+  Replaces the bundle at o, which must be the last element, with
+  its elements, in reverse order if reverse is true, followed by
+  the empty bundle if keepbundle is true.
+*/
+static void explodeBundle(ose_bundle bundle,
+                          const int32_t o,
+                          const bool reverse,
+                          const bool keepbundle)
+{
+    char *b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readInt32(bundle, o);
+    const int32_t ns = s - OSE_BUNDLE_HEADER_LEN;
+    const int32_t n = keepbundle ? s + 4 : ns;
+    if(reverse)
+    {
+        /* the elements are copied out of the way in one go, and
+           then back in reverse order */
+        const int32_t e = o + s + 4;
+        ose_assert(ose_spaceAvailable(bundle) >= ns);
+        memcpy(b + e, b + o + 4 + OSE_BUNDLE_HEADER_LEN, ns);
+        int32_t r = e;
+        int32_t w = o + ns;
+        while(r < e + ns)
+        {
+            const int32_t ss = ose_ntohl(*((int32_t *)(b + r)));
+            w -= ss + 4;
+            memcpy(b + w, b + r, ss + 4);
+            r += ss + 4;
+        }
+        if(keepbundle)
+        {
+            *((int32_t *)(b + o + ns)) = ose_htonl(OSE_BUNDLE_HEADER_LEN);
+            memcpy(b + o + ns + 4, OSE_BUNDLE_HEADER,
+                   OSE_BUNDLE_HEADER_LEN);
+        }
+        memset(b + o + n, 0, e + ns - (o + n));
+    }
+    else
     {
-        s2 = ose_readInt32(bundle, o2);
-        o1 -= (s2 + 4);
-        memcpy(b + o1, b + o2, s2 + 4);
-        o2 += s2 + 4;
+        if(keepbundle)
+        {
+            /* the elements are already in place after the header */
+            ose_writeInt32(bundle, o, OSE_BUNDLE_HEADER_LEN);
+            return;
+        }
+        memmove(b + o, b + o + 4 + OSE_BUNDLE_HEADER_LEN, ns);
+        memset(b + o + ns, 0, s + 4 - ns);
     }
-    memset(b + o + s + 4, 0, s - OSE_BUNDLE_HEADER_LEN);
-    ose_decSize(bundle, (s - OSE_BUNDLE_HEADER_LEN));
+    ose_addToSize(bundle, n - (s + 4));
 }
 
-static void popAll_message(ose_bundle bundle, int32_t o)
+/*
+  Replaces the message at o, which must be the last element, with a
+  message for each of its items, in reverse order if reverse is
+  true, and a message with its address and no items, which comes
+  last if reverse is true and first otherwise, if keepaddr is true.
+
+  The new elements are written in one pass into the free space
+  after the message, and then moved down over it, so the size is
+  only updated once.
+*/
+static void explodeMessage(ose_bundle bundle,
+                           const int32_t o,
+                           const bool reverse,
+                           const bool keepaddr)
 {
     char *b = ose_getBundlePtr(bundle);
-    int32_t s = ose_readInt32(bundle, o);
-    int32_t ao = o + 4;
-    int32_t as = ose_getPaddedStringLen(bundle, ao);
-    int32_t to = ao + as;
-    int32_t n = strlen(b + to);
-    int32_t po = to + ose_pnbytes(n);
-    int32_t ps = s - ((po - o) - 4);
-    int32_t nbytes = 8
-        + as + ps + ((OSE_ADDRESS_ANONVAL_SIZE + 8) * (n - 1));
-    ose_incSize(bundle, nbytes);
-    to++;
-    int32_t oo = o;
-    o += (s + 4 + nbytes) - (4 + as + 4);
-    ose_writeInt32(bundle, o, as + 4);
-    memcpy(b + o + 4, b + ao, as);
-    ose_writeByte(bundle, o + 4 + as, OSETT_ID);
-    for(int i = 0; i < n - 1; i++)
-    {
-        char tt = ose_readByte(bundle, to);
-        int32_t is = ose_getPayloadItemSize(bundle, tt, po);
-        o -= is;
-        memcpy(b + o, b + po, is);
-        o -= 4;
-        ose_writeByte(bundle, o, OSETT_ID);
-        ose_writeByte(bundle, o + 1, tt);
+    const int32_t s = ose_readInt32(bundle, o);
+    const int32_t e = o + s + 4;
+    const int32_t as = ose_getPaddedStringLen(bundle, o + 4);
+    int32_t to = o + 4 + as;
+    int32_t po = to;
+    int32_t nitems = 0;
+    if(to < e)
+    {
+        const int32_t ntt = strlen(b + to);
+        nitems = ntt ? ntt - 1 : 0;
+        po = to + ose_pnbytes(ntt);
+        to++;
+    }
+    const int32_t ps = e - po;
+    const int32_t addrsize = keepaddr ? 4 + as + 4 : 0;
+    const int32_t n = addrsize
+        + ((4 + OSE_ADDRESS_ANONVAL_SIZE + 4) * nitems) + ps;
+    ose_assert(ose_spaceAvailable(bundle) >= n);
+
+    int32_t w = reverse ? e + n - addrsize : e;
+    if(keepaddr)
+    {
+        const int32_t ao = reverse ? w : e;
+        *((int32_t *)(b + ao)) = ose_htonl(as + 4);
+        memcpy(b + ao + 4, b + o + 4, as);
+        b[ao + 4 + as] = OSETT_ID;
+        b[ao + 4 + as + 1] = 0;
+        b[ao + 4 + as + 2] = 0;
+        b[ao + 4 + as + 3] = 0;
+        if(!reverse)
+        {
+            w += addrsize;
+        }
+    }
+    for(int32_t i = 0; i < nitems; i++)
+    {
+        const char tt = b[to + i];
+        const int32_t is = ose_getPayloadItemSize(bundle, tt, po);
+        const int32_t ms = 4 + OSE_ADDRESS_ANONVAL_SIZE + 4 + is;
+        if(reverse)
+        {
+            w -= ms;
+        }
+        *((int32_t *)(b + w)) = ose_htonl(ms - 4);
 #ifdef OSE_USER_ADDRESS_ANONVAL
-        o -= OSE_ADDRESS_ANONVAL_SIZE;
-        memcpy(b + o, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
-        o -= 4;
+        memcpy(b + w + 4, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
 #else
-        o -= (4 + OSE_ADDRESS_ANONVAL_SIZE);
+        memset(b + w + 4, 0, OSE_ADDRESS_ANONVAL_SIZE);
 #endif
-        ose_writeInt32(bundle, o, OSE_ADDRESS_ANONVAL_SIZE + 4 + is);
-        to++;
+        b[w + 4 + OSE_ADDRESS_ANONVAL_SIZE] = OSETT_ID;
+        b[w + 4 + OSE_ADDRESS_ANONVAL_SIZE + 1] = tt;
+        b[w + 4 + OSE_ADDRESS_ANONVAL_SIZE + 2] = 0;
+        b[w + 4 + OSE_ADDRESS_ANONVAL_SIZE + 3] = 0;
+        memcpy(b + w + 4 + OSE_ADDRESS_ANONVAL_SIZE + 4, b + po, is);
+        if(!reverse)
+        {
+            w += ms;
+        }
         po += is;
     }
-    memmove(b + oo, b + oo + s + 4, nbytes);
-    memset(b + oo + s + 4 + nbytes, 0, s + 4);
-    ose_decSize(bundle, (s + 4));
+    memmove(b + o, b + e, n);
+    memset(b + o + n, 0, s + 4);
+    ose_addToSize(bundle, n - (s + 4));
 }
 
 void ose_popAll(ose_bundle bundle)
@@ -1330,18 +1478,25 @@ void ose_popAll(ose_bundle bundle)
     int32_t o = ose_getLastBundleElemOffset(bundle);
     if(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE)
     {
-        popAll_bundle(bundle, o);
+        explodeBundle(bundle, o, true, true);
     }
     else
     {
-        popAll_message(bundle, o);      
+        explodeMessage(bundle, o, true, true);
     }
 }
 
 void ose_popAllDrop(ose_bundle bundle)
 {
-    ose_popAll(bundle);
-    ose_drop(bundle);
+    int32_t o = ose_getLastBundleElemOffset(bundle);
+    if(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE)
+    {
+        explodeBundle(bundle, o, true, false);
+    }
+    else
+    {
+        explodeMessage(bundle, o, true, false);
+    }
 }
 
 void ose_popAllBundle(ose_bundle bundle)
@@ -1481,6 +1636,159 @@ void ose_push(ose_bundle bundle)
     }
 }
 
+/*
+  An open message is a message under construction. Its typetag
+  string is preceded by two ints, the number of bytes reserved for
+  the typetags (including these two ints) and the number of
+  typetags written so far (including the leading comma). The
+  reserved space is grown geometrically, so pushing an item only
+  copies the item, and the payload is only moved again when the
+  message is sealed. An open message is not a valid OSC message,
+  and must be the topmost element of the bundle, or the one just
+  below it, until it is sealed with ose_sealMessage().
+*/
+#define OSE_OPENMESSAGE_TT_HEADER_LEN 8
+
+void ose_pushOpenMessage(ose_bundle bundle,
+                         const char * const address,
+                         int32_t addresslen,
+                         int32_t nitems)
+{
+    ose_assert(ose_isBundle(bundle));
+    ose_assert(nitems >= 0);
+    const int32_t o = ose_readSize(bundle);
+    const int32_t paddrlen = ose_pnbytes(addresslen);
+    const int32_t ttcap = OSE_OPENMESSAGE_TT_HEADER_LEN
+        + ose_pnbytes(nitems + 1);
+    const int32_t s = paddrlen + ttcap;
+    ose_incSize(bundle, s + 4);
+    char *b = ose_getBundlePtr(bundle);
+    memset(b + o, 0, s + 4);
+    ose_writeInt32(bundle, o, s);
+    memcpy(b + o + 4, address, addresslen);
+    const int32_t tto = o + 4 + paddrlen;
+    ose_writeInt32(bundle, tto, ttcap);
+    ose_writeInt32(bundle, tto + 4, 1);
+    ose_writeByte(bundle, tto + OSE_OPENMESSAGE_TT_HEADER_LEN, OSETT_ID);
+}
+
+void ose_pushToOpenMessage(ose_bundle bundle)
+{
+    char *b = ose_getBundlePtr(bundle);
+    int32_t s = ose_readSize(bundle);
+    int32_t o1 = OSE_BUNDLE_HEADER_LEN;
+    int32_t o2 = o1;
+    int32_t s2 = ose_readInt32(bundle, o2);
+    ose_assert(o2 + s2 + 4 < s);
+    while(o2 + s2 + 4 < s)
+    {
+        o1 = o2;
+        o2 += s2 + 4;
+        s2 = ose_readInt32(bundle, o2);
+    }
+    ose_assert(ose_getBundleElemType(bundle, o2) == OSETT_MESSAGE);
+
+    const int32_t tto1 = o1 + 4 + ose_getPaddedStringLen(bundle, o1 + 4);
+    int32_t ttcap = ose_readInt32(bundle, tto1);
+    const int32_t ntt1 = ose_readInt32(bundle, tto1 + 4);
+    int32_t tto2 = o2 + 4 + ose_getPaddedStringLen(bundle, o2 + 4);
+    const int32_t ntt2 = strlen(b + tto2);
+    ose_assert(ntt2 > 0);
+    if(OSE_OPENMESSAGE_TT_HEADER_LEN + ntt1 + ntt2 > ttcap)
+    {
+        /* out of room for typetags: double the reserved space,
+           moving the payload, and the item above it, up */
+        int32_t newcap = ttcap * 2;
+        while(OSE_OPENMESSAGE_TT_HEADER_LEN + ntt1 + ntt2 > newcap)
+        {
+            newcap *= 2;
+        }
+        const int32_t d = newcap - ttcap;
+        ose_incSize(bundle, d);
+        memmove(b + tto1 + newcap, b + tto1 + ttcap,
+                s - (tto1 + ttcap));
+        memset(b + tto1 + ttcap, 0, d);
+        ose_addToInt32(bundle, o1, d);
+        ose_writeInt32(bundle, tto1, newcap);
+        ttcap = newcap;
+        o2 += d;
+        tto2 += d;
+        s += d;
+    }
+    /* append the item's typetags (minus the comma), then slide
+       its payload down over its address and typetags */
+    memcpy(b + tto1 + OSE_OPENMESSAGE_TT_HEADER_LEN + ntt1,
+           b + tto2 + 1, ntt2 - 1);
+    ose_writeInt32(bundle, tto1 + 4, ntt1 + ntt2 - 1);
+    const int32_t plo2 = tto2 + ose_pnbytes(ntt2);
+    const int32_t pls2 = s - plo2;
+    memmove(b + o2, b + plo2, pls2);
+    memset(b + o2 + pls2, 0, plo2 - o2);
+    ose_addToInt32(bundle, o1, pls2);
+    ose_decSize(bundle, plo2 - o2);
+}
+
+void ose_popFromOpenMessage(ose_bundle bundle)
+{
+    char *b = ose_getBundlePtr(bundle);
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    const int32_t tto = o + 4 + ose_getPaddedStringLen(bundle, o + 4);
+    const int32_t ttcap = ose_readInt32(bundle, tto);
+    const int32_t ntt = ose_readInt32(bundle, tto + 4);
+    ose_rassert(ntt > 1, 1);
+    const char * const tt = b + tto + OSE_OPENMESSAGE_TT_HEADER_LEN;
+    const char t = tt[ntt - 1];
+    int32_t lpo, ls;
+    if(ose_isStringType(t) || t == OSETT_BLOB)
+    {
+        /* variable length: walk the payload to find the last item */
+        int32_t i;
+        lpo = tto + ttcap;
+        for(i = 1; i < ntt - 1; i++)
+        {
+            lpo += ose_getTypedDatumSize(tt[i], b + lpo);
+        }
+        ls = ose_getTypedDatumSize(t, b + lpo);
+    }
+    else
+    {
+        /* fixed length: the last item ends the message */
+        ls = ose_getTypedDatumSize(t, NULL);
+        lpo = o + 4 + ose_readInt32(bundle, o) - ls;
+    }
+    /* make room for an anonymous message header in front of it */
+    const int32_t hs = 4 + OSE_ADDRESS_ANONVAL_SIZE + 4;
+    ose_incSize(bundle, hs);
+    memmove(b + lpo + hs, b + lpo, ls);
+    ose_writeInt32(bundle, lpo, OSE_ADDRESS_ANONVAL_SIZE + 4 + ls);
+    memcpy(b + lpo + 4, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
+    b[lpo + 4 + OSE_ADDRESS_ANONVAL_SIZE] = OSETT_ID;
+    b[lpo + 4 + OSE_ADDRESS_ANONVAL_SIZE + 1] = t;
+    b[lpo + 4 + OSE_ADDRESS_ANONVAL_SIZE + 2] = 0;
+    b[lpo + 4 + OSE_ADDRESS_ANONVAL_SIZE + 3] = 0;
+    b[tto + OSE_OPENMESSAGE_TT_HEADER_LEN + ntt - 1] = 0;
+    ose_writeInt32(bundle, tto + 4, ntt - 1);
+    ose_addToInt32(bundle, o, -ls);
+}
+
+void ose_sealMessage(ose_bundle bundle)
+{
+    char *b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readSize(bundle);
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    const int32_t tto = o + 4 + ose_getPaddedStringLen(bundle, o + 4);
+    const int32_t ttcap = ose_readInt32(bundle, tto);
+    const int32_t ntt = ose_readInt32(bundle, tto + 4);
+    const int32_t pntt = ose_pnbytes(ntt);
+    const int32_t d = ttcap - pntt;
+    memmove(b + tto, b + tto + OSE_OPENMESSAGE_TT_HEADER_LEN, ntt);
+    memset(b + tto + ntt, 0, pntt - ntt);
+    memmove(b + tto + pntt, b + tto + ttcap, s - (tto + ttcap));
+    memset(b + s - d, 0, d);
+    ose_addToInt32(bundle, o, -d);
+    ose_decSize(bundle, d);
+}
+
 void ose_splitBundle(ose_bundle bundle, const int32_t offset, const int32_t n)
 {
     ose_assert(n >= 0);
@@ -1605,203 +1913,26 @@ void ose_unpack(ose_bundle bundle)
     int32_t o = ose_getLastBundleElemOffset(bundle);
     if(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE)
     {
-        ose_writeInt32(bundle, o, OSE_BUNDLE_HEADER_LEN);
+        explodeBundle(bundle, o, false, true);
     }
     else
     {
-        char *b = ose_getBundlePtr(bundle);
-        int32_t s = ose_readInt32(bundle, o);
-        int32_t to = o + 4;
-        to += ose_pstrlen(b + to);
-        int32_t po = to + ose_pstrlen(b + to);
-        to++;
-        ose_pushMessage(bundle, b + o + 4, strlen(b + o + 4), 0);
-        char tt = ose_readByte(bundle, to);
-        while(tt)
-        {
-            int32_t ps = ose_getPayloadItemSize(bundle, tt, po);
-            switch(tt)
-            {
-            case OSETT_INT32:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_INT32,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-            case OSETT_FLOAT:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_FLOAT,
-                                ose_readFloat(bundle, po));
-                break;
-            }
-            case OSETT_STRING:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_STRING,
-                                ose_readString(bundle, po));
-                break;
-            }
-            case OSETT_BLOB:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_BLOB,
-                                ose_readBlobSize(bundle, po),
-                                b + po + 4);
-                break;
-            }
-#ifdef OSE_PROVIDE_TYPE_SYMBOL
-            case OSETT_SYMBOL:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_SYMBOL,
-                                ose_readString(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-            case OSETT_DOUBLE:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_DOUBLE,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-            case OSETT_INT8:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_INT8,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-            case OSETT_UINT8: {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_UINT8,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-            case OSETT_UINT32:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_UINT32,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-            case OSETT_INT64:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_INT64,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-            case OSETT_UINT64:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_UINT64,
-                                ose_readInt32(bundle, po));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_TIMETAG
-            case OSETT_TIMETAG:
-            {
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                OSETT_TIMETAG,
-                                ose_readInt32(bundle, po),
-                                ose_readInt32(bundle, po + 4));
-                break;
-            }
-#endif
-#ifdef OSE_PROVIDE_TYPE_TRUE
-            case OSETT_TRUE:
-#endif
-#ifdef OSE_PROVIDE_TYPE_TRUE
-            case OSETT_FALSE:
-#endif
-#ifdef OSE_PROVIDE_TYPE_TRUE
-            case OSETT_NULL:
-#endif
-#ifdef OSE_PROVIDE_TYPE_TRUE
-            case OSETT_INFINITUM:
-#endif
-#if defined(OSE_PROVIDE_TYPE_TRUE) ||           \
-    defined(OSE_PROVIDE_TYPE_TRUE) ||           \
-    defined(OSE_PROVIDE_TYPE_TRUE) ||           \
-    defined(OSE_PROVIDE_TYPE_TRUE) 
-                ose_pushMessage(bundle,
-                                OSE_ADDRESS_ANONVAL,
-                                OSE_ADDRESS_ANONVAL_LEN,
-                                1,
-                                tt);
-                break;
-#endif
-            }
-            to++;
-            tt = ose_readByte(bundle, to);
-            po += ps;
-        }
-        int32_t bs = ose_readSize(bundle);
-        memcpy(b + o, b + o + s + 4, bs - (o + s + 4));
-        memset(b + (bs - (s + 4)), 0, s + 4);
-        ose_decSize(bundle, (s + 4));
+        explodeMessage(bundle, o, false, true);
     }
 }
 
 void ose_unpackDrop(ose_bundle bundle)
 {
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 1));
     int32_t o = ose_getLastBundleElemOffset(bundle);
-    int32_t n = ose_getBundleElemElemCount(bundle, o);
-    ose_unpack(bundle);
-    ose_pushInt32(bundle, n);
-    ose_roll(bundle);
-    ose_drop(bundle);
+    if(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE)
+    {
+        explodeBundle(bundle, o, false, false);
+    }
+    else
+    {
+        explodeMessage(bundle, o, false, false);
+    }
 }
 
 void ose_unpackBundle(ose_bundle bundle)
@@ -2599,45 +2730,203 @@ void ose_swapNBytes(ose_bundle bundle)
     swapNBytes(bundle, ose_readSize(bundle), ose_popInt32(bundle));
 }
 
-void ose_trimStringEnd(ose_bundle bundle)
+static void swapBlobByteOrder(ose_bundle bundle, int32_t width)
 {
-    int32_t o = ose_getLastBundleElemOffset(bundle);
-    int32_t to, ntt, lto, po, lpo;
-    ose_getNthPayloadItem(bundle, 1, o, &to, &ntt, &lto, &po, &lpo);
-    ose_assert(ose_isStringType(ose_readByte(bundle, lto)));
-    int32_t s = ose_getStringLen(bundle, lpo);
-    char *p = (char *)ose_readString(bundle, lpo);
-    int32_t i = s - 1;
-    while(i >= 0)
+    ose_rassert(ose_peekType(bundle) == OSETT_MESSAGE, 1);
+    ose_rassert(ose_peekMessageArgType(bundle) == OSETT_BLOB, 1);
+    char *p = ose_peekBlob(bundle);
+    const int32_t n = ose_ntohl(*((int32_t *)p));
+    ose_rassert(n % width == 0, 1);
+    if(width == 4)
     {
-        if(p[i] <= 32 || p[i] >= 127)
-        {
-            p[i] = 0;
-        }
-        else
-        {
-            break;
-        }
-        i--;
+        ose_swapByteOrder32(p + 4, n / 4);
+    }
+    else
+    {
+        ose_swapByteOrder64(p + 4, n / 8);
     }
-    int32_t d = (ose_pnbytes(s) - ose_pnbytes(i));
-    ose_addToInt32(bundle, o, -d);
-    ose_decSize(bundle, d);
 }
 
-void ose_trimStringStart(ose_bundle bundle)
+void ose_swapBlobByteOrder32(ose_bundle bundle)
 {
-    int32_t o = ose_getLastBundleElemOffset(bundle);
-    int32_t to, ntt, lto, po, lpo;
-    ose_getNthPayloadItem(bundle, 1, o, &to, &ntt, &lto, &po, &lpo);
-    ose_assert(ose_isStringType(ose_readByte(bundle, lto)));
-    int32_t s = ose_getStringLen(bundle, lpo);
-    char *p = (char *)ose_readString(bundle, lpo);
-    int32_t i = 0;
-    while(i < s)
-    {
-        if(p[i] <= 32 || p[i] >= 127)
-        {
+    swapBlobByteOrder(bundle, 4);
+}
+
+void ose_swapBlobByteOrder64(ose_bundle bundle)
+{
+    swapBlobByteOrder(bundle, 8);
+}
+
+/*
+  Compression and decompression write straight from the blob into a
+  new blob pushed on top of the stack, which then takes the place
+  of the old one.
+*/
+static void replaceBlobWithTop(ose_bundle bundle)
+{
+    int32_t onm1, snm1, on, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t tto = onm1 + 4 + ose_getPaddedStringLen(bundle, onm1 + 4);
+    if(strlen(b + tto) == 2)
+    {
+        /* the blob is the only item */
+        ose_nip(bundle);
+    }
+    else
+    {
+        ose_swap(bundle);
+        ose_pop(bundle);
+        ose_drop(bundle);
+        ose_swap(bundle);
+        ose_push(bundle);
+    }
+}
+
+/* shortens the blob pushed by ose_pushBlob to n bytes */
+static void truncateTopBlob(ose_bundle bundle, const int32_t n)
+{
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    const int32_t bo = o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 4;
+    const int32_t s = ose_readInt32(bundle, bo);
+    const int32_t diff = (s + ose_getBlobPaddingForNBytes(s))
+        - (n + ose_getBlobPaddingForNBytes(n));
+    ose_writeInt32(bundle, bo, n);
+    memset(b + bo + 4 + n, 0, s - n);
+    ose_writeInt32(bundle, o, ose_readInt32(bundle, o) - diff);
+    ose_addToSize(bundle, -diff);
+}
+
+void ose_compressBlob(ose_bundle bundle)
+{
+    ose_rassert(ose_peekType(bundle) == OSETT_MESSAGE, 1);
+    ose_rassert(ose_peekMessageArgType(bundle) == OSETT_BLOB, 1);
+    const char * const p = ose_peekBlob(bundle);
+    const int32_t n = ose_ntohl(*((int32_t *)p));
+    const int32_t bound = ose_lz_compressBound(n);
+    if(bound > ose_spaceAvailable(bundle)
+       - (4 + OSE_ADDRESS_ANONVAL_SIZE + 4 + 4 + 4))
+    {
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+    ose_pushBlob(bundle, bound, NULL);
+    const int32_t cn = ose_lz_compress(p + 4, n,
+                                       ose_peekBlob(bundle) + 4, bound);
+    ose_assert(cn >= 0);
+    truncateTopBlob(bundle, cn);
+    replaceBlobWithTop(bundle);
+}
+
+void ose_decompressBlob(ose_bundle bundle)
+{
+    ose_rassert(ose_peekType(bundle) == OSETT_MESSAGE, 1);
+    ose_rassert(ose_peekMessageArgType(bundle) == OSETT_BLOB, 1);
+    const char * const p = ose_peekBlob(bundle);
+    const int32_t n = ose_ntohl(*((int32_t *)p));
+    const int32_t m = ose_lz_decompressedSize(p + 4, n);
+    if(m < 0 || m > ose_spaceAvailable(bundle)
+       - (4 + OSE_ADDRESS_ANONVAL_SIZE + 4 + 4 + 4))
+    {
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+    ose_pushBlob(bundle, m, NULL);
+    if(ose_lz_decompress(p + 4, n, ose_peekBlob(bundle) + 4, m) < 0)
+    {
+        ose_drop(bundle);
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+    replaceBlobWithTop(bundle);
+}
+
+void ose_swapItemsByteOrder(ose_bundle bundle)
+{
+    ose_rassert(ose_peekType(bundle) == OSETT_MESSAGE, 1);
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    char *b = ose_getBundlePtr(bundle);
+    int32_t to = ose_getBundleElemTTOffset(bundle, o) + 1;
+    int32_t po = ose_getBundleElemPayloadOffset(bundle, o);
+    /* adjacent 4-byte items are converted as a single run */
+    int32_t run = po, nrun = 0;
+    while(b[to])
+    {
+        const char tt = b[to];
+        const int32_t s = ose_getTypedDatumSize(tt, b + po);
+        if(ose_isNumericType(tt) && s == 4)
+        {
+            if(!nrun)
+            {
+                run = po;
+            }
+            nrun++;
+        }
+#ifdef OSE_PROVIDE_TYPE_TIMETAG
+        else if(tt == OSETT_TIMETAG)
+        {
+            if(!nrun)
+            {
+                run = po;
+            }
+            nrun += 2;
+        }
+#endif
+        else
+        {
+            ose_swapByteOrder32(b + run, nrun);
+            nrun = 0;
+            if(ose_isNumericType(tt) && s == 8)
+            {
+                ose_swapByteOrder64(b + po, 1);
+            }
+        }
+        po += s;
+        to++;
+    }
+    ose_swapByteOrder32(b + run, nrun);
+}
+
+void ose_trimStringEnd(ose_bundle bundle)
+{
+    int32_t o = ose_getLastBundleElemOffset(bundle);
+    int32_t to, ntt, lto, po, lpo;
+    ose_getNthPayloadItem(bundle, 1, o, &to, &ntt, &lto, &po, &lpo);
+    ose_assert(ose_isStringType(ose_readByte(bundle, lto)));
+    int32_t s = ose_getStringLen(bundle, lpo);
+    char *p = (char *)ose_readString(bundle, lpo);
+    int32_t i = s - 1;
+    while(i >= 0)
+    {
+        if(p[i] <= 32 || p[i] >= 127)
+        {
+            p[i] = 0;
+        }
+        else
+        {
+            break;
+        }
+        i--;
+    }
+    int32_t d = (ose_pnbytes(s) - ose_pnbytes(i));
+    ose_addToInt32(bundle, o, -d);
+    ose_decSize(bundle, d);
+}
+
+void ose_trimStringStart(ose_bundle bundle)
+{
+    int32_t o = ose_getLastBundleElemOffset(bundle);
+    int32_t to, ntt, lto, po, lpo;
+    ose_getNthPayloadItem(bundle, 1, o, &to, &ntt, &lto, &po, &lpo);
+    ose_assert(ose_isStringType(ose_readByte(bundle, lto)));
+    int32_t s = ose_getStringLen(bundle, lpo);
+    char *p = (char *)ose_readString(bundle, lpo);
+    int32_t i = 0;
+    while(i < s)
+    {
+        if(p[i] <= 32 || p[i] >= 127)
+        {
             ;
         }
         else
@@ -3002,174 +3291,746 @@ void ose_gather(ose_bundle bundle)
     }
 }
 
-void ose_nth(ose_bundle bundle)
+/*
+  Parallel route and gather
+
+  These produce the same bytes as ose_route, ose_routeWithDelegation,
+  and ose_gather, but do the work in phases: the offsets of the
+  elements are indexed in one pass, the elements are matched in
+  parallel, the offsets of the results are computed with a prefix
+  sum, and then the results are copied in parallel. The index is
+  kept at the far end of the free space of the bundle, and zeroed
+  when we're done. If there isn't room for it, or for the results,
+  the sequential version is called instead.
+
+  The parallel loops are run by the function installed with
+  ose_setParallelFor, which by default just runs them in the calling
+  thread.
+*/
+
+static void sequentialFor(int32_t n, ose_parallelfn fn, void *context)
 {
-    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
-    int32_t onm1, snm1, on, sn;
-    be2(bundle, &onm1, &snm1, &on, &sn);
-    ose_assert(ose_getBundleElemType(bundle, on) == OSETT_MESSAGE);
-    char *b = ose_getBundlePtr(bundle);
-    int32_t tton = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
-    int32_t nttn = strlen(b + tton) - 1;
-    int32_t plon = tton + ose_pnbytes(nttn + 1);
-    ++tton;
-    if(ose_getBundleElemType(bundle, onm1) == OSETT_MESSAGE)
+    if(n > 0)
     {
-        int32_t ttonm1 = onm1 + 4 + ose_getPaddedStringLen(bundle,
-                                                           onm1 + 4);
-        int32_t nttnm1 = strlen(b + ttonm1) - 1;
-        if(nttnm1 == 0)
-        {
-            ose_drop(bundle);
-            return;
-        }
-        int32_t plonm1 = ttonm1 + ose_pnbytes(nttnm1 + 1);
-        ++ttonm1;
-        int32_t *offsets = (int32_t *)(b + on + sn + 4);
-        int32_t *offsetp = offsets;
-        int32_t _ttonm1 = ttonm1, _plonm1 = plonm1;
-        int32_t i;
-        for(i = 0; i < nttnm1; i++)
-        {
-            *offsetp = _plonm1;
-            char tt = ose_readByte(bundle, _ttonm1);
-            _plonm1 += ose_getPayloadItemSize(bundle, tt, _plonm1);
-            ++_ttonm1;
-            ++offsetp;
-        }
-        *offsetp = _plonm1;
-        ++offsetp;
-        int32_t so = (char *)offsetp - b;
-        int32_t ao = so + 4;
-        int32_t tto = ao + 4;
-        int32_t plo = tto + ose_pnbytes(nttn + 1);
-        /* ose_writeByte(bundle, tto, OSETT_ID); */
-        b[tto] = OSETT_ID;
-        ++tto;
-        for(i = 0; i < nttn; i++)
+        fn(context, 0, n);
+    }
+}
+
+static ose_parallelfor parallelfor = sequentialFor;
+
+void ose_setParallelFor(ose_parallelfor pf)
+{
+    parallelfor = pf ? pf : sequentialFor;
+}
+
+void ose_parallelFor(int32_t n, ose_parallelfn fn, void *context)
+{
+    parallelfor(n, fn, context);
+}
+
+#define OSE_PARROUTE_COPY 0
+#define OSE_PARROUTE_ROUTE 1
+#define OSE_PARROUTE_NINDEXARRAYS 5
+
+struct ose_parroute
+{
+    ose_bundle bundle;
+    /* NULL to copy the elements that haven't been matched yet */
+    const char *address;
+    /* -1 to remove as much of the address as the match used */
+    int32_t prefixlen;
+    int32_t mode;
+    int32_t n;
+    int32_t *offsets;
+    int32_t *sizes;
+    int32_t *prefixes;
+    int32_t *outoffsets;
+    int32_t *matched;
+    int32_t outoffset;
+};
+
+static void parRouteClassify(void *context, int32_t start, int32_t end)
+{
+    struct ose_parroute * const r = (struct ose_parroute *)context;
+    const char * const b = ose_getBundlePtr(r->bundle);
+    for(int32_t k = start; k < end; k++)
+    {
+        const int32_t o = r->offsets[k];
+        r->sizes[k] = 0;
+        if(r->address)
         {
-            int32_t idx = ose_readInt32(bundle, plon + (i * 4));
-            char tt = ose_readByte(bundle, ttonm1 + idx);
-            int32_t sz = offsets[idx + 1] - offsets[idx];
-            /* ose_writeByte(bundle, tto, tt); */
-            b[tto] = tt;
-            memcpy(b + plo, b + offsets[idx], sz);
-            plo += sz;
-            ++tto;
+            int po = 0, ao = 0;
+            const int m = ose_match_pattern(b + o + 4, r->address,
+                                            &po, &ao);
+            if(m & OSE_MATCH_ADDRESS_COMPLETE)
+            {
+                r->matched[k] = 1;
+                r->prefixes[k] = r->prefixlen < 0 ? po : r->prefixlen;
+                if(r->mode == OSE_PARROUTE_ROUTE)
+                {
+                    r->sizes[k] = ose_getRoutedElemSize(o, r->bundle,
+                                                        r->prefixes[k])
+                        + 4;
+                }
+                else
+                {
+                    r->sizes[k] = ose_readInt32(r->bundle, o) + 4;
+                }
+            }
         }
-        int32_t newsize = (plo - so) - 4;
-        ose_writeInt32_outOfBounds(bundle, so, newsize);
-        memmove(b + onm1, b + so, plo - so);
-        int32_t diff = plo - (onm1 + newsize + 4);
-        if(diff > 0)
+        else if(!r->matched[k])
         {
-            memset(b + onm1 + newsize + 4, 0, diff);
+            r->sizes[k] = ose_readInt32(r->bundle, o) + 4;
         }
-        ose_addToSize(bundle, newsize - (snm1 + sn + 4));
     }
-    else
+}
+
+static void parRouteCopy(void *context, int32_t start, int32_t end)
+{
+    struct ose_parroute * const r = (struct ose_parroute *)context;
+    char * const b = ose_getBundlePtr(r->bundle);
+    for(int32_t k = start; k < end; k++)
     {
-        if(snm1 == OSE_BUNDLE_HEADER_LEN)
+        if(!r->sizes[k])
         {
-            ose_drop(bundle);
-            return;
+            continue;
         }
-        int32_t o = onm1 + 4 + OSE_BUNDLE_HEADER_LEN;
-        int32_t *offsets = (int32_t *)(b + on + sn + 4);
-        int32_t *offsetp = offsets;
-        while(o < on)
+        const int32_t o = r->offsets[k];
+        const int32_t d = r->outoffset + r->outoffsets[k];
+        if(r->address && r->mode == OSE_PARROUTE_ROUTE)
         {
-            *offsetp = o;
-            ++offsetp;
-            o += ose_readInt32(bundle, o) + 4;
+            ose_writeRoutedElemAtOffset(o, r->bundle, r->prefixes[k],
+                                        r->bundle, d);
         }
-        *offsetp = o;
-        ++offsetp;
-        int32_t so = o = (char *)offsetp - b;
-        o += 4;
-        memcpy(b + o, OSE_BUNDLE_HEADER, OSE_BUNDLE_HEADER_LEN);
-        o += OSE_BUNDLE_HEADER_LEN;
-        int32_t i;
-        for(i = 0; i < nttn; i++)
+        else
         {
-            int32_t idx = ose_readInt32(bundle, plon + (i * 4));
-            int32_t oo = offsets[idx];
-            int32_t ss = ose_readInt32(bundle, oo);
-            memcpy(b + o, b + oo, ss + 4);
-            o += ss + 4;
+            memcpy(b + d, b + o, r->sizes[k]);
         }
-        int32_t bs = (o - so) - 4;
-        ose_writeInt32_outOfBounds(bundle, so, bs);
-        memmove(b + onm1, b + so, bs + 4);
-        memset(b + onm1 + bs + 4, 0, (so + bs + 4) - (onm1 + bs + 4));
-        ose_addToSize(bundle, bs - (snm1 + sn + 4));
     }
 }
 
-static void ose_replace_impl(ose_bundle bundle,
-                             int32_t dest_offset,
-                             int32_t src_offset,
-                             int32_t src_size)
+/* indexes the elements of the bundle at offset o, and returns the
+   offset of the index, or -1 if there isn't room for it and reserve
+   more bytes */
+static int32_t parRouteInit(struct ose_parroute *r,
+                            ose_bundle bundle,
+                            int32_t o,
+                            int32_t reserve)
 {
-    char *b = ose_getBundlePtr(bundle);
-    int32_t o = dest_offset + 4 + OSE_BUNDLE_HEADER_LEN;
-    int32_t end = src_offset;
-    while(o < end)
+    const int32_t end = o + 4 + ose_readInt32(bundle, o);
+    const int32_t ts = ose_readSize(bundle) + ose_spaceAvailable(bundle);
+    int32_t n = 0;
+    int32_t i;
+    for(i = o + 4 + OSE_BUNDLE_HEADER_LEN;
+        i < end;
+        i += ose_readInt32(bundle, i) + 4)
     {
-        int32_t s = ose_readInt32(bundle, o);
-        if(!strcmp(b + o + 4, b + end + 4))
-        {
-            if(s < src_size)
-            {
-                int32_t diff = src_size - s;
-                memmove(b + o + s + 4 + diff,
-                        b + o + s + 4,
-                        (src_offset + src_size + 4) - (o + s + 4));
-                memcpy(b + o,
-                       b + src_offset + diff,
-                       src_size + 4);
-                memset(b + src_offset + diff,
-                       0,
-                       src_size + 4);
-                ose_writeInt32(bundle,
-                               dest_offset,
-                               ose_readInt32(bundle, dest_offset) + diff);
-                ose_addToSize(bundle, -((src_size + 4) - diff));
-            }
-            else if(s > src_size)
-            {
-                int32_t diff = s - src_size;
-                memcpy(b + o, b + src_offset, src_size + 4);
-                memmove(b + o + src_size + 4,
-                        b + o + s + 4,
-                        (src_offset + src_size + 4) - (o + s + 4));
-                memset(b + ((src_offset + src_size + 4) - diff),
-                       0,
-                       diff + 4); /* old context bndl size */
-                ose_writeInt32(bundle,
-                               dest_offset,
-                               ose_readInt32(bundle, dest_offset) - diff);
-                ose_addToSize(bundle, -(diff + src_size + 4));
-            }
-            else
-            {
-                memcpy(b + o, b + src_offset, s + 4);
-                memset(b + src_offset, 0, s + 4);
-                ose_addToSize(bundle, -(s + 4));
-            }
-            return;
-        }
-        else
-        {
-            o += s + 4;
-        }
+        n++;
     }
-    ose_push(bundle);
+    const int32_t limit = (ts - n * OSE_PARROUTE_NINDEXARRAYS * 4) & ~3;
+    if(limit < ose_readSize(bundle) + reserve)
+    {
+        return -1;
+    }
+    r->bundle = bundle;
+    r->n = n;
+    r->offsets = (int32_t *)(ose_getBundlePtr(bundle) + limit);
+    r->sizes = r->offsets + n;
+    r->prefixes = r->sizes + n;
+    r->outoffsets = r->prefixes + n;
+    r->matched = r->outoffsets + n;
+    n = 0;
+    for(i = o + 4 + OSE_BUNDLE_HEADER_LEN;
+        i < end;
+        i += ose_readInt32(bundle, i) + 4)
+    {
+        r->offsets[n++] = i;
+    }
+    return limit;
 }
 
-void ose_replace(ose_bundle bundle)
+static void parRouteDone(struct ose_parroute *r, int32_t limit)
 {
-    ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    memset(ose_getBundlePtr(r->bundle) + limit, 0,
+           r->n * OSE_PARROUTE_NINDEXARRAYS * 4);
+}
+
+/* matches the elements against r->address, and appends the results
+   to the bundle. returns the number of bytes appended, or -1 if
+   they wouldn't fit below limit, in which case nothing is written */
+static int32_t parRoutePass(struct ose_parroute *r, int32_t limit)
+{
+    int32_t total = 0;
+    r->outoffset = ose_readSize(r->bundle);
+    parallelfor(r->n, parRouteClassify, r);
+    for(int32_t k = 0; k < r->n; k++)
+    {
+        r->outoffsets[k] = total;
+        total += r->sizes[k];
+    }
+    if(r->outoffset + total + 4 > limit)
+    {
+        return -1;
+    }
+    ose_addToSize(r->bundle, total);
+    parallelfor(r->n, parRouteCopy, r);
+    return total;
+}
+
+/* undoes everything appended to the bundle since its size was
+   start, so that the sequential version can be run instead */
+static void parRouteAbandon(struct ose_parroute *r,
+                            int32_t start,
+                            int32_t limit)
+{
+    const int32_t cur = ose_readSize(r->bundle);
+    ose_addToSize(r->bundle, start - cur);
+    memset(ose_getBundlePtr(r->bundle) + start + 4, 0, cur - start);
+    parRouteDone(r, limit);
+}
+
+/* checks that the items of the message at on are all strings, and
+   finds its typetags and payload the way ose_gather does */
+static bool parRouteArgs(ose_bundle bundle,
+                         int32_t on,
+                         int32_t *tto,
+                         int32_t *plo,
+                         int32_t *n)
+{
+    *tto = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
+    *plo = *tto + ose_getPaddedStringLen(bundle, *tto);
+    (*tto)++;
+    *n = 0;
+    char tt;
+    while((tt = ose_readByte(bundle, *tto + *n)) != 0)
+    {
+        if(!ose_isStringType(tt))
+        {
+            return false;
+        }
+        ++(*n);
+    }
+    return true;
+}
+
+static const char *parRouteNthAddress(ose_bundle bundle,
+                                      int32_t tto,
+                                      int32_t plo,
+                                      int32_t i)
+{
+    int32_t _plo = plo;
+    for(int32_t k = 0; k < i; k++)
+    {
+        _plo += ose_getPayloadItemSize(bundle,
+                                       ose_readByte(bundle, tto + k),
+                                       _plo);
+    }
+    /* the sequential versions keep this offset in the typetag
+       string, so it's a char there, and must be here too */
+    return ose_getBundlePtr(bundle) + plo + (char)(_plo - plo);
+}
+
+static void parRouteDeleteArgs(ose_bundle bundle,
+                               int32_t onm1,
+                               int32_t snm1,
+                               int32_t on,
+                               int32_t sn,
+                               int32_t ss)
+{
+    char *b = ose_getBundlePtr(bundle);
+    memmove(b + onm1, b + on + sn + 4, ss + 4);
+    int32_t diff = (sn + snm1) - ss;
+    if(diff > 0)
+    {
+        memset(b + onm1 + ss + 4, 0, diff + 4);
+    }
+    ose_addToSize(bundle, -(sn + snm1 + 8));
+}
+
+void ose_routeParallel(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t onm1, snm1, on, sn;
+    int32_t ton, nttn, lton, pon, lpon;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    ose_assert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE);
+    ose_assert(ose_getBundleElemType(bundle, on) == OSETT_MESSAGE);
+    struct ose_parroute r;
+    /* the new bundle, whose elements are no bigger than the ones
+       they were routed from, and the trailing word */
+    const int32_t limit = snm1 <= OSE_BUNDLE_HEADER_LEN
+        ? -1
+        : parRouteInit(&r, bundle, onm1,
+                       4 + OSE_BUNDLE_HEADER_LEN + snm1 + 4);
+    if(limit < 0)
+    {
+        ose_route(bundle);
+        return;
+    }
+    ose_pushBundle(bundle);
+    ose_getNthPayloadItem(bundle, 1,
+                          on,
+                          &ton,
+                          &nttn,
+                          &lton,
+                          &pon,
+                          &lpon);
+    const char * const addr = ose_isStringType(ose_readByte(bundle, lton))
+        ? ose_readString(bundle, lpon)
+        : ose_readString(bundle, on + 4);
+    r.address = addr;
+    r.prefixlen = strlen(addr);
+    r.mode = OSE_PARROUTE_ROUTE;
+    const int32_t ns = parRoutePass(&r, limit);
+    ose_assert(ns >= 0);
+    ose_writeInt32(bundle, on + sn + 4, ns + OSE_BUNDLE_HEADER_LEN);
+    parRouteDone(&r, limit);
+    ose_nip(bundle);
+}
+
+void ose_routeWithDelegationParallel(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t onm1, snm1, on, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    ose_assert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE);
+    ose_assert(ose_getBundleElemType(bundle, on) == OSETT_MESSAGE);
+    int32_t tto, plo, n;
+    struct ose_parroute r;
+    const int32_t hdr = 4 + OSE_BUNDLE_HEADER_LEN;
+    /* the outer bundle, the delegation bundle with every element in
+       it, and the trailing word */
+    const int32_t limit = parRouteArgs(bundle, on, &tto, &plo, &n)
+        ? parRouteInit(&r, bundle, onm1, (n + 2) * hdr + snm1 + 4)
+        : -1;
+    if(limit < 0)
+    {
+        ose_routeWithDelegation(bundle);
+        return;
+    }
+    const int32_t start = ose_readSize(bundle);
+    ose_pushBundle(bundle);
+    r.prefixlen = -1;
+    r.mode = OSE_PARROUTE_ROUTE;
+    for(int32_t i = n - 1; i >= 0; --i)
+    {
+        const int32_t bo = ose_readSize(bundle);
+        ose_pushBundle(bundle);
+        r.address = parRouteNthAddress(bundle, tto, plo, i);
+        /* leave room for the rest of the bundles */
+        const int32_t ns = parRoutePass(&r,
+                                        limit - (i + 1) * hdr - snm1);
+        if(ns < 0)
+        {
+            parRouteAbandon(&r, start, limit);
+            ose_routeWithDelegation(bundle);
+            return;
+        }
+        ose_writeInt32(bundle, bo, ns + OSE_BUNDLE_HEADER_LEN);
+    }
+    /* delegation */
+    const int32_t dlo = ose_readSize(bundle);
+    ose_pushBundle(bundle);
+    r.address = NULL;
+    const int32_t ns = parRoutePass(&r, limit);
+    ose_assert(ns >= 0);
+    ose_writeInt32(bundle, dlo, ns + OSE_BUNDLE_HEADER_LEN);
+    parRouteDone(&r, limit);
+    const int32_t ss = (dlo + hdr + ns) - (on + sn + 4 + 4);
+    ose_writeInt32(bundle, on + sn + 4, ss);
+    parRouteDeleteArgs(bundle, onm1, snm1, on, sn, ss);
+}
+
+void ose_gatherParallel(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t onm1, snm1, on, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    ose_assert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE);
+    ose_assert(ose_getBundleElemType(bundle, on) == OSETT_MESSAGE);
+    int32_t tto, plo, n;
+    struct ose_parroute r;
+    const int32_t hdr = 4 + OSE_BUNDLE_HEADER_LEN;
+    /* both bundles, the delegation bundle with every element in it,
+       and the trailing word */
+    const int32_t limit = parRouteArgs(bundle, on, &tto, &plo, &n)
+        ? parRouteInit(&r, bundle, onm1, 2 * hdr + snm1 + 4)
+        : -1;
+    if(limit < 0)
+    {
+        ose_gather(bundle);
+        return;
+    }
+    const int32_t start = ose_readSize(bundle);
+    ose_pushBundle(bundle);
+    int32_t bundlesize = OSE_BUNDLE_HEADER_LEN;
+    r.prefixlen = 0;
+    r.mode = OSE_PARROUTE_COPY;
+    for(int32_t i = n - 1; i >= 0; --i)
+    {
+        r.address = parRouteNthAddress(bundle, tto, plo, i);
+        /* leave room for the delegation bundle */
+        const int32_t ns = parRoutePass(&r, limit - hdr - snm1);
+        if(ns < 0)
+        {
+            parRouteAbandon(&r, start, limit);
+            ose_gather(bundle);
+            return;
+        }
+        bundlesize += ns;
+    }
+    ose_writeInt32(bundle, on + sn + 4, bundlesize);
+    /* delegation */
+    const int32_t dlo = ose_readSize(bundle);
+    ose_pushBundle(bundle);
+    r.address = NULL;
+    const int32_t ns = parRoutePass(&r, limit);
+    ose_assert(ns >= 0);
+    ose_writeInt32(bundle, dlo, ns + OSE_BUNDLE_HEADER_LEN);
+    parRouteDone(&r, limit);
+    const int32_t ss = (dlo + hdr + ns) - (on + sn + 4 + 4);
+    parRouteDeleteArgs(bundle, onm1, snm1, on, sn, ss);
+}
+
+/*
+  Peephole pass
+
+  Replaces pairs of words in a bundle of code with a single builtin
+  that does the same thing, so that the pair costs one trip through
+  the VM and one walk of the stack. A word is a message whose
+  address is the word and which has no items, or an anonymous
+  message with the word as its only item, which is what the VM
+  turns both of those into. The pass assumes that the builtins
+  involved haven't been redefined in the environment.
+*/
+static const struct
+{
+    const char *first;
+    const char *second;
+    const char *fused;
+} peepholeRules[] = {
+    {"/!/swap", "/!/drop", "/!/nip"},
+    {"/!/over", "/!/over", "/!/2dup"},
+    {"/!/rot", "/!/rot", "/!/-rot"},
+    {"/!/pop", "/!/swap", "/!/pop/swap"},
+};
+
+/* returns the word in the element at o, and whether it's in an
+   anonymous message, or NULL if the element isn't a word */
+static const char *peepholeWord(const char * const b,
+                                int32_t o,
+                                bool *anon)
+{
+    const int32_t s = ose_ntohl(*((int32_t *)(b + o)));
+    const char * const address = b + o + 4;
+    if(!strncmp(address, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+    {
+        return NULL;
+    }
+    const int32_t tto = 4 + ose_pnbytes(strlen(address));
+    if(!memcmp(address, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE))
+    {
+        if(tto + 4 < s + 4
+           && !strcmp(b + o + tto, ",s"))
+        {
+            *anon = true;
+            return b + o + tto + 4;
+        }
+        return NULL;
+    }
+    if(tto == s + 4 || !strcmp(b + o + tto, ","))
+    {
+        *anon = false;
+        return address;
+    }
+    return NULL;
+}
+
+/* writes word at o as an element of the given form, and returns
+   its size */
+static int32_t peepholeWriteWord(char * const b,
+                                 int32_t o,
+                                 const char * const word,
+                                 bool anon)
+{
+    const int32_t wlen = strlen(word);
+    const int32_t s = anon
+        ? OSE_ADDRESS_ANONVAL_SIZE + 4 + ose_pnbytes(wlen)
+        : ose_pnbytes(wlen) + OSE_EMPTY_TYPETAG_STRING_SIZE;
+    memset(b + o, 0, s + 4);
+    *((int32_t *)(b + o)) = ose_htonl(s);
+    if(anon)
+    {
+        memcpy(b + o + 4, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
+        memcpy(b + o + 4 + OSE_ADDRESS_ANONVAL_SIZE, ",s", 2);
+        memcpy(b + o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 4, word, wlen);
+    }
+    else
+    {
+        memcpy(b + o + 4, word, wlen);
+        b[o + 4 + ose_pnbytes(wlen)] = ',';
+    }
+    return s;
+}
+
+/* rewrites the bundle whose size is at o, and any bundles nested
+   in it, in place, and returns its new size. the new elements are
+   never bigger than the ones they replace, so the rewritten bundle
+   never overtakes the bytes it's being read from */
+static int32_t peephole(char * const b, const int32_t o)
+{
+    const int32_t end = o + 4 + ose_ntohl(*((int32_t *)(b + o)));
+    int32_t r = o + 4 + OSE_BUNDLE_HEADER_LEN;
+    int32_t w = r;
+    while(r < end)
+    {
+        const int32_t s = ose_ntohl(*((int32_t *)(b + r)));
+        const int32_t r2 = r + s + 4;
+        bool anon1 = false, anon2 = false;
+        const char * const word1 = peepholeWord(b, r, &anon1);
+        const char * const word2 = (word1 && r2 < end)
+            ? peepholeWord(b, r2, &anon2)
+            : NULL;
+        const char *fused = NULL;
+        if(word2)
+        {
+            for(size_t i = 0;
+                i < sizeof(peepholeRules) / sizeof(peepholeRules[0]);
+                i++)
+            {
+                if(!strcmp(word1, peepholeRules[i].first)
+                   && !strcmp(word2, peepholeRules[i].second))
+                {
+                    fused = peepholeRules[i].fused;
+                    break;
+                }
+            }
+        }
+        if(fused)
+        {
+            const int32_t s2 = ose_ntohl(*((int32_t *)(b + r2)));
+            w += peepholeWriteWord(b, w, fused, anon1) + 4;
+            r = r2 + s2 + 4;
+            continue;
+        }
+        if(w != r)
+        {
+            memmove(b + w, b + r, s + 4);
+        }
+        if(!word1
+           && !strncmp(b + w + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+        {
+            const int32_t ns = peephole(b, w);
+            *((int32_t *)(b + w)) = ose_htonl(ns);
+            w += ns + 4;
+        }
+        else
+        {
+            w += s + 4;
+        }
+        r = r2;
+    }
+    memset(b + w, 0, end - w);
+    return w - (o + 4);
+}
+
+void ose_peephole(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 1));
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_rassert(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE, 1);
+    const int32_t s = ose_readInt32(bundle, o);
+    const int32_t ns = peephole(ose_getBundlePtr(bundle), o);
+    ose_writeInt32(bundle, o, ns);
+    ose_decSize(bundle, s - ns);
+}
+
+void ose_nth(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t onm1, snm1, on, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    ose_assert(ose_getBundleElemType(bundle, on) == OSETT_MESSAGE);
+    char *b = ose_getBundlePtr(bundle);
+    int32_t tton = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
+    int32_t nttn = strlen(b + tton) - 1;
+    int32_t plon = tton + ose_pnbytes(nttn + 1);
+    ++tton;
+    if(ose_getBundleElemType(bundle, onm1) == OSETT_MESSAGE)
+    {
+        int32_t ttonm1 = onm1 + 4 + ose_getPaddedStringLen(bundle,
+                                                           onm1 + 4);
+        int32_t nttnm1 = strlen(b + ttonm1) - 1;
+        if(nttnm1 == 0)
+        {
+            ose_drop(bundle);
+            return;
+        }
+        int32_t plonm1 = ttonm1 + ose_pnbytes(nttnm1 + 1);
+        ++ttonm1;
+        int32_t *offsets = (int32_t *)(b + on + sn + 4);
+        int32_t *offsetp = offsets;
+        int32_t _ttonm1 = ttonm1, _plonm1 = plonm1;
+        int32_t i;
+        for(i = 0; i < nttnm1; i++)
+        {
+            *offsetp = _plonm1;
+            char tt = ose_readByte(bundle, _ttonm1);
+            _plonm1 += ose_getPayloadItemSize(bundle, tt, _plonm1);
+            ++_ttonm1;
+            ++offsetp;
+        }
+        *offsetp = _plonm1;
+        ++offsetp;
+        int32_t so = (char *)offsetp - b;
+        int32_t ao = so + 4;
+        int32_t tto = ao + 4;
+        int32_t plo = tto + ose_pnbytes(nttn + 1);
+        /* ose_writeByte(bundle, tto, OSETT_ID); */
+        b[tto] = OSETT_ID;
+        ++tto;
+        for(i = 0; i < nttn; i++)
+        {
+            int32_t idx = ose_readInt32(bundle, plon + (i * 4));
+            char tt = ose_readByte(bundle, ttonm1 + idx);
+            int32_t sz = offsets[idx + 1] - offsets[idx];
+            /* ose_writeByte(bundle, tto, tt); */
+            b[tto] = tt;
+            memcpy(b + plo, b + offsets[idx], sz);
+            plo += sz;
+            ++tto;
+        }
+        int32_t newsize = (plo - so) - 4;
+        ose_writeInt32_outOfBounds(bundle, so, newsize);
+        memmove(b + onm1, b + so, plo - so);
+        int32_t diff = plo - (onm1 + newsize + 4);
+        if(diff > 0)
+        {
+            memset(b + onm1 + newsize + 4, 0, diff);
+        }
+        ose_addToSize(bundle, newsize - (snm1 + sn + 4));
+    }
+    else
+    {
+        if(snm1 == OSE_BUNDLE_HEADER_LEN)
+        {
+            ose_drop(bundle);
+            return;
+        }
+        int32_t o = onm1 + 4 + OSE_BUNDLE_HEADER_LEN;
+        int32_t *offsets = (int32_t *)(b + on + sn + 4);
+        int32_t *offsetp = offsets;
+        while(o < on)
+        {
+            *offsetp = o;
+            ++offsetp;
+            o += ose_readInt32(bundle, o) + 4;
+        }
+        *offsetp = o;
+        ++offsetp;
+        int32_t so = o = (char *)offsetp - b;
+        o += 4;
+        memcpy(b + o, OSE_BUNDLE_HEADER, OSE_BUNDLE_HEADER_LEN);
+        o += OSE_BUNDLE_HEADER_LEN;
+        int32_t i;
+        for(i = 0; i < nttn; i++)
+        {
+            int32_t idx = ose_readInt32(bundle, plon + (i * 4));
+            int32_t oo = offsets[idx];
+            int32_t ss = ose_readInt32(bundle, oo);
+            memcpy(b + o, b + oo, ss + 4);
+            o += ss + 4;
+        }
+        int32_t bs = (o - so) - 4;
+        ose_writeInt32_outOfBounds(bundle, so, bs);
+        memmove(b + onm1, b + so, bs + 4);
+        memset(b + onm1 + bs + 4, 0, (so + bs + 4) - (onm1 + bs + 4));
+        ose_addToSize(bundle, bs - (snm1 + sn + 4));
+    }
+}
+
+/*
+  Replaces the element at o, whose size is s, in the bundle at
+  dest_offset with the element at src_offset, which must be the
+  last element, and is src_size bytes long.
+*/
+static void replaceAt(ose_bundle bundle,
+                      int32_t dest_offset,
+                      int32_t o,
+                      int32_t s,
+                      int32_t src_offset,
+                      int32_t src_size)
+{
+    char *b = ose_getBundlePtr(bundle);
+    if(s < src_size)
+    {
+        int32_t diff = src_size - s;
+        memmove(b + o + s + 4 + diff,
+                b + o + s + 4,
+                (src_offset + src_size + 4) - (o + s + 4));
+        memcpy(b + o,
+               b + src_offset + diff,
+               src_size + 4);
+        memset(b + src_offset + diff,
+               0,
+               src_size + 4);
+        ose_writeInt32(bundle,
+                       dest_offset,
+                       ose_readInt32(bundle, dest_offset) + diff);
+        ose_addToSize(bundle, -((src_size + 4) - diff));
+    }
+    else if(s > src_size)
+    {
+        int32_t diff = s - src_size;
+        memcpy(b + o, b + src_offset, src_size + 4);
+        memmove(b + o + src_size + 4,
+                b + o + s + 4,
+                (src_offset + src_size + 4) - (o + s + 4));
+        /* everything from the new end of the moved elements to
+           the end of the source has to be cleared */
+        memset(b + (src_offset - diff),
+               0,
+               src_size + 4 + diff);
+        ose_writeInt32(bundle,
+                       dest_offset,
+                       ose_readInt32(bundle, dest_offset) - diff);
+        ose_addToSize(bundle, -(diff + src_size + 4));
+    }
+    else
+    {
+        memcpy(b + o, b + src_offset, s + 4);
+        memset(b + src_offset, 0, s + 4);
+        ose_addToSize(bundle, -(s + 4));
+    }
+}
+
+static void ose_replace_impl(ose_bundle bundle,
+                             int32_t dest_offset,
+                             int32_t src_offset,
+                             int32_t src_size)
+{
+    char *b = ose_getBundlePtr(bundle);
+    int32_t o = dest_offset + 4 + OSE_BUNDLE_HEADER_LEN;
+    int32_t end = src_offset;
+    while(o < end)
+    {
+        int32_t s = ose_readInt32(bundle, o);
+        if(!strcmp(b + o + 4, b + end + 4))
+        {
+            replaceAt(bundle, dest_offset, o, s, src_offset, src_size);
+            return;
+        }
+        else
+        {
+            o += s + 4;
+        }
+    }
+    ose_push(bundle);
+}
+
+void ose_replace(ose_bundle bundle)
+{
+    ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
     int32_t on, sn, onm1, snm1;
     be2(bundle, &onm1, &snm1, &on, &sn);
     ose_rassert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE, 1);
@@ -3177,7 +4038,14 @@ void ose_replace(ose_bundle bundle)
     ose_replace_impl(bundle, onm1, on, sn);
 }
 
-void ose_assign(ose_bundle bundle)
+/*
+  Turns the value below the address on top of the stack into a
+  message with that address, and returns its size. The bundle it's
+  going into is at onm2, and the message at onm1.
+*/
+static int32_t assignMessage(ose_bundle bundle,
+                             int32_t *onm2_out,
+                             int32_t *onm1_out)
 {
     ose_rassert(ose_bundleHasAtLeastNElems(bundle, 3), 1);
     int32_t on, sn, onm1, snm1, onm2, snm2;
@@ -3209,15 +4077,23 @@ void ose_assign(ose_bundle bundle)
     data_offset += ose_pstrlen(b + data_offset);
     int32_t data_len = on - data_offset;
     memcpy(b + on + 4 + paddylen, b + data_offset, data_len);
-    memcpy(b + onm1 + 4, b + on + 4, paddylen + data_len);
+    memmove(b + onm1 + 4, b + on + 4, paddylen + data_len);
     int32_t extra = ose_readSize(bundle)
         - (onm1 + 4 + paddylen + data_len);
         
     memset(b + onm1 + 4 + paddylen + data_len, 0, extra);
     ose_decSize(bundle, extra);
     ose_writeInt32(bundle, onm1, paddylen + data_len);
+    *onm2_out = onm2;
+    *onm1_out = onm1;
+    return paddylen + data_len;
+}
 
-    ose_replace_impl(bundle, onm2, onm1, paddylen + data_len);
+void ose_assign(ose_bundle bundle)
+{
+    int32_t onm2, onm1;
+    const int32_t s = assignMessage(bundle, &onm2, &onm1);
+    ose_replace_impl(bundle, onm2, onm1, s);
 }
 
 void ose_lookup(ose_bundle bundle)
@@ -3241,7 +4117,7 @@ void ose_lookup(ose_bundle bundle)
         {
             memset(b + on, 0, sn + 4);
             int32_t len = (ss + 4) - (sn + 4);
-            ose_incSize(bundle, len);
+            ose_addToSize(bundle, len);
             memcpy(b + on, b + o, ss + 4);
             return;
         }
@@ -3280,752 +4156,1824 @@ void ose_pushBundle(ose_bundle bundle)
     memcpy(b + wp + 4, OSE_BUNDLE_HEADER, OSE_BUNDLE_HEADER_LEN);
 }
 
-/**************************************************
- * arithmetic
- **************************************************/
+/**************************************************
+ * arithmetic
+ **************************************************/
+
+/*
+  Arithmetic operates on the last item of each of the two messages
+  on top of the stack, and replaces both with an anonymous message
+  holding the result. Each numeric type has an index, and the
+  indices are in order of promotion: when the two operands have
+  different types, the one with the lower index is converted to
+  the type of the other, so that, for example, int32 and int64
+  give int64, and any integer and float give float.
+
+  For each operation, there is a table of kernels indexed by the
+  type of the result. The operands are loaded, converted if their
+  types differ, passed to the kernel, and the result is written
+  over the lower of the two messages, with a single size update
+  to remove what's left of them.
+*/
+enum
+{
+    NUM_INT8,
+    NUM_UINT8,
+    NUM_INT32,
+    NUM_UINT32,
+    NUM_INT64,
+    NUM_UINT64,
+    NUM_FLOAT,
+    NUM_DOUBLE,
+    NUM_NTYPES
+};
+
+union numval
+{
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+    float f;
+    double d;
+};
+
+typedef union numval (*numkernel)(union numval a, union numval b);
+
+static const int32_t numSize[NUM_NTYPES] = {4, 4, 4, 4, 8, 8, 4, 8};
+
+static int numIndex(const char typetag)
+{
+    switch(typetag)
+    {
+    case OSETT_INT32:
+        return NUM_INT32;
+    case OSETT_FLOAT:
+        return NUM_FLOAT;
+#ifdef OSE_PROVIDE_TYPE_DOUBLE
+    case OSETT_DOUBLE:
+        return NUM_DOUBLE;
+#endif
+#ifdef OSE_PROVIDE_TYPE_INT8
+    case OSETT_INT8:
+        return NUM_INT8;
+#endif
+#ifdef OSE_PROVIDE_TYPE_UINT8
+    case OSETT_UINT8:
+        return NUM_UINT8;
+#endif
+#ifdef OSE_PROVIDE_TYPE_UINT32
+    case OSETT_UINT32:
+        return NUM_UINT32;
+#endif
+#ifdef OSE_PROVIDE_TYPE_INT64
+    case OSETT_INT64:
+        return NUM_INT64;
+#endif
+#ifdef OSE_PROVIDE_TYPE_UINT64
+    case OSETT_UINT64:
+        return NUM_UINT64;
+#endif
+    default:
+        return -1;
+    }
+}
+
+static union numval numLoad(const int t, const char * const p)
+{
+    union numval v;
+    switch(t)
+    {
+    case NUM_INT8:
+    case NUM_INT32:
+        v.i32 = ose_ntohl(*((int32_t *)p));
+        break;
+    case NUM_UINT8:
+    case NUM_UINT32:
+    case NUM_FLOAT:
+        v.u32 = ose_ntohl(*((uint32_t *)p));
+        break;
+    default:
+    {
+        /* 64-bit items are only 4-byte aligned */
+        uint64_t u;
+        memcpy(&u, p, 8);
+        v.u64 = ose_ntohll(u);
+    }
+        break;
+    }
+    return v;
+}
+
+static void numStore(const int t, char * const p, const union numval v)
+{
+    switch(t)
+    {
+    case NUM_INT8:
+    case NUM_INT32:
+    case NUM_UINT8:
+    case NUM_UINT32:
+    case NUM_FLOAT:
+        *((uint32_t *)p) = ose_htonl(v.u32);
+        break;
+    default:
+    {
+        const uint64_t u = ose_htonll(v.u64);
+        memcpy(p, &u, 8);
+    }
+        break;
+    }
+}
+
+/* to is never lower than from */
+static union numval numConvert(const union numval v,
+                               const int from,
+                               const int to)
+{
+    union numval r;
+    if(from == to)
+    {
+        return v;
+    }
+    if(to >= NUM_FLOAT)
+    {
+        double d;
+        switch(from)
+        {
+        case NUM_INT8:
+        case NUM_INT32:
+            d = v.i32;
+            break;
+        case NUM_UINT8:
+        case NUM_UINT32:
+            d = v.u32;
+            break;
+        case NUM_INT64:
+            d = v.i64;
+            break;
+        case NUM_UINT64:
+            d = v.u64;
+            break;
+        default:
+            d = v.f;
+            break;
+        }
+        if(to == NUM_FLOAT)
+        {
+            r.f = d;
+        }
+        else
+        {
+            r.d = d;
+        }
+        return r;
+    }
+    {
+        const int64_t i = (from == NUM_INT8 || from == NUM_INT32)
+            ? (int64_t)v.i32 : (int64_t)v.u32;
+        switch(to)
+        {
+        case NUM_UINT8:
+            r.u32 = (uint8_t)i;
+            break;
+        case NUM_INT32:
+            r.i32 = (int32_t)i;
+            break;
+        case NUM_UINT32:
+            r.u32 = (uint32_t)i;
+            break;
+        case NUM_INT64:
+            r.i64 = i;
+            break;
+        default:
+            r.u64 = (from == NUM_INT64) ? (uint64_t)v.i64
+                : (uint64_t)i;
+            break;
+        }
+    }
+    return r;
+}
+
+#define NUM_KERNEL(name, suffix, m, cast, EXPR)                 \
+    static union numval name##_##suffix(union numval a,         \
+                                        union numval b)         \
+    {                                                           \
+        union numval r;                                         \
+        (void)b;                                                \
+        r.m = cast(EXPR(a.m, b.m));                             \
+        return r;                                               \
+    }
+
+#define NUM_KERNELS(name, EXPR, FEXPR, DEXPR)                       \
+    NUM_KERNEL(name, i8, i32, (int8_t), EXPR)                       \
+    NUM_KERNEL(name, u8, u32, (uint8_t), EXPR)                      \
+    NUM_KERNEL(name, i32, i32, (int32_t), EXPR)                     \
+    NUM_KERNEL(name, u32, u32, (uint32_t), EXPR)                    \
+    NUM_KERNEL(name, i64, i64, (int64_t), EXPR)                     \
+    NUM_KERNEL(name, u64, u64, (uint64_t), EXPR)                    \
+    NUM_KERNEL(name, f, f, (float), FEXPR)                          \
+    NUM_KERNEL(name, d, d, (double), DEXPR)                         \
+    static const numkernel name##Kernels[NUM_NTYPES] = {            \
+        name##_i8, name##_u8, name##_i32, name##_u32,               \
+        name##_i64, name##_u64, name##_f, name##_d                  \
+    };
+
+/* comparisons always give an int32 */
+#define NUM_CMP_KERNEL(name, suffix, m, EXPR)                   \
+    static union numval name##_##suffix(union numval a,         \
+                                        union numval b)         \
+    {                                                           \
+        union numval r;                                         \
+        r.i32 = EXPR(a.m, b.m);                                 \
+        return r;                                               \
+    }
+
+#define NUM_CMP_KERNELS(name, EXPR)                                 \
+    NUM_CMP_KERNEL(name, i8, i32, EXPR)                             \
+    NUM_CMP_KERNEL(name, u8, u32, EXPR)                             \
+    NUM_CMP_KERNEL(name, i32, i32, EXPR)                            \
+    NUM_CMP_KERNEL(name, u32, u32, EXPR)                            \
+    NUM_CMP_KERNEL(name, i64, i64, EXPR)                            \
+    NUM_CMP_KERNEL(name, u64, u64, EXPR)                            \
+    NUM_CMP_KERNEL(name, f, f, EXPR)                                \
+    NUM_CMP_KERNEL(name, d, d, EXPR)                                \
+    static const numkernel name##Kernels[NUM_NTYPES] = {            \
+        name##_i8, name##_u8, name##_i32, name##_u32,               \
+        name##_i64, name##_u64, name##_f, name##_d                  \
+    };
+
+#define NUM_ADD(x, y) ((x) + (y))
+#define NUM_SUB(x, y) ((x) - (y))
+#define NUM_MUL(x, y) ((x) * (y))
+#define NUM_DIV(x, y) ((x) / (y))
+#define NUM_MOD(x, y) ((x) % (y))
+#define NUM_POW(x, y) pow((double)(x), (double)(y))
+#define NUM_NEG(x, y) (-(x))
+#define NUM_LTE(x, y) ((x) <= (y))
+#define NUM_LT(x, y) ((x) < (y))
+
+NUM_KERNELS(add, NUM_ADD, NUM_ADD, NUM_ADD)
+NUM_KERNELS(sub, NUM_SUB, NUM_SUB, NUM_SUB)
+NUM_KERNELS(mul, NUM_MUL, NUM_MUL, NUM_MUL)
+NUM_KERNELS(div, NUM_DIV, NUM_DIV, NUM_DIV)
+NUM_KERNELS(mod, NUM_MOD, fmodf, fmod)
+NUM_KERNELS(pow, NUM_POW, powf, pow)
+NUM_KERNELS(neg, NUM_NEG, NUM_NEG, NUM_NEG)
+NUM_CMP_KERNELS(lte, NUM_LTE)
+NUM_CMP_KERNELS(lt, NUM_LT)
+
+/* replaces the oldsize bytes of elements at o with an anonymous
+   message holding v */
+static void writeNumericResult(ose_bundle bundle,
+                               const int32_t o,
+                               const int32_t oldsize,
+                               const int t,
+                               const char typetag,
+                               const union numval v)
+{
+    char *b = ose_getBundlePtr(bundle);
+    const int32_t n = 4 + OSE_ADDRESS_ANONVAL_SIZE + 4 + numSize[t];
+    ose_assert(n <= oldsize);
+    *((int32_t *)(b + o)) = ose_htonl(n - 4);
+#ifdef OSE_USER_ADDRESS_ANONVAL
+    memcpy(b + o + 4, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
+#else
+    memset(b + o + 4, 0, OSE_ADDRESS_ANONVAL_SIZE);
+#endif
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE] = OSETT_ID;
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 1] = typetag;
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 2] = 0;
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 3] = 0;
+    numStore(t, b + o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 4, v);
+    if(oldsize > n)
+    {
+        memset(b + o + n, 0, oldsize - n);
+        ose_decSize(bundle, oldsize - n);
+    }
+}
+
+/* applies kernels[t](top, lower), where t is the promoted type */
+static void arith(ose_bundle bundle,
+                  const numkernel * const kernels,
+                  const bool cmp,
+                  const bool divides)
+{
+    int32_t onm1, snm1, on, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    int32_t nm1to, nm1ntt, nm1lto, nm1po, nm1lpo;
+    int32_t nto, nntt, nlto, npo, nlpo;
+    ose_getNthPayloadItem(bundle, 1, onm1,
+                          &nm1to, &nm1ntt, &nm1lto, &nm1po, &nm1lpo);
+    ose_getNthPayloadItem(bundle, 1, on,
+                          &nto, &nntt, &nlto, &npo, &nlpo);
+    const char *b = ose_getBundlePtr(bundle);
+    const char t2 = b[nm1lto];
+    const char t1 = b[nlto];
+    const int i2 = numIndex(t2);
+    const int i1 = numIndex(t1);
+    if(i1 < 0 || i2 < 0)
+    {
+        ose_errno_set(bundle, OSE_ERR_ITEM_TYPE);
+        return;
+    }
+    const int t = i1 > i2 ? i1 : i2;
+    const union numval v1 = numConvert(numLoad(i1, b + nlpo), i1, t);
+    const union numval v2 = numConvert(numLoad(i2, b + nm1lpo), i2, t);
+    if(divides && t < NUM_FLOAT
+       && (numSize[t] == 4 ? v2.u32 == 0 : v2.u64 == 0))
+    {
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+    /* the most negative value divided by -1 doesn't fit */
+    if(divides
+       && (((t == NUM_INT8 || t == NUM_INT32)
+            && v1.i32 == INT32_MIN && v2.i32 == -1)
+           || (t == NUM_INT64
+               && v1.i64 == INT64_MIN && v2.i64 == -1)))
+    {
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+    if(cmp)
+    {
+        writeNumericResult(bundle, onm1, snm1 + sn + 8,
+                           NUM_INT32, OSETT_INT32, kernels[t](v1, v2));
+    }
+    else
+    {
+        writeNumericResult(bundle, onm1, snm1 + sn + 8,
+                           t, i1 > i2 ? t1 : t2, kernels[t](v1, v2));
+    }
+}
+
+void ose_add(ose_bundle bundle)
+{
+    arith(bundle, addKernels, false, false);
+}
+
+void ose_sub(ose_bundle bundle)
+{
+    arith(bundle, subKernels, false, false);
+}
+
+void ose_mul(ose_bundle bundle)
+{
+    arith(bundle, mulKernels, false, false);
+}
+
+void ose_div(ose_bundle bundle)
+{
+    arith(bundle, divKernels, false, true);
+}
+
+void ose_mod(ose_bundle bundle)
+{
+    arith(bundle, modKernels, false, true);
+}
 
-void ose_add(ose_bundle bundle)
+void ose_pow(ose_bundle bundle)
 {
-    int32_t onm1, snm1, on, sn;
-    be2(bundle, &onm1, &snm1, &on, &sn);
-    int32_t nm1to, nm1ntt, nm1lto, nm1po, nm1lpo;
+    arith(bundle, powKernels, false, false);
+}
+
+void ose_neg(ose_bundle bundle)
+{
+    int32_t on, sn;
+    be1(bundle, &on, &sn);
     int32_t nto, nntt, nlto, npo, nlpo;
-    ose_getNthPayloadItem(bundle, 1, onm1,
-                          &nm1to, &nm1ntt, &nm1lto, &nm1po, &nm1lpo);
     ose_getNthPayloadItem(bundle, 1, on,
                           &nto, &nntt, &nlto, &npo, &nlpo);
-    char t2 = ose_readByte(bundle, nm1lto); /* (void)t2; */
-    /* ose_assert(ose_isNumericType(t2)); */
-    char t1 = ose_readByte(bundle, nlto);
-    /* ose_assert(ose_isNumericType(t1)); */
-    /* ose_assert(t1 == t2); */
-    if(!ose_isNumericType(t1)
-       || !ose_isNumericType(t2)
-       || t1 != t2)
+    const char *b = ose_getBundlePtr(bundle);
+    const char t1 = b[nlto];
+    const int i1 = numIndex(t1);
+    if(i1 < 0)
     {
         ose_errno_set(bundle, OSE_ERR_ITEM_TYPE);
         return;
     }
-    /* char t2 = ose_readByte(bundle, nm1lto); (void)t2; */
-    /* ose_assert(ose_isNumericType(t2)); */
-    /* char t1 = ose_readByte(bundle, nlto); */
-    /* ose_assert(ose_isNumericType(t1)); */
-    /* ose_assert(t1 == t2); */
+    const union numval v1 = numLoad(i1, b + nlpo);
+    writeNumericResult(bundle, on, sn + 4, i1, t1,
+                       negKernels[i1](v1, v1));
+}
+
+void ose_eql(ose_bundle bundle)
+{
+    int32_t onm1, on, snm1, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    int32_t tonm1 = onm1 + 4 + ose_getPaddedStringLen(bundle, onm1 + 4);
+    int32_t ton = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
     char *b = ose_getBundlePtr(bundle);
-    switch(t1)
-    {
-    case OSETT_INT32:
+    int32_t lnm1 = snm1 - (tonm1 - (onm1 + 4));
+    int32_t ln = sn - (ton - (on + 4));
+    if(lnm1 != ln)
     {
-        int32_t v2 = ose_readInt32(bundle, nm1lpo);
-        int32_t v1 = ose_readInt32(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushInt32(bundle, v1 + v2);
+        ose_2drop(bundle);
+        ose_pushInt32(bundle, 0);
+        return;
     }
-    break;
-    case OSETT_FLOAT:
+    if(!memcmp(b + tonm1, b + ton, ln))
     {
-        float v2 = ose_readFloat(bundle, nm1lpo);
-        float v1 = ose_readFloat(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushFloat(bundle, v1 + v2);
+        ose_pushInt32(bundle, 1);
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
+    else
     {
-
+        ose_pushInt32(bundle, 0);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
-    {
+    ose_swap(bundle);
+    ose_drop(bundle);
+    ose_swap(bundle);
+    ose_drop(bundle);
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
+void ose_neq(ose_bundle bundle)
+{
+    int32_t onm1, on, snm1, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    int32_t tonm1 = onm1 + 4 + ose_getPaddedStringLen(bundle, onm1 + 4);
+    int32_t ton = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
+    char *b = ose_getBundlePtr(bundle);
+    int32_t lnm1 = snm1 - (tonm1 - (onm1 + 4));
+    int32_t ln = sn - (ton - (on + 4));
+    if(lnm1 != ln)
     {
-
+        ose_2drop(bundle);
+        ose_pushInt32(bundle, 0);
+        return;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
+    if(!memcmp(b + tonm1, b + ton, ln))
     {
-
+        ose_pushInt32(bundle, 0);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
+    else
     {
-
+        ose_pushInt32(bundle, 1);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
-    {
+    ose_swap(bundle);
+    ose_drop(bundle);
+    ose_swap(bundle);
+    ose_drop(bundle);
+}
 
-    }
-    break;
-#endif
-    }
+void ose_lte(ose_bundle bundle)
+{
+    arith(bundle, lteKernels, true, false);
 }
 
-void ose_sub(ose_bundle bundle)
+void ose_lt(ose_bundle bundle)
 {
-    char t1 = ose_peekMessageArgType(bundle);
-    ose_assert(ose_isNumericType(t1));
-    ose_swap(bundle);
-    char t2 = ose_peekMessageArgType(bundle);(void)t2;
-    ose_assert(ose_isNumericType(t2));
-    ose_assert(t1 == t2);
-    switch(t1)
-    {
-    case OSETT_INT32:
+    arith(bundle, ltKernels, true, false);
+}
+
+void ose_and(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t i1 = ose_popInt32(bundle);
+    int32_t i2 = ose_popInt32(bundle);
+    ose_pushInt32(bundle, i1 && i2);
+}
+
+void ose_or(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t i1 = ose_popInt32(bundle);
+    int32_t i2 = ose_popInt32(bundle);
+    ose_pushInt32(bundle, i1 || i2);
+}
+
+/**************************************************
+ * sorting
+ **************************************************/
+
+/*
+  The sorts build an index of the elements of the bundle on top of
+  the stack in the free space after it, sort the index, and then
+  copy the elements, in their new order, into the free space after
+  the index, from where they are copied back over the contents of
+  the bundle in one go.
+
+  Numeric keys are turned into unsigned 64-bit integers that sort
+  in the same order as the numbers they came from, so that the
+  index can be sorted with an LSD radix sort, one byte at a time,
+  skipping the bytes that are the same in every key. If any key is
+  a float or double, all of them are compared as doubles;
+  otherwise they are compared as int64s, and uint64s above the
+  largest int64 are clamped to it. Elements that have no key sort
+  last. Addresses are sorted with a merge sort. Both sorts are
+  stable.
+*/
+struct sortent
+{
+    uint64_t key;
+    int32_t offset;
+    int32_t size;
+};
+
+#define SORT_NOKEY 0xffffffffffffffffULL
+#define SORT_FIRSTNUMERIC -1
+
+/* the offset of the payload of the nth item of the message at o, or
+   of its first numeric item if n is SORT_FIRSTNUMERIC, and its
+   type, or -1 if there isn't one */
+static int32_t sortItem(ose_constbundle bundle,
+                        const int32_t o,
+                        const int32_t n,
+                        int *t)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    if(ose_getBundleElemType(bundle, o) != OSETT_MESSAGE)
     {
-        int32_t v2 = ose_popInt32(bundle);
-        int32_t v1 = ose_popInt32(bundle);
-        ose_pushInt32(bundle, v1 - v2);
+        return -1;
     }
-    break;
-    case OSETT_FLOAT:
+    const int32_t s = ose_readInt32(bundle, o);
+    int32_t tto = o + 4 + ose_getPaddedStringLen(bundle, o + 4);
+    if(tto >= o + 4 + s)
     {
-        float v2 = ose_popFloat(bundle);
-        float v1 = ose_popFloat(bundle);
-        ose_pushFloat(bundle, v1 - v2);
+        return -1;
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
+    const int32_t ntt = strlen(b + tto);
+    int32_t plo = tto + ose_pnbytes(ntt);
+    int32_t i;
+    ++tto;
+    for(i = 0; i < ntt - 1; i++)
     {
-
+        const char tt = b[tto + i];
+        if(n == SORT_FIRSTNUMERIC || i == n)
+        {
+            *t = numIndex(tt);
+            if(*t >= 0)
+            {
+                return plo;
+            }
+            if(i == n)
+            {
+                return -1;
+            }
+        }
+        plo += ose_getTypedDatumSize(tt, b + plo);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
-    {
+    return -1;
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
+static uint64_t sortKey(const int t,
+                        const union numval v,
+                        const bool asdouble)
+{
+    uint64_t u;
+    if(asdouble)
     {
-
+        const union numval d = numConvert(v, t, NUM_DOUBLE);
+        u = d.u64;
+        /* negative numbers have their bits flipped so that they
+           come before the positive ones, in reverse order */
+        return (u & 0x8000000000000000ULL)
+            ? ~u : (u | 0x8000000000000000ULL);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
+    switch(t)
     {
-
+    case NUM_INT8:
+    case NUM_INT32:
+        u = (uint64_t)(int64_t)v.i32;
+        break;
+    case NUM_UINT8:
+    case NUM_UINT32:
+        u = v.u32;
+        break;
+    case NUM_UINT64:
+        u = v.u64 > INT64_MAX ? INT64_MAX : v.u64;
+        break;
+    default:
+        u = (uint64_t)v.i64;
+        break;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
-    {
+    return u ^ 0x8000000000000000ULL;
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
-    {
+/* the start of the index for the bundle at o, which is the last
+   element */
+static struct sortent *sortIndex(ose_bundle bundle, const int32_t o)
+{
+    char * const b = ose_getBundlePtr(bundle);
+    const uintptr_t e = (uintptr_t)(b + o + ose_readInt32(bundle, o) + 4);
+    return (struct sortent *)((e + 7) & ~(uintptr_t)7);
+}
 
+static int32_t sortCount(ose_bundle bundle, const int32_t o)
+{
+    const int32_t s = ose_readInt32(bundle, o);
+    int32_t eo = o + 4 + OSE_BUNDLE_HEADER_LEN;
+    int32_t n = 0;
+    while(eo < o + 4 + s)
+    {
+        ++n;
+        eo += ose_readInt32(bundle, eo) + 4;
     }
-    break;
-#endif
-    }
+    return n;
 }
 
-void ose_mul(ose_bundle bundle)
+/* whether the index, nents entries long, and a copy of the contents
+   of the bundle at o fit in the free space after it */
+static bool sortFits(ose_bundle bundle,
+                     const int32_t o,
+                     const int32_t nents)
 {
-    char t1 = ose_peekMessageArgType(bundle);
-    ose_assert(ose_isNumericType(t1));
-    ose_swap(bundle);
-    char t2 = ose_peekMessageArgType(bundle);(void)t2;
-    ose_assert(ose_isNumericType(t2));
-    ose_assert(t1 == t2);
-    switch(t1)
-    {
-    case OSETT_INT32:
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readInt32(bundle, o);
+    const char * const end = b + ose_readSize(bundle)
+        + ose_spaceAvailable(bundle);
+    return (const char *)(sortIndex(bundle, o) + nents)
+        + (s - OSE_BUNDLE_HEADER_LEN) <= end;
+}
+
+static void sortOffsets(ose_bundle bundle,
+                        const int32_t o,
+                        struct sortent * const ents)
+{
+    const int32_t s = ose_readInt32(bundle, o);
+    int32_t eo = o + 4 + OSE_BUNDLE_HEADER_LEN;
+    int32_t n = 0;
+    while(eo < o + 4 + s)
     {
-        int32_t v2 = ose_popInt32(bundle);
-        int32_t v1 = ose_popInt32(bundle);
-        ose_pushInt32(bundle, v1 * v2);
+        const int32_t es = ose_readInt32(bundle, eo);
+        ents[n].offset = eo;
+        ents[n].size = es;
+        ++n;
+        eo += es + 4;
     }
-    break;
-    case OSETT_FLOAT:
+}
+
+/* whether any of the keys of the elements of the bundle at o is a
+   float or double */
+static bool sortAsDouble(ose_bundle bundle,
+                         const int32_t o,
+                         const int32_t item)
+{
+    const int32_t s = ose_readInt32(bundle, o);
+    int32_t eo = o + 4 + OSE_BUNDLE_HEADER_LEN;
+    while(eo < o + 4 + s)
     {
-        float v2 = ose_popFloat(bundle);
-        float v1 = ose_popFloat(bundle);
-        ose_pushFloat(bundle, v1 * v2);
+        int t;
+        if(sortItem(bundle, eo, item, &t) >= 0 && t >= NUM_FLOAT)
+        {
+            return true;
+        }
+        eo += ose_readInt32(bundle, eo) + 4;
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
-    {
+    return false;
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
+/* fills in the keys of the index. nokey is the key given to
+   elements that don't have one */
+static void sortKeys(ose_bundle bundle,
+                     struct sortent * const ents,
+                     const int32_t n,
+                     const int32_t item,
+                     const bool asdouble,
+                     const uint64_t nokey)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    int32_t i;
+    for(i = 0; i < n; i++)
     {
-
+        int t;
+        const int32_t plo = sortItem(bundle, ents[i].offset, item, &t);
+        ents[i].key = plo < 0
+            ? nokey : sortKey(t, numLoad(t, b + plo), asdouble);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
-    {
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
+/* sorts n entries by key, using tmp, which has room for n more, and
+   returns whichever of the two holds the result */
+static struct sortent *radixSort(struct sortent *ents,
+                                 struct sortent *tmp,
+                                 const int32_t n)
+{
+    int32_t counts[8][256];
+    int32_t i, j;
+    memset(counts, 0, sizeof(counts));
+    for(i = 0; i < n; i++)
     {
-
+        const uint64_t k = ents[i].key;
+        for(j = 0; j < 8; j++)
+        {
+            ++counts[j][(k >> (j * 8)) & 0xff];
+        }
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
+    for(j = 0; j < 8; j++)
     {
-
+        int32_t *c = counts[j];
+        int32_t sum = 0;
+        if(c[(ents[0].key >> (j * 8)) & 0xff] == n)
+        {
+            continue;
+        }
+        for(i = 0; i < 256; i++)
+        {
+            const int32_t cc = c[i];
+            c[i] = sum;
+            sum += cc;
+        }
+        for(i = 0; i < n; i++)
+        {
+            tmp[c[(ents[i].key >> (j * 8)) & 0xff]++] = ents[i];
+        }
+        {
+            struct sortent *t = ents;
+            ents = tmp;
+            tmp = t;
+        }
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
-    {
+    return ents;
+}
 
+/* sorts n entries by the address of the element, using tmp, which
+   has room for n more, and returns whichever of the two holds the
+   result */
+static struct sortent *mergeSort(const char * const b,
+                                 struct sortent *ents,
+                                 struct sortent *tmp,
+                                 const int32_t n)
+{
+    int32_t w;
+    for(w = 1; w < n; w *= 2)
+    {
+        int32_t lo;
+        for(lo = 0; lo < n; lo += 2 * w)
+        {
+            const int32_t mid = lo + w < n ? lo + w : n;
+            const int32_t hi = lo + 2 * w < n ? lo + 2 * w : n;
+            int32_t l = lo, r = mid, k = lo;
+            while(l < mid && r < hi)
+            {
+                if(strcmp(b + ents[r].offset + 4,
+                          b + ents[l].offset + 4) < 0)
+                {
+                    tmp[k++] = ents[r++];
+                }
+                else
+                {
+                    tmp[k++] = ents[l++];
+                }
+            }
+            while(l < mid)
+            {
+                tmp[k++] = ents[l++];
+            }
+            while(r < hi)
+            {
+                tmp[k++] = ents[r++];
+            }
+        }
+        {
+            struct sortent *t = ents;
+            ents = tmp;
+            tmp = t;
+        }
     }
-    break;
-#endif
+    return ents;
+}
+
+/* replaces the contents of the bundle at o, which is the last
+   element, with the n elements in ents, in order. scratch is the
+   end of the free space in use */
+static void sortRewrite(ose_bundle bundle,
+                        const int32_t o,
+                        const struct sortent * const ents,
+                        const int32_t n,
+                        char * const scratch)
+{
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readInt32(bundle, o);
+    char *p = scratch;
+    int32_t i;
+    for(i = 0; i < n; i++)
+    {
+        memcpy(p, b + ents[i].offset, ents[i].size + 4);
+        p += ents[i].size + 4;
     }
+    const int32_t ns = p - scratch;
+    memcpy(b + o + 4 + OSE_BUNDLE_HEADER_LEN, scratch, ns);
+    ose_writeInt32(bundle, o, ns + OSE_BUNDLE_HEADER_LEN);
+    memset(b + o + 4 + OSE_BUNDLE_HEADER_LEN + ns, 0,
+           p - (b + o + 4 + OSE_BUNDLE_HEADER_LEN + ns));
+    ose_addToSize(bundle, (ns + OSE_BUNDLE_HEADER_LEN) - s);
 }
 
-void ose_div(ose_bundle bundle)
+static void sortBundle(ose_bundle bundle,
+                       const int32_t o,
+                       const bool byaddress,
+                       const int32_t item)
 {
-    char t1 = ose_peekMessageArgType(bundle);
-    ose_assert(ose_isNumericType(t1));
-    ose_swap(bundle);
-    char t2 = ose_peekMessageArgType(bundle);(void)t2;
-    ose_assert(ose_isNumericType(t2));
-    ose_assert(t1 == t2);
-    switch(t1){
-    case OSETT_INT32:
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t n = sortCount(bundle, o);
+    if(n < 2)
     {
-        int32_t v2 = ose_popInt32(bundle);
-        int32_t v1 = ose_popInt32(bundle);
-        ose_pushInt32(bundle, v1 / v2);
+        return;
     }
-    break;
-    case OSETT_FLOAT:
+    if(!sortFits(bundle, o, 2 * n))
     {
-        float v2 = ose_popFloat(bundle);
-        float v1 = ose_popFloat(bundle);
-        ose_pushFloat(bundle, v1 / v2);
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
+    struct sortent * const ents = sortIndex(bundle, o);
+    struct sortent *sorted;
+    sortOffsets(bundle, o, ents);
+    if(byaddress)
     {
-
+        sorted = mergeSort(b, ents, ents + n, n);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
+    else
     {
-
+        sortKeys(bundle, ents, n, item,
+                 sortAsDouble(bundle, o, item), SORT_NOKEY);
+        sorted = radixSort(ents, ents + n, n);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
-    {
+    sortRewrite(bundle, o, sorted, n, (char *)(ents + 2 * n));
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
-    {
+void ose_sort(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 1));
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_rassert(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE, 1);
+    sortBundle(bundle, o, false, SORT_FIRSTNUMERIC);
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
-    {
+void ose_sortByAddress(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 1));
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_rassert(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE, 1);
+    sortBundle(bundle, o, true, 0);
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
+void ose_sortByItem(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    const int32_t item = ose_popInt32(bundle);
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_rassert(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE, 1);
+    if(item < 0)
     {
-
-    }
-    break;
-#endif
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
     }
+    sortBundle(bundle, o, false, item);
 }
 
-void ose_mod(ose_bundle bundle)
+/*
+  Top k
+
+  The k strongest elements are kept in a heap whose root is the
+  weakest of them, where an element is stronger than another if its
+  key is larger, or if their keys are the same and it comes first,
+  so that, as with the sorts, ties keep their order. Each element
+  after the first k only has to be compared with the root, so the
+  whole thing is O(n log k), and only the k elements that are kept
+  are sorted, by popping the heap.
+*/
+static bool topKWeaker(const struct sortent * const a,
+                       const struct sortent * const b)
 {
-    int32_t onm1, snm1, on, sn;
-    be2(bundle, &onm1, &snm1, &on, &sn);
-    int32_t nm1to, nm1ntt, nm1lto, nm1po, nm1lpo;
-    int32_t nto, nntt, nlto, npo, nlpo;
-    ose_getNthPayloadItem(bundle, 1, onm1,
-                          &nm1to, &nm1ntt, &nm1lto, &nm1po, &nm1lpo);
-    ose_getNthPayloadItem(bundle, 1, on,
-                          &nto, &nntt, &nlto, &npo, &nlpo);
-    char t2 = ose_readByte(bundle, nm1lto);(void)t2;
-    ose_assert(ose_isNumericType(t2));
-    char t1 = ose_readByte(bundle, nlto);
-    ose_assert(ose_isNumericType(t1));
-    ose_assert(t1 == t2);
-    char *b = ose_getBundlePtr(bundle);
-    switch(t1)
-    {
-    case OSETT_INT32:
-    {
-        int32_t v2 = ose_readInt32(bundle, nm1lpo);
-        int32_t v1 = ose_readInt32(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushInt32(bundle, v1 % v2);
-    }
-    break;
-    case OSETT_FLOAT:
-    {
+    return a->key < b->key
+        || (a->key == b->key && a->offset > b->offset);
+}
 
-    }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
+static void topKSiftDown(struct sortent * const h,
+                         const int32_t n,
+                         int32_t i)
+{
+    for(;;)
     {
-
+        const int32_t l = 2 * i + 1;
+        const int32_t r = l + 1;
+        int32_t m = i;
+        if(l < n && topKWeaker(h + l, h + m))
+        {
+            m = l;
+        }
+        if(r < n && topKWeaker(h + r, h + m))
+        {
+            m = r;
+        }
+        if(m == i)
+        {
+            return;
+        }
+        {
+            const struct sortent t = h[i];
+            h[i] = h[m];
+            h[m] = t;
+        }
+        i = m;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
-    {
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
+void ose_topK(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
+    int32_t k = ose_popInt32(bundle);
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_rassert(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE, 1);
+    if(k < 0)
     {
-
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
+    const int32_t s = ose_readInt32(bundle, o);
+    const int32_t nelems = sortCount(bundle, o);
+    if(k > nelems)
     {
-
+        k = nelems;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
+    if(!sortFits(bundle, o, k + 1))
     {
-
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
-    {
-
+    struct sortent * const heap = sortIndex(bundle, o);
+    const bool asdouble = sortAsDouble(bundle, o, SORT_FIRSTNUMERIC);
+    /* each element is indexed in the slot after the heap, and then
+       either added to it, if it isn't full, or swapped with the
+       root, if it's stronger */
+    struct sortent * const ent = heap + k;
+    int32_t n = 0;
+    int32_t eo = o + 4 + OSE_BUNDLE_HEADER_LEN;
+    while(eo < o + 4 + s)
+    {
+        ent->offset = eo;
+        ent->size = ose_readInt32(bundle, eo);
+        eo += ent->size + 4;
+        sortKeys(bundle, ent, 1, SORT_FIRSTNUMERIC, asdouble, 0);
+        if(n < k)
+        {
+            /* sift up */
+            int32_t i = n++;
+            heap[i] = *ent;
+            while(i > 0 && topKWeaker(heap + i, heap + (i - 1) / 2))
+            {
+                const struct sortent t = heap[i];
+                heap[i] = heap[(i - 1) / 2];
+                heap[(i - 1) / 2] = t;
+                i = (i - 1) / 2;
+            }
+        }
+        else if(k > 0 && topKWeaker(heap, ent))
+        {
+            heap[0] = *ent;
+            topKSiftDown(heap, k, 0);
+        }
     }
-    break;
-#endif
+    /* popping the root into the slot at the end of the heap each
+       time leaves the strongest first */
+    {
+        int32_t i;
+        for(i = n - 1; i > 0; i--)
+        {
+            const struct sortent t = heap[0];
+            heap[0] = heap[i];
+            heap[i] = t;
+            topKSiftDown(heap, i, 0);
+        }
     }
+    sortRewrite(bundle, o, heap, n, (char *)(heap + k + 1));
 }
 
-void ose_pow(ose_bundle bundle)
+/**************************************************
+ * dictionaries
+ **************************************************/
+
+/*
+  A dictionary is a bundle whose first element is an index message,
+  followed by the entries, which are messages whose addresses are
+  their keys. The index message has the address
+  OSE_DICT_INDEX_ADDRESS, the number of entries as an int32, and a
+  blob holding an open addressed hash table with linear probing,
+  each slot of which is either 0, or the offset of an entry from
+  the start of the dictionary. The number of slots is a power of
+  two, and is doubled when the table becomes half full. Deleting
+  an entry moves the entries that follow it in its run back, so
+  there are no tombstones.
+
+  The index message always has the same layout, so its parts are
+  at fixed offsets from the start of the dictionary.
+*/
+#define DICT_INDEX (4 + OSE_BUNDLE_HEADER_LEN)
+#define DICT_COUNT (DICT_INDEX + 4 + OSE_DICT_INDEX_ADDRESS_SIZE + 4)
+#define DICT_NBYTES (DICT_COUNT + 4)
+#define DICT_SLOTS (DICT_NBYTES + 4)
+#define DICT_MINSLOTS 16
+
+static uint32_t dictHash(const char *s)
 {
-    char t1 = ose_peekMessageArgType(bundle);
-    ose_assert(ose_isNumericType(t1));
-    ose_swap(bundle);
-    char t2 = ose_peekMessageArgType(bundle);(void)t2;
-    ose_assert(ose_isNumericType(t2));
-    ose_assert(t1 == t2);
-    switch(t1)
-    {
-    case OSETT_INT32:
-    {
-        int32_t v2 = ose_popInt32(bundle);
-        int32_t v1 = ose_popInt32(bundle);
-        ose_pushInt32(bundle, (int32_t)pow(v1, v2));
-    }
-    break;
-    case OSETT_FLOAT:
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)s;
+    while(*p)
     {
-        float v2 = ose_popFloat(bundle);
-        float v1 = ose_popFloat(bundle);
-        ose_pushFloat(bundle, powf(v1, v2));
+        h ^= *p++;
+        h *= 16777619u;
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
-    {
+    return h;
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
-    {
+static bool isDict(ose_constbundle bundle, const int32_t o)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    return ose_readInt32(bundle, o) >= DICT_SLOTS - 4
+        && !strcmp(b + o + DICT_INDEX + 4, OSE_DICT_INDEX_ADDRESS)
+        && !strcmp(b + o + DICT_COUNT - 4, ",ib");
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
-    {
+static int32_t dictNSlots(ose_constbundle bundle, const int32_t o)
+{
+    return ose_readInt32(bundle, o + DICT_NBYTES) / 4;
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
-    {
+static int32_t dictSlot(ose_constbundle bundle,
+                        const int32_t o,
+                        const int32_t i)
+{
+    return ose_readInt32(bundle, o + DICT_SLOTS + i * 4);
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
-    {
+static void dictSetSlot(ose_bundle bundle,
+                        const int32_t o,
+                        const int32_t i,
+                        const int32_t r)
+{
+    ose_writeInt32(bundle, o + DICT_SLOTS + i * 4, r);
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
+/* returns the offset of the entry for key, or 0 if there isn't
+   one, and the slot it's in, or should go in */
+static int32_t dictFind(ose_constbundle bundle,
+                        const int32_t o,
+                        const char * const key,
+                        int32_t *slot)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t mask = dictNSlots(bundle, o) - 1;
+    int32_t i = dictHash(key) & mask;
+    for(;;)
     {
-
-    }
-    break;
-#endif
+        const int32_t r = dictSlot(bundle, o, i);
+        if(!r || !strcmp(b + o + r + 4, key))
+        {
+            *slot = i;
+            return r;
+        }
+        i = (i + 1) & mask;
     }
 }
 
-void ose_neg(ose_bundle bundle)
+static void dictAddToCount(ose_bundle bundle,
+                           const int32_t o,
+                           const int32_t amt)
 {
-    char t1 = ose_peekMessageArgType(bundle);
-    ose_assert(ose_isNumericType(t1));
-    switch(t1)
-    {
-    case OSETT_INT32:
+    ose_writeInt32(bundle, o + DICT_COUNT,
+                   ose_readInt32(bundle, o + DICT_COUNT) + amt);
+}
+
+/* index every entry of the dictionary at o. If there's more than
+   one entry with the same key, the first is the one that's
+   indexed */
+static void dictRebuild(ose_bundle bundle, const int32_t o)
+{
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readInt32(bundle, o);
+    const int32_t nslots = dictNSlots(bundle, o);
+    int32_t r = DICT_SLOTS + nslots * 4;
+    int32_t n = 0;
+    memset(b + o + DICT_SLOTS, 0, nslots * 4);
+    while(r < s + 4)
     {
-        int32_t v1 = ose_popInt32(bundle);
-        ose_pushInt32(bundle, -v1);
-    }
-    break;
-    case OSETT_FLOAT:
+        int32_t slot;
+        if(!dictFind(bundle, o, b + o + r + 4, &slot))
+        {
+            dictSetSlot(bundle, o, slot, r);
+            ++n;
+        }
+        r += ose_readInt32(bundle, o + r) + 4;
+    }
+    ose_writeInt32(bundle, o + DICT_COUNT, n);
+}
+
+/* grows the table of the dictionary at o, which may be anywhere on
+   the stack, to nslots slots, moving everything after it up */
+static void dictGrow(ose_bundle bundle,
+                     const int32_t o,
+                     const int32_t nslots)
+{
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t oldnbytes = ose_readInt32(bundle, o + DICT_NBYTES);
+    const int32_t amt = nslots * 4 - oldnbytes;
+    const int32_t e = o + DICT_SLOTS + oldnbytes;
+    const int32_t end = ose_readSize(bundle);
+    ose_assert(ose_spaceAvailable(bundle) >= amt);
+    memmove(b + e + amt, b + e, end - e);
+    memset(b + e, 0, amt);
+    ose_writeInt32(bundle, o, ose_readInt32(bundle, o) + amt);
+    ose_addToSize(bundle, amt);
+    ose_writeInt32(bundle, o + DICT_INDEX,
+                   ose_readInt32(bundle, o + DICT_INDEX) + amt);
+    ose_writeInt32(bundle, o + DICT_NBYTES, nslots * 4);
+    dictRebuild(bundle, o);
+}
+
+/* adds amt to the offsets of the entries after r, after the entry
+   at r has changed size */
+static void dictShift(ose_bundle bundle,
+                      const int32_t o,
+                      const int32_t r,
+                      const int32_t amt)
+{
+    const int32_t nslots = dictNSlots(bundle, o);
+    int32_t i;
+    for(i = 0; i < nslots; i++)
     {
-        float v1 = ose_popFloat(bundle);
-        ose_pushFloat(bundle, -v1);
+        const int32_t rr = dictSlot(bundle, o, i);
+        if(rr > r)
+        {
+            dictSetSlot(bundle, o, i, rr + amt);
+        }
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
-    {
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
+/* empties the slot, moving back any entries after it in its run
+   that would no longer be found */
+static void dictClearSlot(ose_bundle bundle,
+                          const int32_t o,
+                          int32_t i)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t mask = dictNSlots(bundle, o) - 1;
+    int32_t j = i;
+    for(;;)
     {
-
+        j = (j + 1) & mask;
+        const int32_t r = dictSlot(bundle, o, j);
+        if(!r)
+        {
+            break;
+        }
+        /* the entry in j can move to i unless its home slot is
+           cyclically in (i, j] */
+        const int32_t k = dictHash(b + o + r + 4) & mask;
+        if(i <= j ? (k <= i || k > j) : (k <= i && k > j))
+        {
+            dictSetSlot(bundle, o, i, r);
+            i = j;
+        }
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
-    {
+    dictSetSlot(bundle, o, i, 0);
+    dictAddToCount(bundle, o, -1);
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
+void ose_toDict(ose_bundle bundle)
+{
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 1));
+    const int32_t o = ose_getLastBundleElemOffset(bundle);
+    ose_rassert(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE, 1);
+    if(isDict(bundle, o))
     {
-
+        dictRebuild(bundle, o);
+        return;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t s = ose_readInt32(bundle, o);
+    int32_t n = 0, r = DICT_INDEX;
+    while(r < s + 4)
     {
-
+        ++n;
+        r += ose_readInt32(bundle, o + r) + 4;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
+    int32_t nslots = DICT_MINSLOTS;
+    while(nslots < n * 2)
     {
-
-    }
-    break;
-#endif
+        nslots *= 2;
     }
+    const int32_t amt = DICT_SLOTS - DICT_INDEX + nslots * 4;
+    ose_assert(ose_spaceAvailable(bundle) >= amt);
+    memmove(b + o + DICT_INDEX + amt, b + o + DICT_INDEX,
+            s + 4 - DICT_INDEX);
+    memset(b + o + DICT_INDEX, 0, amt);
+    ose_writeInt32(bundle, o, s + amt);
+    ose_addToSize(bundle, amt);
+    ose_writeInt32(bundle, o + DICT_INDEX, amt - 4);
+    memcpy(b + o + DICT_INDEX + 4, OSE_DICT_INDEX_ADDRESS,
+           OSE_DICT_INDEX_ADDRESS_LEN);
+    memcpy(b + o + DICT_COUNT - 4, ",ib", 3);
+    ose_writeInt32(bundle, o + DICT_NBYTES, nslots * 4);
+    dictRebuild(bundle, o);
 }
 
-void ose_eql(ose_bundle bundle)
+void ose_dictGet(ose_bundle bundle)
 {
-    int32_t onm1, on, snm1, sn;
+    ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    int32_t on, sn, onm1, snm1;
     be2(bundle, &onm1, &snm1, &on, &sn);
-    int32_t tonm1 = onm1 + 4 + ose_getPaddedStringLen(bundle, onm1 + 4);
-    int32_t ton = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
-    char *b = ose_getBundlePtr(bundle);
-    int32_t lnm1 = snm1 - (tonm1 - (onm1 + 4));
-    int32_t ln = sn - (ton - (on + 4));
-    if(lnm1 != ln)
-    {
-        ose_2drop(bundle);
-        ose_pushInt32(bundle, 0);
-        return;
-    }
-    if(!memcmp(b + tonm1, b + ton, ln))
-    {
-        ose_pushInt32(bundle, 1);
-    }
-    else
+    ose_rassert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE, 1);
+    if(!isDict(bundle, onm1))
     {
-        ose_pushInt32(bundle, 0);
+        ose_lookup(bundle);
+        return;
+    }
+
+    int32_t to, ntt, lto, po, lpo;
+    ose_getNthPayloadItem(bundle, 1, on, &to, &ntt, &lto, &po, &lpo);
+    ose_rassert(ose_isStringType(ose_readByte(bundle, lto)), 1);
+
+    char *b = ose_getBundlePtr(bundle);
+    int32_t slot;
+    const int32_t r = dictFind(bundle, onm1, b + lpo, &slot);
+    if(r)
+    {
+        const int32_t ss = ose_readInt32(bundle, onm1 + r);
+        memset(b + on, 0, sn + 4);
+        ose_addToSize(bundle, ss - sn);
+        memcpy(b + on, b + onm1 + r, ss + 4);
+        return;
     }
-    ose_swap(bundle);
-    ose_drop(bundle);
-    ose_swap(bundle);
     ose_drop(bundle);
+    ose_pushMessage(bundle, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_LEN, 0);
 }
 
-void ose_neq(ose_bundle bundle)
+void ose_dictPut(ose_bundle bundle)
 {
-    int32_t onm1, on, snm1, sn;
-    be2(bundle, &onm1, &snm1, &on, &sn);
-    int32_t tonm1 = onm1 + 4 + ose_getPaddedStringLen(bundle, onm1 + 4);
-    int32_t ton = on + 4 + ose_getPaddedStringLen(bundle, on + 4);
-    char *b = ose_getBundlePtr(bundle);
-    int32_t lnm1 = snm1 - (tonm1 - (onm1 + 4));
-    int32_t ln = sn - (ton - (on + 4));
-    if(lnm1 != ln)
+    ose_rassert(ose_bundleHasAtLeastNElems(bundle, 3), 1);
+    int32_t on, sn, onm1, snm1, onm2, snm2;
+    be3(bundle, &onm2, &snm2, &onm1, &snm1, &on, &sn);
+    ose_rassert(ose_getBundleElemType(bundle, onm2) == OSETT_BUNDLE, 1);
+    if(!isDict(bundle, onm2))
     {
-        ose_2drop(bundle);
-        ose_pushInt32(bundle, 0);
+        ose_assign(bundle);
         return;
     }
-    if(!memcmp(b + tonm1, b + ton, ln))
     {
-        ose_pushInt32(bundle, 0);
+        const int32_t nslots = dictNSlots(bundle, onm2);
+        if((ose_readInt32(bundle, onm2 + DICT_COUNT) + 1) * 2 > nslots)
+        {
+            dictGrow(bundle, onm2, nslots * 2);
+        }
+    }
+    const int32_t s = assignMessage(bundle, &onm2, &onm1);
+    char *b = ose_getBundlePtr(bundle);
+    int32_t slot;
+    const int32_t r = dictFind(bundle, onm2, b + onm1 + 4, &slot);
+    if(r)
+    {
+        const int32_t ss = ose_readInt32(bundle, onm2 + r);
+        replaceAt(bundle, onm2, onm2 + r, ss, onm1, s);
+        dictShift(bundle, onm2, r, s - ss);
     }
     else
     {
-        ose_pushInt32(bundle, 1);
+        /* the entry stays where it is when it's pushed */
+        dictSetSlot(bundle, onm2, slot, onm1 - onm2);
+        dictAddToCount(bundle, onm2, 1);
+        ose_push(bundle);
     }
-    ose_swap(bundle);
-    ose_drop(bundle);
-    ose_swap(bundle);
-    ose_drop(bundle);
 }
 
-void ose_lte(ose_bundle bundle)
+void ose_dictDelete(ose_bundle bundle)
 {
-    int32_t onm1, snm1, on, sn;
+    ose_rassert(ose_bundleHasAtLeastNElems(bundle, 2), 1);
+    int32_t on, sn, onm1, snm1;
     be2(bundle, &onm1, &snm1, &on, &sn);
-    int32_t nm1to, nm1ntt, nm1lto, nm1po, nm1lpo;
-    int32_t nto, nntt, nlto, npo, nlpo;
-    ose_getNthPayloadItem(bundle, 1, onm1,
-                          &nm1to, &nm1ntt, &nm1lto, &nm1po, &nm1lpo);
-    ose_getNthPayloadItem(bundle, 1, on,
-                          &nto, &nntt, &nlto, &npo, &nlpo);
-    char t2 = ose_readByte(bundle, nm1lto); (void)t2;
-    ose_assert(ose_isNumericType(t2));
-    char t1 = ose_readByte(bundle, nlto);
-    ose_assert(ose_isNumericType(t1));
-    ose_assert(t1 == t2);
+    ose_rassert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE, 1);
+
+    int32_t to, ntt, lto, po, lpo;
+    ose_getNthPayloadItem(bundle, 1, on, &to, &ntt, &lto, &po, &lpo);
+    ose_rassert(ose_isStringType(ose_readByte(bundle, lto)), 1);
+
     char *b = ose_getBundlePtr(bundle);
-    switch(t1)
-    {
-    case OSETT_INT32:
+    const bool dict = isDict(bundle, onm1);
+    int32_t r = 0;
+    if(dict)
     {
-        int32_t v2 = ose_readInt32(bundle, nm1lpo);
-        int32_t v1 = ose_readInt32(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushInt32(bundle, v1 <= v2);
+        int32_t slot;
+        r = dictFind(bundle, onm1, b + lpo, &slot);
+        if(r)
+        {
+            dictClearSlot(bundle, onm1, slot);
+        }
     }
-    break;
-    case OSETT_FLOAT:
+    else
     {
-        float v2 = ose_readFloat(bundle, nm1lpo);
-        float v1 = ose_readFloat(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushInt32(bundle, v1 <= v2);
+        int32_t rr = 4 + OSE_BUNDLE_HEADER_LEN;
+        while(rr < snm1 + 4)
+        {
+            if(!strcmp(b + onm1 + rr + 4, b + lpo))
+            {
+                r = rr;
+                break;
+            }
+            rr += ose_readInt32(bundle, onm1 + rr) + 4;
+        }
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
+    ose_drop(bundle);
+    if(!r)
     {
-
+        return;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
+    const int32_t ss = ose_readInt32(bundle, onm1 + r) + 4;
+    const int32_t end = ose_readSize(bundle);
+    memmove(b + onm1 + r, b + onm1 + r + ss, end - (onm1 + r + ss));
+    memset(b + end - ss, 0, ss);
+    ose_writeInt32(bundle, onm1, snm1 - ss);
+    ose_addToSize(bundle, -ss);
+    if(dict)
     {
-
+        dictShift(bundle, onm1, r, -ss);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
-    {
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
-    {
+/**************************************************
+ * diff and patch
+ **************************************************/
 
+/*
+  A patch is a bundle of operations that turn one bundle into
+  another, applied in order with a cursor that starts at the first
+  element of the bundle being patched:
+
+  /skip ,i n     the cursor moves past n elements
+  /delete ,i n   the n elements at the cursor are removed
+  /insert ,      the element that follows in the patch is inserted
+                 at the cursor, which moves past it
+  /replace ,     the element at the cursor is replaced with the
+                 element that follows in the patch, and the cursor
+                 moves past it
+
+  The elements of the two bundles are aligned by address, which is
+  looked up in a hash table of the addresses of the old bundle.
+  Each element of the new bundle is paired with the first unused
+  element of the old bundle with the same address, or with a later
+  one if that one is the same as it, and the longest run of pairs
+  that are in the same order in both bundles is kept. Old elements
+  that aren't kept are deleted, and new ones are inserted, so that
+  applying the patch gives back the new bundle byte for byte. A
+  kept pair whose elements are the same costs nothing, and any
+  other is replaced.
+*/
+static const char PATCH_SKIP[] = "/skip";
+static const char PATCH_DELETE[] = "/delete";
+static const char PATCH_INSERT[] = "/insert";
+static const char PATCH_REPLACE[] = "/replace";
+
+struct diffent
+{
+    int32_t offset;
+    int32_t next;
+    uint32_t hash;
+    int32_t used;
+};
+
+struct diffnew
+{
+    int32_t pair;
+    int32_t prev;
+};
+
+#define DIFF_KEPT -2
+
+/* writes an operation into the free space at o, and returns the
+   offset after it. n is the count, or -1 if it doesn't have one */
+static int32_t diffWriteOp(char * const b,
+                           int32_t o,
+                           const char * const op,
+                           const int32_t n)
+{
+    const int32_t as = ose_pnbytes(strlen(op));
+    const int32_t s = as + 4 + (n < 0 ? 0 : 4);
+    *((int32_t *)(b + o)) = ose_htonl(s);
+    o += 4;
+    memcpy(b + o, op, strlen(op));
+    o += as;
+    b[o] = OSETT_ID;
+    if(n >= 0)
+    {
+        b[o + 1] = OSETT_INT32;
+        *((int32_t *)(b + o + 4)) = ose_htonl(n);
+        o += 4;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
-    {
+    return o + 4;
+}
 
-    }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
-    {
+/* runs of skips and deletes are counted, and only written out when
+   something else comes along */
+struct diffrun
+{
+    const char *op;
+    int32_t n;
+};
 
+static int32_t diffFlush(char * const b, int32_t o, struct diffrun *r)
+{
+    if(r->n)
+    {
+        o = diffWriteOp(b, o, r->op, r->n);
+        r->n = 0;
     }
-    break;
-#endif
+    return o;
+}
+
+static int32_t diffRun(char * const b,
+                       int32_t o,
+                       struct diffrun *r,
+                       const char * const op,
+                       const int32_t n)
+{
+    if(r->op != op)
+    {
+        o = diffFlush(b, o, r);
+        r->op = op;
     }
+    r->n += n;
+    return o;
 }
 
-void ose_lt(ose_bundle bundle)
+void ose_diff(ose_bundle bundle)
 {
+    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
     int32_t onm1, snm1, on, sn;
     be2(bundle, &onm1, &snm1, &on, &sn);
-    int32_t nm1to, nm1ntt, nm1lto, nm1po, nm1lpo;
-    int32_t nto, nntt, nlto, npo, nlpo;
-    ose_getNthPayloadItem(bundle, 1, onm1,
-                          &nm1to, &nm1ntt, &nm1lto, &nm1po, &nm1lpo);
-    ose_getNthPayloadItem(bundle, 1, on,
-                          &nto, &nntt, &nlto, &npo, &nlpo);
-    char t2 = ose_readByte(bundle, nm1lto); (void)t2;
-    ose_assert(ose_isNumericType(t2));
-    char t1 = ose_readByte(bundle, nlto);
-    ose_assert(ose_isNumericType(t1));
-    ose_assert(t1 == t2);
-    char *b = ose_getBundlePtr(bundle);
-    switch(t1)
+    ose_rassert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE, 1);
+    ose_rassert(ose_getBundleElemType(bundle, on) == OSETT_BUNDLE, 1);
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t end = on + sn + 4;
+    int32_t nold = 0, nnew = 0, nslots = 1;
+    int32_t i, j, o;
+    for(o = onm1 + 4 + OSE_BUNDLE_HEADER_LEN;
+        o < on;
+        o += ose_readInt32(bundle, o) + 4)
+    {
+        ++nold;
+    }
+    for(o = on + 4 + OSE_BUNDLE_HEADER_LEN;
+        o < end;
+        o += ose_readInt32(bundle, o) + 4)
+    {
+        ++nnew;
+    }
+    while(nslots < nold * 2)
+    {
+        nslots *= 2;
+    }
+    /* the indexes of the two bundles and the hash table go after the
+       new one, and the patch after them */
+    const int32_t io = end + 4;
+    const int32_t no = io + nold * (int32_t)sizeof(struct diffent);
+    const int32_t tails = no + nnew * (int32_t)sizeof(struct diffnew);
+    const int32_t heads = tails + nnew * 4;
+    const int32_t po = heads + nslots * 4;
+    if(ose_spaceAvailable(bundle) - (po - end)
+       < 4 + OSE_BUNDLE_HEADER_LEN + sn + 20 * (nnew + nold + 1))
+    {
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+    struct diffent * const ents = (struct diffent *)(b + io);
+    struct diffnew * const news = (struct diffnew *)(b + no);
+    int32_t * const tail = (int32_t *)(b + tails);
+    int32_t * const table = (int32_t *)(b + heads);
+    memset(table, 0xff, nslots * 4);
+    i = 0;
+    for(o = onm1 + 4 + OSE_BUNDLE_HEADER_LEN;
+        o < on;
+        o += ose_readInt32(bundle, o) + 4)
+    {
+        ents[i].offset = o;
+        ents[i].hash = dictHash(b + o + 4);
+        ents[i].used = false;
+        ++i;
+    }
+    /* chains are built from the back, so that each one is in the
+       order of the bundle */
+    for(i = nold - 1; i >= 0; i--)
+    {
+        int32_t * const h = table + (ents[i].hash & (nslots - 1));
+        ents[i].next = *h;
+        *h = i;
+    }
+
+    /* each new element is paired with the first unused old element
+       with the same address, or a later one that is the same as it */
+    j = 0;
+    for(o = on + 4 + OSE_BUNDLE_HEADER_LEN;
+        o < end;
+        o += ose_readInt32(bundle, o) + 4)
+    {
+        const char * const addr = b + o + 4;
+        const uint32_t hash = dictHash(addr);
+        const int32_t s = ose_readInt32(bundle, o);
+        int32_t m = -1, mm;
+        for(mm = table[hash & (nslots - 1)]; mm >= 0; mm = ents[mm].next)
+        {
+            const int32_t mo = ents[mm].offset;
+            if(ents[mm].used || ents[mm].hash != hash
+               || strcmp(b + mo + 4, addr))
+            {
+                continue;
+            }
+            if(m < 0)
+            {
+                m = mm;
+            }
+            if(ose_readInt32(bundle, mo) == s
+               && !memcmp(b + mo, b + o, s + 4))
+            {
+                m = mm;
+                break;
+            }
+        }
+        if(m >= 0)
+        {
+            ents[m].used = true;
+        }
+        news[j].pair = m;
+        news[j].prev = -1;
+        ++j;
+    }
+
+    /* the pairs that are kept are the longest run of them that are
+       in the same order in both bundles, found by patience sorting.
+       Those in the run are marked by setting prev to DIFF_KEPT */
     {
-    case OSETT_INT32:
+        int32_t len = 0;
+        for(j = 0; j < nnew; j++)
+        {
+            const int32_t m = news[j].pair;
+            int32_t lo = 0, hi = len;
+            if(m < 0)
+            {
+                continue;
+            }
+            while(lo < hi)
+            {
+                const int32_t mid = (lo + hi) / 2;
+                if(news[tail[mid]].pair < m)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            news[j].prev = lo ? tail[lo - 1] : -1;
+            tail[lo] = j;
+            if(lo == len)
+            {
+                ++len;
+            }
+        }
+        j = len ? tail[len - 1] : -1;
+        while(j >= 0)
+        {
+            const int32_t p = news[j].prev;
+            news[j].prev = DIFF_KEPT;
+            j = p;
+        }
+    }
+
+    int32_t w = po + 4;
+    int32_t last = -1;
+    struct diffrun r = {PATCH_SKIP, 0};
+    memcpy(b + w, OSE_BUNDLE_HEADER, OSE_BUNDLE_HEADER_LEN);
+    w += OSE_BUNDLE_HEADER_LEN;
+    j = 0;
+    for(o = on + 4 + OSE_BUNDLE_HEADER_LEN;
+        o < end;
+        o += ose_readInt32(bundle, o) + 4, j++)
     {
-        int32_t v2 = ose_readInt32(bundle, nm1lpo);
-        int32_t v1 = ose_readInt32(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushInt32(bundle, v1 < v2);
+        const int32_t s = ose_readInt32(bundle, o);
+        if(news[j].prev == DIFF_KEPT)
+        {
+            const int32_t m = news[j].pair;
+            const int32_t mo = ents[m].offset;
+            /* the old elements that were passed over go */
+            if(m > last + 1)
+            {
+                w = diffRun(b, w, &r, PATCH_DELETE, m - (last + 1));
+            }
+            last = m;
+            if(ose_readInt32(bundle, mo) == s
+               && !memcmp(b + mo, b + o, s + 4))
+            {
+                w = diffRun(b, w, &r, PATCH_SKIP, 1);
+                continue;
+            }
+            w = diffFlush(b, w, &r);
+            w = diffWriteOp(b, w, PATCH_REPLACE, -1);
+        }
+        else
+        {
+            w = diffFlush(b, w, &r);
+            w = diffWriteOp(b, w, PATCH_INSERT, -1);
+        }
+        memcpy(b + w, b + o, s + 4);
+        w += s + 4;
     }
-    break;
-    case OSETT_FLOAT:
+    if(last + 1 < nold)
     {
-        float v2 = ose_readFloat(bundle, nm1lpo);
-        float v1 = ose_readFloat(bundle, nlpo);
-        memset(b + onm1, 0, snm1 + sn + 8);
-        ose_decSize(bundle, snm1 + sn + 8);
-        ose_pushInt32(bundle, v1 < v2);
+        w = diffRun(b, w, &r, PATCH_DELETE, nold - (last + 1));
     }
-    break;
-#ifdef OSE_PROVIDE_TYPE_DOUBLE
-    case OSETT_DOUBLE:
+    if(r.op == PATCH_DELETE)
     {
-
+        w = diffFlush(b, w, &r);
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT8
-    case OSETT_INT8:
+    *((int32_t *)(b + po)) = ose_htonl(w - (po + 4));
+
+    /* the new bundle goes where the old one was, followed by the
+       patch */
+    memmove(b + onm1, b + on, sn + 4);
+    memmove(b + onm1 + sn + 4, b + po, w - po);
+    memset(b + onm1 + sn + 4 + (w - po), 0,
+           w - (onm1 + sn + 4 + (w - po)));
+    ose_addToSize(bundle, (onm1 + sn + 4 + (w - po)) - end);
+}
+
+/* the offset of the element n elements after the one at o, or -1 if
+   the bundle ends first */
+static int32_t patchAdvance(ose_constbundle bundle,
+                            int32_t o,
+                            const int32_t end,
+                            int32_t n)
+{
+    while(n-- > 0)
     {
+        if(o >= end)
+        {
+            return -1;
+        }
+        o += ose_readInt32(bundle, o) + 4;
+    }
+    return o;
+}
 
+/* the count of a skip or delete, or -1 for an insert or replace,
+   which is followed by an element */
+static int32_t patchOp(ose_constbundle bundle,
+                       const int32_t o,
+                       const char **op)
+{
+    const char * const b = ose_getBundlePtr(bundle);
+    const char * const a = b + o + 4;
+    const int32_t tto = o + 4 + ose_pstrlen(a);
+    if(!strcmp(a, PATCH_SKIP))
+    {
+        *op = PATCH_SKIP;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT8
-    case OSETT_UINT8:
+    else if(!strcmp(a, PATCH_DELETE))
     {
-
+        *op = PATCH_DELETE;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT32
-    case OSETT_UINT32:
+    else if(!strcmp(a, PATCH_INSERT))
     {
-
+        *op = PATCH_INSERT;
+        return -1;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_INT64
-    case OSETT_INT64:
+    else if(!strcmp(a, PATCH_REPLACE))
     {
-
+        *op = PATCH_REPLACE;
+        return -1;
     }
-    break;
-#endif
-#ifdef OSE_PROVIDE_TYPE_UINT64
-    case OSETT_UINT64:
+    else
     {
-
+        *op = NULL;
+        return -1;
     }
-    break;
-#endif
+    if(strcmp(b + tto, ",i"))
+    {
+        *op = NULL;
+        return -1;
     }
+    return ose_readInt32(bundle, tto + 4);
 }
 
-void ose_and(ose_bundle bundle)
+/* moves everything from o to the end of the stack by amt bytes,
+   and adds amt to the size of the bundle at bo */
+static void patchShift(ose_bundle bundle,
+                       const int32_t bo,
+                       const int32_t o,
+                       const int32_t amt)
 {
-    ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
-    int32_t i1 = ose_popInt32(bundle);
-    int32_t i2 = ose_popInt32(bundle);
-    ose_pushInt32(bundle, i1 && i2);
+    char * const b = ose_getBundlePtr(bundle);
+    const int32_t end = ose_readSize(bundle);
+    if(!amt)
+    {
+        return;
+    }
+    memmove(b + o + amt, b + o, end - o);
+    if(amt < 0)
+    {
+        memset(b + end + amt, 0, -amt);
+    }
+    ose_writeInt32(bundle, bo, ose_readInt32(bundle, bo) + amt);
+    ose_addToSize(bundle, amt);
 }
 
-void ose_or(ose_bundle bundle)
+void ose_patch(ose_bundle bundle)
 {
     ose_assert(ose_bundleHasAtLeastNElems(bundle, 2));
-    int32_t i1 = ose_popInt32(bundle);
-    int32_t i2 = ose_popInt32(bundle);
-    ose_pushInt32(bundle, i1 || i2);
+    int32_t onm1, snm1, on, sn;
+    be2(bundle, &onm1, &snm1, &on, &sn);
+    ose_rassert(ose_getBundleElemType(bundle, onm1) == OSETT_BUNDLE, 1);
+    ose_rassert(ose_getBundleElemType(bundle, on) == OSETT_BUNDLE, 1);
+    char * const b = ose_getBundlePtr(bundle);
+    const char *op;
+    int32_t n, o, c, grow = 0, peak = 0;
+
+    /* check that the patch fits the bundle before touching it */
+    bool ok = true;
+    c = onm1 + 4 + OSE_BUNDLE_HEADER_LEN;
+    o = on + 4 + OSE_BUNDLE_HEADER_LEN;
+    while(ok && o < on + sn + 4)
+    {
+        n = patchOp(bundle, o, &op);
+        o += ose_readInt32(bundle, o) + 4;
+        if(!op)
+        {
+            ok = false;
+        }
+        else if(op == PATCH_SKIP || op == PATCH_DELETE)
+        {
+            c = patchAdvance(bundle, c, on, n);
+            ok = n >= 0 && c >= 0;
+        }
+        else if(o >= on + sn + 4)
+        {
+            ok = false;
+        }
+        else
+        {
+            const int32_t s = ose_readInt32(bundle, o);
+            if(op == PATCH_INSERT)
+            {
+                grow += s + 4;
+            }
+            else if(c < on)
+            {
+                grow += s - ose_readInt32(bundle, c);
+                c += ose_readInt32(bundle, c) + 4;
+            }
+            else
+            {
+                ok = false;
+            }
+            o += s + 4;
+            if(grow > peak)
+            {
+                peak = grow;
+            }
+        }
+    }
+    if(!ok || peak > ose_spaceAvailable(bundle))
+    {
+        ose_errno_set(bundle, OSE_ERR_RANGE);
+        return;
+    }
+
+    /* the patch moves up and down with the end of the bundle, so its
+       elements are found relative to it */
+    c = onm1 + 4 + OSE_BUNDLE_HEADER_LEN;
+    o = 4 + OSE_BUNDLE_HEADER_LEN;
+    while(o < sn + 4)
+    {
+        const int32_t po = onm1 + ose_readInt32(bundle, onm1) + 4;
+        n = patchOp(bundle, po + o, &op);
+        o += ose_readInt32(bundle, po + o) + 4;
+        if(op == PATCH_SKIP)
+        {
+            c = patchAdvance(bundle, c, po, n);
+        }
+        else if(op == PATCH_DELETE)
+        {
+            const int32_t e = patchAdvance(bundle, c, po, n);
+            patchShift(bundle, onm1, e, c - e);
+        }
+        else
+        {
+            const int32_t s = ose_readInt32(bundle, po + o) + 4;
+            int32_t amt = s;
+            if(op == PATCH_REPLACE)
+            {
+                amt -= ose_readInt32(bundle, c) + 4;
+                patchShift(bundle, onm1,
+                           c + ose_readInt32(bundle, c) + 4, amt);
+            }
+            else
+            {
+                patchShift(bundle, onm1, c, amt);
+            }
+            memcpy(b + c, b + po + amt + o, s);
+            c += s;
+            o += s;
+        }
+    }
+    ose_drop(bundle);
 }
 
 /**************************************************
@@ -704,11 +704,17 @@ struct ose_timetag ose_popTimetag(ose_bundle bundle);
 /**************************************************
  * Stack Operations
  **************************************************/
+/*
+ * Each of the operations below that takes a fixed number of
+ * elements has an Unchecked variant that doesn't check that the
+ * stack has them, for callers that have already made sure of it.
+ */
 /**
  * @brief Drop the top two elements on the stack.
  * @f$\mathrm{2DROP}(S(E_1, E_2)) \Rightarrow S'@f$
  */
 void ose_2drop(ose_bundle bundle);
+void ose_2dropUnchecked(ose_bundle bundle);
 
 
 
@@ -719,6 +725,7 @@ void ose_2drop(ose_bundle bundle);
  * S'(E_1, E_2, E_1, E_2)@f$
  */
 void ose_2dup(ose_bundle bundle);
+void ose_2dupUnchecked(ose_bundle bundle);
 
 
 
@@ -730,6 +737,7 @@ void ose_2dup(ose_bundle bundle);
  * S'(E_3, E_4, E_1, E_2, E_3, E_4)@f$
  */
 void ose_2over(ose_bundle bundle);
+void ose_2overUnchecked(ose_bundle bundle);
 
 
 
@@ -740,6 +748,7 @@ void ose_2over(ose_bundle bundle);
  * S'(E_3, E_4, E_1, E_2)@f$
  */
 void ose_2swap(ose_bundle bundle);
+void ose_2swapUnchecked(ose_bundle bundle);
 
 
 
@@ -750,6 +759,7 @@ void ose_2swap(ose_bundle bundle);
  */
 void ose_dropAtOffset(ose_bundle bundle, int32_t offset);
 void ose_drop(ose_bundle bundle);
+void ose_dropUnchecked(ose_bundle bundle);
 
 
 
@@ -759,6 +769,7 @@ void ose_drop(ose_bundle bundle);
  * @f$\mathrm{DUP}(S(E_1)) \Rightarrow S'(E_1, E_1)@f$
  */
 void ose_dup(ose_bundle bundle);
+void ose_dupUnchecked(ose_bundle bundle);
 
 
 
@@ -768,6 +779,7 @@ void ose_dup(ose_bundle bundle);
  * @f$\mathrm{NIP}(S(E_1, E_2)) \Rightarrow S'(E_1)@f$
  */
 void ose_nip(ose_bundle bundle);
+void ose_nipUnchecked(ose_bundle bundle);
 
 
 
@@ -777,6 +789,7 @@ void ose_nip(ose_bundle bundle);
  * @f$\mathrm{ROT}(S(E_1, E_2, E_3)) \Rightarrow S'(E_2, E_3, E_1)@f$
  */
 void ose_notrot(ose_bundle bundle);
+void ose_notrotUnchecked(ose_bundle bundle);
 
 
 
@@ -786,6 +799,7 @@ void ose_notrot(ose_bundle bundle);
  * @f$\mathrm{over}(S(E_1, E_2)) \Rightarrow S'(E_2, E_1, E_2)@f$
  */
 void ose_over(ose_bundle bundle);
+void ose_overUnchecked(ose_bundle bundle);
 
 
 
@@ -887,6 +901,7 @@ void ose_picPkMatch(ose_bundle bundle);
  * @f$\mathrm{ROT}(S(E_1, E_2, E_3)) \Rightarrow S'(E_3, E_1, E_2)@f$
  */
 void ose_rot(ose_bundle bundle);
+void ose_rotUnchecked(ose_bundle bundle);
 
 
 
@@ -896,6 +911,7 @@ void ose_rot(ose_bundle bundle);
  * @f$\mathrm{SWAP}(S(E_1, E_2)) \Rightarrow S'(E_2, E_1)@f$
  */
 void ose_swap(ose_bundle bundle);
+void ose_swapUnchecked(ose_bundle bundle);
 
 
 
@@ -905,6 +921,7 @@ void ose_swap(ose_bundle bundle);
  * @f$\mathrm{TUCK}(S(E_1, E_2)) \Rightarrow S'(E_1, E_2, E_1)@f$
  */
 void ose_tuck(ose_bundle bundle);
+void ose_tuckUnchecked(ose_bundle bundle);
 
 /**************************************************
  * Grouping / Ungrouping
@@ -915,11 +932,31 @@ void ose_bundleFromTop(ose_bundle bundle);
 void ose_clear(ose_bundle bundle);
 void ose_clearPayload(ose_bundle bundle);
 void ose_pop(ose_bundle bundle);
+/**
+ * @brief Pop, then swap, finding the top elements only once.
+ */
+void ose_popSwap(ose_bundle bundle);
 void ose_popAll(ose_bundle bundle);
 void ose_popAllDrop(ose_bundle bundle);
 void ose_popAllBundle(ose_bundle bundle);
 void ose_popAllDropBundle(ose_bundle bundle);
 void ose_push(ose_bundle bundle);
+/*
+  Build a message an item at a time in amortized constant time.
+  The open message is not a valid OSC message until it has been
+  sealed, and must stay on top of the stack while it's being built:
+  ose_pushToOpenMessage() appends the items of the topmost element
+  to the open message below it, ose_popFromOpenMessage() pops the
+  last item of the topmost open message, and ose_sealMessage()
+  turns the topmost open message into an ordinary message.
+*/
+void ose_pushOpenMessage(ose_bundle bundle,
+                         const char * const address,
+                         int32_t addresslen,
+                         int32_t nitems);
+void ose_pushToOpenMessage(ose_bundle bundle);
+void ose_popFromOpenMessage(ose_bundle bundle);
+void ose_sealMessage(ose_bundle bundle);
 void ose_split(ose_bundle bundle);
 void ose_join(ose_bundle bundle);
 void ose_unpack(ose_bundle bundle);
@@ -975,6 +1012,28 @@ void ose_splitStringFromStart(ose_bundle bundle);
 void ose_swap4Bytes(ose_bundle bundle);
 void ose_swap8Bytes(ose_bundle bundle);
 void ose_swapNBytes(ose_bundle bundle);
+void ose_swapBlobByteOrder32(ose_bundle bundle);
+void ose_swapBlobByteOrder64(ose_bundle bundle);
+
+/**
+   @brief Replace the blob that is the last item of the message on
+   top of the stack with a compressed copy of it. See ose_lz.h.
+   The compressed blob is written into the free space of the
+   bundle, which must have room for #ose_lz_compressBound bytes. If
+   there isn't room, the stack is left as it is and the error is
+   set to #OSE_ERR_RANGE.
+*/
+void ose_compressBlob(ose_bundle bundle);
+
+/**
+   @brief Replace the compressed blob that is the last item of the
+   message on top of the stack with its contents, which are
+   decompressed straight into the free space of the bundle. If it
+   is malformed, or there isn't room, the stack is left as it is
+   and the error is set to #OSE_ERR_RANGE.
+*/
+void ose_decompressBlob(ose_bundle bundle);
+void ose_swapItemsByteOrder(ose_bundle bundle);
 void ose_trimStringEnd(ose_bundle bundle);
 void ose_trimStringStart(ose_bundle bundle);
 void ose_match(ose_bundle bundle);
@@ -985,8 +1044,150 @@ void ose_lookup(ose_bundle bundle);
 void ose_route(ose_bundle bundle);
 void ose_routeWithDelegation(ose_bundle bundle);
 void ose_gather(ose_bundle bundle);
+
+/**
+   @brief A loop body that handles the iterations from @p start up
+   to, but not including, @p end.
+*/
+typedef void (*ose_parallelfn)(void *context,
+                               int32_t start,
+                               int32_t end);
+/**
+   @brief Runs @p fn over the iterations 0 to @p n, split into
+   ranges that may be run concurrently, and returns when they have
+   all finished.
+*/
+typedef void (*ose_parallelfor)(int32_t n,
+                                ose_parallelfn fn,
+                                void *context);
+
+/**
+   @brief Install the function used to run the loops of the parallel
+   route and gather functions. Passing NULL restores the default,
+   which runs them in the calling thread. See sys/ose_threads.h for
+   a thread pool.
+*/
+void ose_setParallelFor(ose_parallelfor pf);
+
+/**
+   @brief Run a loop with the function installed with
+   #ose_setParallelFor.
+*/
+void ose_parallelFor(int32_t n, ose_parallelfn fn, void *context);
+
+/**
+   @brief Versions of #ose_route, #ose_routeWithDelegation, and
+   #ose_gather that index the elements of the bundle, match them
+   in parallel, and copy the results in parallel. The results are
+   byte for byte the same as those of the sequential versions.
+
+   The index takes 20 bytes per element at the end of the free
+   space of the bundle. When there isn't room for it, the sequential
+   version is called.
+*/
+void ose_routeParallel(ose_bundle bundle);
+void ose_routeWithDelegationParallel(ose_bundle bundle);
+void ose_gatherParallel(ose_bundle bundle);
+
+/**
+   @brief Replace common pairs of words in the bundle on top of the
+   stack, and in any bundles nested in it, with builtins that do
+   the same thing in one step: swap drop with nip, over over with
+   2dup, rot rot with -rot, and pop swap with pop/swap. This
+   assumes that those builtins haven't been redefined.
+*/
+void ose_peephole(ose_bundle bundle);
 void ose_nth(ose_bundle bundle);
 
+/**
+   @brief Sort the elements of the bundle on top of the stack by
+   their first numeric item, from smallest to largest. Elements
+   that have no numeric item come last, and elements with equal
+   keys keep their order.
+
+   The sort uses an index of 32 bytes per element, and a copy of
+   the contents of the bundle, in the free space after it. If there
+   isn't room, the bundle is left as it is, and the error is set to
+   #OSE_ERR_RANGE. The same goes for the other sorts.
+*/
+void ose_sort(ose_bundle bundle);
+
+/**
+   @brief Sort the elements of the bundle on top of the stack by
+   address.
+*/
+void ose_sortByAddress(ose_bundle bundle);
+
+/**
+   @brief Sort the elements of the bundle below the int32 on top of
+   the stack by the item at that index. Elements for which that
+   item is missing or isn't numeric come last.
+*/
+void ose_sortByItem(ose_bundle bundle);
+
+/**
+   @brief Replace the bundle below the int32 k on top of the stack
+   with its k elements with the largest first numeric items, from
+   largest to smallest. Only those k elements are sorted.
+*/
+void ose_topK(ose_bundle bundle);
+
+/**
+   @brief Turn the bundle on top of the stack into a dictionary, by
+   adding an index message with the address #OSE_DICT_INDEX_ADDRESS
+   as its first element. The result is still an ordinary bundle, and
+   its other elements are the entries, which are keyed by address.
+
+   The index is a hash table of the offsets of the entries, so
+   #ose_dictGet, #ose_dictPut, and #ose_dictDelete find an entry
+   without searching for it. Only those functions keep the index up
+   to date. Calling this on a dictionary rebuilds its index.
+*/
+void ose_toDict(ose_bundle bundle);
+
+/**
+   @brief Like #ose_lookup, but uses the index if the bundle is a
+   dictionary.
+*/
+void ose_dictGet(ose_bundle bundle);
+
+/**
+   @brief Like #ose_assign, but uses the index, and keeps it up to
+   date, if the bundle is a dictionary.
+*/
+void ose_dictPut(ose_bundle bundle);
+
+/**
+   @brief Remove the element whose address is the string on top of
+   the stack from the bundle below it, using the index if the
+   bundle is a dictionary.
+*/
+void ose_dictDelete(ose_bundle bundle);
+
+/**
+   @brief Compare the bundle on top of the stack with the one below
+   it, and replace the one below it with the top one, and the top
+   one with a patch that turns the one below into it. Elements are
+   paired by address, so the patch holds only the elements that
+   were inserted or replaced, and the counts of those that were
+   kept or deleted.
+
+   The diff takes up to 32 bytes per element of the lower bundle,
+   12 per element of the top one, and room for the patch, in the
+   free space after the top one. If
+   there isn't room, the stack is left as it is and the error is
+   set to #OSE_ERR_RANGE.
+*/
+void ose_diff(ose_bundle bundle);
+
+/**
+   @brief Apply the patch on top of the stack, made by #ose_diff, to
+   the bundle below it, in place. If the patch doesn't fit the
+   bundle, or there isn't room for the result, nothing is changed
+   and the error is set to #OSE_ERR_RANGE.
+*/
+void ose_patch(ose_bundle bundle);
+
 /**************************************************
  * Creatio Ex Nihilo
  **************************************************/
@@ -1005,6 +1206,12 @@ void ose_pushBundle(ose_bundle bundle);
 void ose_add(ose_bundle bundle);
 void ose_sub(ose_bundle bundle);
 void ose_mul(ose_bundle bundle);
+/**
+   @brief Divide the top item by the one below it. If the divisor
+   of an integer division is zero, or the quotient doesn't fit in
+   its type, the stack is left as it is and the error is set to
+   #OSE_ERR_RANGE. The same goes for #ose_mod.
+*/
 void ose_div(ose_bundle bundle);
 void ose_mod(ose_bundle bundle);
 void ose_pow(ose_bundle bundle);
@@ -60,6 +60,7 @@ SOFTWARE.
 #include "ose_stackops.h"
 #include "ose_builtins.h"
 #include "ose_vm.h"
+#include "ose_symtab.h"
 
 #ifdef OSE_SYMTAB_FNSYMS
 #define OSE_SYMTAB_VALUE(s) s, #s
@@ -67,21 +68,31 @@ SOFTWARE.
 #define OSE_SYMTAB_VALUE(s) s
 #endif
 
-#line 46 "ose_symtab.gperf"
+#line 47 "ose_symtab.gperf"
 struct _ose_symtab_rec {
 	char *name;
 	void (*f)(ose_bundle);
 #ifdef OSE_SYMTAB_FNSYMS
 	char *fnsym;
 #endif
+	/* stack effect: the number of elements the function needs
+	   from the top of the stack, and the number it leaves in their
+	   place, or -1, -1 if that depends on what's on the stack, or
+	   if it touches the contexts of the VM other than the stack,
+	   apart from reading the env */
+	int in;
+	int out;
+	/* a variant of f that doesn't check that the stack has the
+	   elements it needs, or NULL */
+	void (*uf)(ose_bundle);
 };
 
-#define TOTAL_KEYWORDS 146
+#define TOTAL_KEYWORDS 166
 #define MIN_WORD_LENGTH 2
 #define MAX_WORD_LENGTH 24
 #define MIN_HASH_VALUE 2
-#define MAX_HASH_VALUE 348
-/* maximum key range = 347, duplicates = 0 */
+#define MAX_HASH_VALUE 679
+/* maximum key range = 678, duplicates = 0 */
 
 #ifdef __GNUC__
 __inline
@@ -97,32 +108,32 @@ _ose_symtab_hash (str, len)
 {
   static const unsigned short asso_values[] =
     {
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349,  45,  45, 349,  20,  15,  15,  15,
-       10, 349, 349, 349, 349,  10,   5,  35, 349,  15,
-        5,  50,  20, 349, 349, 349,  15, 349, 349, 349,
-        0,  40,   5,   5,   5,   0, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349,  45,  15, 155,
-        5,   0,  35,  10,  65,  65, 135,   0,   5,  30,
-       90,   5,  25,  15,  40,   0,   0, 110, 120,  60,
-       15,   0, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349, 349, 349, 349,
-      349, 349, 349, 349, 349, 349, 349
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680,  45,  45, 680,  20,  15,  15,  15,
+       10, 680, 680, 680, 680,  10,   5,  35, 680,  15,
+        5,  50, 150, 680, 680, 680,  15, 680, 680, 680,
+        0,  40,   5,   5,   5,   0, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680,  91, 162, 155,
+        5, 169, 100,  10,  65,  65, 135,   0, 166,  30,
+      131,   5,  43, 118, 163,   0,   0, 146, 120,  60,
+       15,   0, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680, 680, 680, 680,
+      680, 680, 680, 680, 680, 680, 680
     };
   register unsigned int hval = len;
 
@@ -148,354 +159,466 @@ _ose_symtab_hash (str, len)
 static const struct _ose_symtab_rec _ose_symtab_wordlist[] =
   {
     {""}, {""},
-#line 221 "ose_symtab.gperf"
-    {"/s", OSE_SYMTAB_VALUE(OSEVM_TOSTRING)},
-    {""}, {""}, {""}, {""},
-#line 211 "ose_symtab.gperf"
-    {"/@", OSE_SYMTAB_VALUE(OSEVM_ASSIGN)},
-#line 140 "ose_symtab.gperf"
-    {"/replace", OSE_SYMTAB_VALUE(ose_builtin_replace)},
-#line 72 "ose_symtab.gperf"
-    {"/rot", OSE_SYMTAB_VALUE(ose_builtin_rot)},
+#line 252 "ose_symtab.gperf"
+    {"/s", OSE_SYMTAB_VALUE(OSEVM_TOSTRING), 1, 1},
+    {""}, {""}, {""},
+#line 228 "ose_symtab.gperf"
+    {"/stats", OSE_SYMTAB_VALUE(ose_builtin_stats), -1, -1},
+#line 242 "ose_symtab.gperf"
+    {"/@", OSE_SYMTAB_VALUE(OSEVM_ASSIGN), -1, -1},
     {""},
-#line 143 "ose_symtab.gperf"
-    {"/route", OSE_SYMTAB_VALUE(ose_builtin_route)},
-#line 215 "ose_symtab.gperf"
-    {"/>", OSE_SYMTAB_VALUE(OSEVM_COPYCONTEXTBUNDLE)},
-#line 188 "ose_symtab.gperf"
-    {"/dotimes", OSE_SYMTAB_VALUE(ose_builtin_dotimes)},
+#line 83 "ose_symtab.gperf"
+    {"/rot", OSE_SYMTAB_VALUE(ose_builtin_rot), 3, 3, ose_builtin_rotUnchecked},
+#line 165 "ose_symtab.gperf"
+    {"/sort", OSE_SYMTAB_VALUE(ose_builtin_sort), 1, 1},
     {""},
-#line 191 "ose_symtab.gperf"
-    {"/replace/bundle", OSE_SYMTAB_VALUE(ose_builtin_replaceBundle)},
+#line 246 "ose_symtab.gperf"
+    {"/>", OSE_SYMTAB_VALUE(OSEVM_COPYCONTEXTBUNDLE), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 249 "ose_symtab.gperf"
+    {"/-", OSE_SYMTAB_VALUE(OSEVM_MOVEELEMTOCONTEXTBUNDLE), -1, -1},
+#line 141 "ose_symtab.gperf"
+    {"/join/strings", OSE_SYMTAB_VALUE(ose_builtin_joinStrings), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 166 "ose_symtab.gperf"
+    {"/sort/address", OSE_SYMTAB_VALUE(ose_builtin_sortByAddress), 1, 1},
+    {""}, {""}, {""},
+#line 245 "ose_symtab.gperf"
+    {"/'", OSE_SYMTAB_VALUE(OSEVM_QUOTE), 0, 0},
+    {""}, {""}, {""}, {""},
+#line 254 "ose_symtab.gperf"
+    {"/&", OSE_SYMTAB_VALUE(OSEVM_APPENDBYTE), -1, -1},
+#line 193 "ose_symtab.gperf"
+    {"/lt", OSE_SYMTAB_VALUE(ose_builtin_lt), 2, 1},
+    {""}, {""}, {""},
+#line 243 "ose_symtab.gperf"
+    {"/$", OSE_SYMTAB_VALUE(OSEVM_LOOKUP), 1, 1},
+    {""}, {""}, {""}, {""},
+#line 248 "ose_symtab.gperf"
+    {"/<", OSE_SYMTAB_VALUE(OSEVM_REPLACECONTEXTBUNDLE), -1, -1},
+#line 247 "ose_symtab.gperf"
+    {"/<<", OSE_SYMTAB_VALUE(OSEVM_APPENDTOCONTEXTBUNDLE), -1, -1},
     {""},
-#line 218 "ose_symtab.gperf"
-    {"/-", OSE_SYMTAB_VALUE(OSEVM_MOVEELEMTOCONTEXTBUNDLE)},
+#line 167 "ose_symtab.gperf"
+    {"/sort/item", OSE_SYMTAB_VALUE(ose_builtin_sortByItem), -1, -1},
+    {""}, {""}, {""},
+#line 102 "ose_symtab.gperf"
+    {"/split", OSE_SYMTAB_VALUE(ose_builtin_split), -1, -1},
+    {""}, {""},
+#line 81 "ose_symtab.gperf"
+    {"/roll/bottom", OSE_SYMTAB_VALUE(ose_builtin_rollBottom), 1, 1},
+    {""}, {""}, {""}, {""}, {""},
 #line 129 "ose_symtab.gperf"
-    {"/join/strings", OSE_SYMTAB_VALUE(ose_builtin_joinStrings)},
-#line 161 "ose_symtab.gperf"
-    {"/neg", OSE_SYMTAB_VALUE(ose_builtin_neg)},
+    {"/concat/blobs", OSE_SYMTAB_VALUE(ose_builtin_concatenateBlobs), -1, -1},
     {""},
-#line 204 "ose_symtab.gperf"
-    {"/replacecontextbundle", OSE_SYMTAB_VALUE(ose_builtin_replaceContextBundle)},
-#line 98 "ose_symtab.gperf"
-    {"/count/elems", OSE_SYMTAB_VALUE(ose_builtin_countElems)},
-#line 126 "ose_symtab.gperf"
-    {"/decat/string/fromstart", OSE_SYMTAB_VALUE(ose_builtin_decatenateStringFromStart)},
+#line 130 "ose_symtab.gperf"
+    {"/concat/strings", OSE_SYMTAB_VALUE(ose_builtin_concatenateStrings), -1, -1},
+    {""}, {""}, {""}, {""}, {""},
+#line 144 "ose_symtab.gperf"
+    {"/split/string/fromstart", OSE_SYMTAB_VALUE(ose_builtin_splitStringFromStart), -1, -1},
+    {""}, {""},
+#line 143 "ose_symtab.gperf"
+    {"/split/string/fromend", OSE_SYMTAB_VALUE(ose_builtin_splitStringFromEnd), -1, -1},
+    {""}, {""}, {""},
+#line 122 "ose_symtab.gperf"
+    {"/size/tt", OSE_SYMTAB_VALUE(ose_builtin_sizeTT), -1, -1},
 #line 163 "ose_symtab.gperf"
-    {"/neq", OSE_SYMTAB_VALUE(ose_builtin_neq)},
-    {""},
-#line 125 "ose_symtab.gperf"
-    {"/decat/string/fromend", OSE_SYMTAB_VALUE(ose_builtin_decatenateStringFromEnd)},
-#line 214 "ose_symtab.gperf"
-    {"/'", OSE_SYMTAB_VALUE(OSEVM_QUOTE)},
-#line 119 "ose_symtab.gperf"
-    {"/address", OSE_SYMTAB_VALUE(ose_builtin_copyAddressToString)},
-#line 155 "ose_symtab.gperf"
-    {"/add", OSE_SYMTAB_VALUE(ose_builtin_add)},
-#line 111 "ose_symtab.gperf"
-    {"/addresses", OSE_SYMTAB_VALUE(ose_builtin_getAddresses)},
-#line 90 "ose_symtab.gperf"
-    {"/split", OSE_SYMTAB_VALUE(ose_builtin_split)},
-#line 223 "ose_symtab.gperf"
-    {"/&", OSE_SYMTAB_VALUE(OSEVM_APPENDBYTE)},
-#line 165 "ose_symtab.gperf"
-    {"/lt", OSE_SYMTAB_VALUE(ose_builtin_lt)},
-#line 164 "ose_symtab.gperf"
-    {"/lte", OSE_SYMTAB_VALUE(ose_builtin_lte)},
+    {"/nth", OSE_SYMTAB_VALUE(ose_builtin_nth), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 80 "ose_symtab.gperf"
+    {"/roll/jth", OSE_SYMTAB_VALUE(ose_builtin_roll), -1, -1},
+    {""}, {""}, {""},
+#line 116 "ose_symtab.gperf"
+    {"/size/address", OSE_SYMTAB_VALUE(ose_builtin_sizeAddress), -1, -1},
     {""},
-#line 124 "ose_symtab.gperf"
-    {"/decat/blob/fromstart", OSE_SYMTAB_VALUE(ose_builtin_decatenateBlobFromStart)},
-#line 212 "ose_symtab.gperf"
-    {"/$", OSE_SYMTAB_VALUE(OSEVM_LOOKUP)},
-#line 85 "ose_symtab.gperf"
-    {"/pop/all", OSE_SYMTAB_VALUE(ose_builtin_popAll)},
-#line 123 "ose_symtab.gperf"
-    {"/decat/blob/fromend", OSE_SYMTAB_VALUE(ose_builtin_decatenateBlobFromEnd)},
-#line 87 "ose_symtab.gperf"
-    {"/pop/all/bundle", OSE_SYMTAB_VALUE(ose_builtin_popAllBundle)},
+#line 159 "ose_symtab.gperf"
+    {"/lookup", OSE_SYMTAB_VALUE(ose_builtin_lookup), -1, -1},
     {""},
-#line 217 "ose_symtab.gperf"
-    {"/<", OSE_SYMTAB_VALUE(OSEVM_REPLACECONTEXTBUNDLE)},
-#line 216 "ose_symtab.gperf"
-    {"/<<", OSE_SYMTAB_VALUE(OSEVM_APPENDTOCONTEXTBUNDLE)},
-#line 103 "ose_symtab.gperf"
-    {"/lengths/items", OSE_SYMTAB_VALUE(ose_builtin_lengthsItems)},
-#line 88 "ose_symtab.gperf"
-    {"/pop/all/drop/bundle", OSE_SYMTAB_VALUE(ose_builtin_popAllDropBundle)},
-#line 194 "ose_symtab.gperf"
-    {"/apply", OSE_SYMTAB_VALUE(ose_builtin_apply)},
-#line 220 "ose_symtab.gperf"
-    {"/f", OSE_SYMTAB_VALUE(OSEVM_TOFLOAT)},
-#line 132 "ose_symtab.gperf"
-    {"/split/string/fromstart", OSE_SYMTAB_VALUE(ose_builtin_splitStringFromStart)},
+#line 111 "ose_symtab.gperf"
+    {"/count/items", OSE_SYMTAB_VALUE(ose_builtin_countItems), 1, 2},
+#line 146 "ose_symtab.gperf"
+    {"/swap/bytes/8", OSE_SYMTAB_VALUE(ose_builtin_swap8Bytes), -1, -1},
+    {""}, {""}, {""},
+#line 244 "ose_symtab.gperf"
+    {"/!", OSE_SYMTAB_VALUE(OSEVM_FUNCALL), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""},
+#line 71 "ose_symtab.gperf"
+    {"/2swap", OSE_SYMTAB_VALUE(ose_builtin_2swap), 4, 4, ose_builtin_2swapUnchecked},
+#line 133 "ose_symtab.gperf"
+    {"/string/toaddress/swap", OSE_SYMTAB_VALUE(ose_builtin_swapStringToAddress), -1, -1},
+    {""}, {""},
+#line 69 "ose_symtab.gperf"
+    {"/2dup", OSE_SYMTAB_VALUE(ose_builtin_2dup), 2, 4, ose_builtin_2dupUnchecked},
+#line 68 "ose_symtab.gperf"
+    {"/2drop", OSE_SYMTAB_VALUE(ose_builtin_2drop), 2, 0, ose_builtin_2dropUnchecked},
+#line 118 "ose_symtab.gperf"
+    {"/size/item", OSE_SYMTAB_VALUE(ose_builtin_sizeItem), 1, 2},
+    {""}, {""},
 #line 84 "ose_symtab.gperf"
-    {"/pop", OSE_SYMTAB_VALUE(ose_builtin_pop)},
-#line 64 "ose_symtab.gperf"
-    {"/-rot", OSE_SYMTAB_VALUE(ose_builtin_notrot)},
-#line 131 "ose_symtab.gperf"
-    {"/split/string/fromend", OSE_SYMTAB_VALUE(ose_builtin_splitStringFromEnd)},
-#line 70 "ose_symtab.gperf"
-    {"/roll/bottom", OSE_SYMTAB_VALUE(ose_builtin_rollBottom)},
+    {"/swap", OSE_SYMTAB_VALUE(ose_builtin_swap), 2, 2, ose_builtin_swapUnchecked},
+    {""}, {""}, {""},
+#line 251 "ose_symtab.gperf"
+    {"/f", OSE_SYMTAB_VALUE(OSEVM_TOFLOAT), 1, 1},
+    {""}, {""}, {""}, {""},
+#line 74 "ose_symtab.gperf"
+    {"/nip", OSE_SYMTAB_VALUE(ose_builtin_nip), 2, 1, ose_builtin_nipUnchecked},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 211 "ose_symtab.gperf"
+    {"/exec2", OSE_SYMTAB_VALUE(ose_builtin_exec2), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 210 "ose_symtab.gperf"
+    {"/exec1", OSE_SYMTAB_VALUE(ose_builtin_exec1), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 94 "ose_symtab.gperf"
+    {"/join", OSE_SYMTAB_VALUE(ose_builtin_join), 2, 1},
+#line 121 "ose_symtab.gperf"
+    {"/sizes/items", OSE_SYMTAB_VALUE(ose_builtin_sizesItems), -1, -1},
+    {""}, {""},
+#line 187 "ose_symtab.gperf"
+    {"/mod", OSE_SYMTAB_VALUE(ose_builtin_mod), 2, 1},
+    {""}, {""}, {""},
+#line 134 "ose_symtab.gperf"
+    {"/tt", OSE_SYMTAB_VALUE(ose_builtin_copyTTToBlob), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""},
+#line 168 "ose_symtab.gperf"
+    {"/topk", OSE_SYMTAB_VALUE(ose_builtin_topK), -1, -1},
     {""},
+#line 169 "ose_symtab.gperf"
+    {"/todict", OSE_SYMTAB_VALUE(ose_builtin_toDict), -1, -1},
+#line 238 "ose_symtab.gperf"
+    {"/tofloat", OSE_SYMTAB_VALUE(ose_builtin_toFloat), 1, 1},
+    {""}, {""}, {""}, {""},
+#line 227 "ose_symtab.gperf"
+    {"/suspend", OSE_SYMTAB_VALUE(ose_builtin_suspend), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 237 "ose_symtab.gperf"
+    {"/toint32", OSE_SYMTAB_VALUE(ose_builtin_toInt32), 1, 1},
+#line 95 "ose_symtab.gperf"
+    {"/pop", OSE_SYMTAB_VALUE(ose_builtin_pop), -1, -1},
+#line 212 "ose_symtab.gperf"
+    {"/exec3", OSE_SYMTAB_VALUE(ose_builtin_exec3), -1, -1},
 #line 82 "ose_symtab.gperf"
-    {"/clear/payload", OSE_SYMTAB_VALUE(ose_builtin_clearPayload)},
-#line 193 "ose_symtab.gperf"
-    {"/copy/elem", OSE_SYMTAB_VALUE(ose_builtin_copyElem)},
-#line 81 "ose_symtab.gperf"
-    {"/clear", OSE_SYMTAB_VALUE(ose_builtin_clear)},
-#line 130 "ose_symtab.gperf"
-    {"/string/toaddress/move", OSE_SYMTAB_VALUE(ose_builtin_moveStringToAddress)},
-#line 117 "ose_symtab.gperf"
-    {"/concat/blobs", OSE_SYMTAB_VALUE(ose_builtin_concatenateBlobs)},
-#line 162 "ose_symtab.gperf"
-    {"/eql", OSE_SYMTAB_VALUE(ose_builtin_eql)},
-#line 118 "ose_symtab.gperf"
-    {"/concat/strings", OSE_SYMTAB_VALUE(ose_builtin_concatenateStrings)},
+    {"/roll/match", OSE_SYMTAB_VALUE(ose_builtin_rollMatch), -1, -1},
+#line 75 "ose_symtab.gperf"
+    {"/-rot", OSE_SYMTAB_VALUE(ose_builtin_notrot), 3, 3, ose_builtin_notrotUnchecked},
+#line 119 "ose_symtab.gperf"
+    {"/size/payload", OSE_SYMTAB_VALUE(ose_builtin_sizePayload), -1, -1},
+#line 131 "ose_symtab.gperf"
+    {"/address", OSE_SYMTAB_VALUE(ose_builtin_copyAddressToString), 1, 2},
 #line 183 "ose_symtab.gperf"
-    {"/exec2", OSE_SYMTAB_VALUE(ose_builtin_exec2)},
-#line 203 "ose_symtab.gperf"
-    {"/appendtocontextbundle", OSE_SYMTAB_VALUE(ose_builtin_appendToContextBundle)},
-#line 86 "ose_symtab.gperf"
-    {"/pop/all/drop", OSE_SYMTAB_VALUE(ose_builtin_popAllDrop)},
+    {"/add", OSE_SYMTAB_VALUE(ose_builtin_add), 2, 1},
+#line 123 "ose_symtab.gperf"
+    {"/addresses", OSE_SYMTAB_VALUE(ose_builtin_getAddresses), 1, 2},
+    {""}, {""},
+#line 160 "ose_symtab.gperf"
+    {"/route", OSE_SYMTAB_VALUE(ose_builtin_route), -1, -1},
     {""},
-#line 144 "ose_symtab.gperf"
-    {"/route/all", OSE_SYMTAB_VALUE(ose_builtin_routeWithDelegation)},
-#line 210 "ose_symtab.gperf"
-    {"/appendbyte", OSE_SYMTAB_VALUE(ose_builtin_appendByte)},
-#line 142 "ose_symtab.gperf"
-    {"/lookup", OSE_SYMTAB_VALUE(ose_builtin_lookup)},
+#line 216 "ose_symtab.gperf"
+    {"/dotimes", OSE_SYMTAB_VALUE(ose_builtin_dotimes), -1, -1},
+    {""}, {""}, {""},
+#line 150 "ose_symtab.gperf"
+    {"/compress/blob", OSE_SYMTAB_VALUE(ose_builtin_compressBlob), 1, 1},
+#line 188 "ose_symtab.gperf"
+    {"/pow", OSE_SYMTAB_VALUE(ose_builtin_pow), 2, 1},
+#line 189 "ose_symtab.gperf"
+    {"/neg", OSE_SYMTAB_VALUE(ose_builtin_neg), 1, 1},
     {""}, {""},
-#line 61 "ose_symtab.gperf"
-    {"/drop", OSE_SYMTAB_VALUE(ose_builtin_drop)},
-#line 182 "ose_symtab.gperf"
-    {"/exec1", OSE_SYMTAB_VALUE(ose_builtin_exec1)},
-#line 127 "ose_symtab.gperf"
-    {"/elem/toblob", OSE_SYMTAB_VALUE(ose_builtin_elemToBlob)},
 #line 110 "ose_symtab.gperf"
-    {"/size/tt", OSE_SYMTAB_VALUE(ose_builtin_sizeTT)},
-#line 146 "ose_symtab.gperf"
-    {"/nth", OSE_SYMTAB_VALUE(ose_builtin_nth)},
-#line 101 "ose_symtab.gperf"
-    {"/length/tt", OSE_SYMTAB_VALUE(ose_builtin_lengthTT)},
+    {"/count/elems", OSE_SYMTAB_VALUE(ose_builtin_countElems), 0, 1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""},
-#line 108 "ose_symtab.gperf"
-    {"/sizes/elems", OSE_SYMTAB_VALUE(ose_builtin_sizesElems)},
-#line 120 "ose_symtab.gperf"
-    {"/payload", OSE_SYMTAB_VALUE(ose_builtin_copyPayloadToBlob)},
-#line 69 "ose_symtab.gperf"
-    {"/roll/jth", OSE_SYMTAB_VALUE(ose_builtin_roll)},
-#line 100 "ose_symtab.gperf"
-    {"/length/address", OSE_SYMTAB_VALUE(ose_builtin_lengthAddress)},
-#line 60 "ose_symtab.gperf"
-    {"/2swap", OSE_SYMTAB_VALUE(ose_builtin_2swap)},
-#line 121 "ose_symtab.gperf"
-    {"/string/toaddress/swap", OSE_SYMTAB_VALUE(ose_builtin_swapStringToAddress)},
-#line 104 "ose_symtab.gperf"
-    {"/size/address", OSE_SYMTAB_VALUE(ose_builtin_sizeAddress)},
-#line 160 "ose_symtab.gperf"
-    {"/pow", OSE_SYMTAB_VALUE(ose_builtin_pow)},
-#line 58 "ose_symtab.gperf"
-    {"/2dup", OSE_SYMTAB_VALUE(ose_builtin_2dup)},
-#line 57 "ose_symtab.gperf"
-    {"/2drop", OSE_SYMTAB_VALUE(ose_builtin_2drop)},
-#line 99 "ose_symtab.gperf"
-    {"/count/items", OSE_SYMTAB_VALUE(ose_builtin_countItems)},
-#line 134 "ose_symtab.gperf"
-    {"/swap/bytes/8", OSE_SYMTAB_VALUE(ose_builtin_swap8Bytes)},
-#line 190 "ose_symtab.gperf"
-    {"/append/bundle", OSE_SYMTAB_VALUE(ose_builtin_appendBundle)},
-#line 73 "ose_symtab.gperf"
-    {"/swap", OSE_SYMTAB_VALUE(ose_builtin_swap)},
+#line 250 "ose_symtab.gperf"
+    {"/i", OSE_SYMTAB_VALUE(OSEVM_TOINT32), 1, 1},
+#line 192 "ose_symtab.gperf"
+    {"/lte", OSE_SYMTAB_VALUE(ose_builtin_lte), 2, 1},
+#line 147 "ose_symtab.gperf"
+    {"/swap/bytes/n", OSE_SYMTAB_VALUE(ose_builtin_swapNBytes), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""},
+#line 222 "ose_symtab.gperf"
+    {"/apply", OSE_SYMTAB_VALUE(ose_builtin_apply), -1, -1},
     {""},
-#line 213 "ose_symtab.gperf"
-    {"/!", OSE_SYMTAB_VALUE(OSEVM_FUNCALL)},
-#line 133 "ose_symtab.gperf"
-    {"/swap/bytes/4", OSE_SYMTAB_VALUE(ose_builtin_swap4Bytes)},
+#line 115 "ose_symtab.gperf"
+    {"/lengths/items", OSE_SYMTAB_VALUE(ose_builtin_lengthsItems), -1, -1},
+    {""}, {""},
+#line 221 "ose_symtab.gperf"
+    {"/copy/elem", OSE_SYMTAB_VALUE(ose_builtin_copyElem), -1, -1},
     {""}, {""}, {""},
-#line 196 "ose_symtab.gperf"
-    {"/return", OSE_SYMTAB_VALUE(ose_builtin_return)},
+#line 156 "ose_symtab.gperf"
+    {"/pmatch", OSE_SYMTAB_VALUE(ose_builtin_pmatch), -1, -1},
+    {""}, {""},
+#line 145 "ose_symtab.gperf"
+    {"/swap/bytes/4", OSE_SYMTAB_VALUE(ose_builtin_swap4Bytes), -1, -1},
+#line 70 "ose_symtab.gperf"
+    {"/2over", OSE_SYMTAB_VALUE(ose_builtin_2over), 4, 6, ose_builtin_2overUnchecked},
     {""},
-#line 63 "ose_symtab.gperf"
-    {"/nip", OSE_SYMTAB_VALUE(ose_builtin_nip)},
-#line 83 "ose_symtab.gperf"
-    {"/join", OSE_SYMTAB_VALUE(ose_builtin_join)},
-#line 59 "ose_symtab.gperf"
-    {"/2over", OSE_SYMTAB_VALUE(ose_builtin_2over)},
+#line 142 "ose_symtab.gperf"
+    {"/string/toaddress/move", OSE_SYMTAB_VALUE(ose_builtin_moveStringToAddress), -1, -1},
+#line 132 "ose_symtab.gperf"
+    {"/payload", OSE_SYMTAB_VALUE(ose_builtin_copyPayloadToBlob), -1, -1},
     {""}, {""},
-#line 159 "ose_symtab.gperf"
-    {"/mod", OSE_SYMTAB_VALUE(ose_builtin_mod)},
-#line 106 "ose_symtab.gperf"
-    {"/size/item", OSE_SYMTAB_VALUE(ose_builtin_sizeItem)},
-#line 184 "ose_symtab.gperf"
-    {"/exec3", OSE_SYMTAB_VALUE(ose_builtin_exec3)},
-#line 102 "ose_symtab.gperf"
-    {"/length/item", OSE_SYMTAB_VALUE(ose_builtin_lengthItem)},
-#line 167 "ose_symtab.gperf"
-    {"/or", OSE_SYMTAB_VALUE(ose_builtin_or)},
+#line 78 "ose_symtab.gperf"
+    {"/pick/bottom", OSE_SYMTAB_VALUE(ose_builtin_pickBottom), -1, -1},
     {""},
-#line 105 "ose_symtab.gperf"
-    {"/size/elem", OSE_SYMTAB_VALUE(ose_builtin_sizeElem)},
+#line 230 "ose_symtab.gperf"
+    {"/lookupinenv", OSE_SYMTAB_VALUE(ose_builtin_lookupInEnv), 1, 1},
+#line 93 "ose_symtab.gperf"
+    {"/clear/payload", OSE_SYMTAB_VALUE(ose_builtin_clearPayload), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""},
+#line 152 "ose_symtab.gperf"
+    {"/swap/order/items", OSE_SYMTAB_VALUE(ose_builtin_swapItemsByteOrder), -1, -1},
+    {""}, {""}, {""},
+#line 113 "ose_symtab.gperf"
+    {"/length/tt", OSE_SYMTAB_VALUE(ose_builtin_lengthTT), -1, -1},
     {""},
-#line 141 "ose_symtab.gperf"
-    {"/assign", OSE_SYMTAB_VALUE(ose_builtin_assign)},
-#line 122 "ose_symtab.gperf"
-    {"/tt", OSE_SYMTAB_VALUE(ose_builtin_copyTTToBlob)},
-#line 166 "ose_symtab.gperf"
-    {"/and", OSE_SYMTAB_VALUE(ose_builtin_and)},
+#line 120 "ose_symtab.gperf"
+    {"/sizes/elems", OSE_SYMTAB_VALUE(ose_builtin_sizesElems), -1, -1},
+#line 148 "ose_symtab.gperf"
+    {"/swap/order/blob/32", OSE_SYMTAB_VALUE(ose_builtin_swapBlobByteOrder32), -1, -1},
+    {""},
+#line 112 "ose_symtab.gperf"
+    {"/length/address", OSE_SYMTAB_VALUE(ose_builtin_lengthAddress), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 77 "ose_symtab.gperf"
+    {"/pick/jth", OSE_SYMTAB_VALUE(ose_builtin_pick), -1, -1},
+#line 103 "ose_symtab.gperf"
+    {"/unpack", OSE_SYMTAB_VALUE(ose_builtin_unpack), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 96 "ose_symtab.gperf"
+    {"/pop/swap", OSE_SYMTAB_VALUE(ose_builtin_popSwap), -1, -1},
     {""}, {""},
-#line 139 "ose_symtab.gperf"
-    {"/pmatch", OSE_SYMTAB_VALUE(ose_builtin_pmatch)},
-#line 202 "ose_symtab.gperf"
-    {"/copycontextbundle", OSE_SYMTAB_VALUE(ose_builtin_copyContextBundle)},
-#line 205 "ose_symtab.gperf"
-    {"/moveelemtocontextbundle", OSE_SYMTAB_VALUE(ose_builtin_moveElemToContextBundle)},
-    {""}, {""}, {""},
-#line 207 "ose_symtab.gperf"
-    {"/tofloat", OSE_SYMTAB_VALUE(ose_builtin_toFloat)},
+#line 223 "ose_symtab.gperf"
+    {"/map", OSE_SYMTAB_VALUE(ose_builtin_map), -1, -1},
+    {""},
+#line 117 "ose_symtab.gperf"
+    {"/size/elem", OSE_SYMTAB_VALUE(ose_builtin_sizeElem), 1, 2},
+#line 161 "ose_symtab.gperf"
+    {"/route/all", OSE_SYMTAB_VALUE(ose_builtin_routeWithDelegation), -1, -1},
     {""}, {""},
-#line 71 "ose_symtab.gperf"
-    {"/roll/match", OSE_SYMTAB_VALUE(ose_builtin_rollMatch)},
-#line 67 "ose_symtab.gperf"
-    {"/pick/bottom", OSE_SYMTAB_VALUE(ose_builtin_pickBottom)},
-#line 107 "ose_symtab.gperf"
-    {"/size/payload", OSE_SYMTAB_VALUE(ose_builtin_sizePayload)},
-#line 156 "ose_symtab.gperf"
-    {"/sub", OSE_SYMTAB_VALUE(ose_builtin_sub)},
+#line 214 "ose_symtab.gperf"
+    {"/exec", OSE_SYMTAB_VALUE(ose_builtin_exec), -1, -1},
+#line 114 "ose_symtab.gperf"
+    {"/length/item", OSE_SYMTAB_VALUE(ose_builtin_lengthItem), 1, 2},
+#line 213 "ose_symtab.gperf"
+    {"/exec1c", OSE_SYMTAB_VALUE(ose_builtin_exec1c), -1, -1},
     {""}, {""},
-#line 189 "ose_symtab.gperf"
-    {"/copy/bundle", OSE_SYMTAB_VALUE(ose_builtin_copyBundle)},
-#line 206 "ose_symtab.gperf"
-    {"/toint32", OSE_SYMTAB_VALUE(ose_builtin_toInt32)},
+#line 174 "ose_symtab.gperf"
+    {"/patch", OSE_SYMTAB_VALUE(ose_builtin_patch), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""}, {""}, {""},
-#line 209 "ose_symtab.gperf"
-    {"/toblob", OSE_SYMTAB_VALUE(ose_builtin_toBlob)},
-#line 200 "ose_symtab.gperf"
-    {"/funcall", OSE_SYMTAB_VALUE(ose_builtin_funcall)},
-#line 62 "ose_symtab.gperf"
-    {"/dup", OSE_SYMTAB_VALUE(ose_builtin_dup)},
-#line 192 "ose_symtab.gperf"
-    {"/move/elem", OSE_SYMTAB_VALUE(ose_builtin_moveElem)},
+#line 155 "ose_symtab.gperf"
+    {"/match", OSE_SYMTAB_VALUE(ose_builtin_match), -1, -1},
+    {""}, {""},
+#line 191 "ose_symtab.gperf"
+    {"/neq", OSE_SYMTAB_VALUE(ose_builtin_neq), 2, 1},
+#line 85 "ose_symtab.gperf"
+    {"/tuck", OSE_SYMTAB_VALUE(ose_builtin_tuck), 2, 3, ose_builtin_tuckUnchecked},
     {""},
-#line 109 "ose_symtab.gperf"
-    {"/sizes/items", OSE_SYMTAB_VALUE(ose_builtin_sizesItems)},
+#line 229 "ose_symtab.gperf"
+    {"/assignstacktoenv", OSE_SYMTAB_VALUE(ose_builtin_assignStackToEnv), -1, -1},
+#line 158 "ose_symtab.gperf"
+    {"/assign", OSE_SYMTAB_VALUE(ose_builtin_assign), -1, -1},
+#line 239 "ose_symtab.gperf"
+    {"/tostring", OSE_SYMTAB_VALUE(ose_builtin_toString), 1, 1},
+#line 194 "ose_symtab.gperf"
+    {"/and", OSE_SYMTAB_VALUE(ose_builtin_and), 2, 1},
     {""}, {""}, {""}, {""},
-#line 174 "ose_symtab.gperf"
-    {"/is/type/int", OSE_SYMTAB_VALUE(ose_builtin_isIntegerType)},
-#line 177 "ose_symtab.gperf"
-    {"/is/type/unit", OSE_SYMTAB_VALUE(ose_builtin_isUnitType)},
-#line 175 "ose_symtab.gperf"
-    {"/is/type/float", OSE_SYMTAB_VALUE(ose_builtin_isFloatType)},
-    {""}, {""},
-#line 198 "ose_symtab.gperf"
-    {"/assignstacktoenv", OSE_SYMTAB_VALUE(ose_builtin_assignStackToEnv)},
-#line 178 "ose_symtab.gperf"
-    {"/is/type/bool", OSE_SYMTAB_VALUE(ose_builtin_isBoolType)},
-#line 66 "ose_symtab.gperf"
-    {"/pick/jth", OSE_SYMTAB_VALUE(ose_builtin_pick)},
-#line 151 "ose_symtab.gperf"
-    {"/push/blob", OSE_SYMTAB_VALUE(ose_builtin_makeBlob)},
+#line 225 "ose_symtab.gperf"
+    {"/return", OSE_SYMTAB_VALUE(ose_builtin_return), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 184 "ose_symtab.gperf"
+    {"/sub", OSE_SYMTAB_VALUE(ose_builtin_sub), 2, 1},
+    {""},
+#line 140 "ose_symtab.gperf"
+    {"/item/toblob", OSE_SYMTAB_VALUE(ose_builtin_itemToBlob), 1, 1},
+    {""},
+#line 202 "ose_symtab.gperf"
+    {"/is/type/int", OSE_SYMTAB_VALUE(ose_builtin_isIntegerType), 1, 1},
+#line 205 "ose_symtab.gperf"
+    {"/is/type/unit", OSE_SYMTAB_VALUE(ose_builtin_isUnitType), 1, 1},
+#line 203 "ose_symtab.gperf"
+    {"/is/type/float", OSE_SYMTAB_VALUE(ose_builtin_isFloatType), 1, 1},
+#line 253 "ose_symtab.gperf"
+    {"/b", OSE_SYMTAB_VALUE(OSEVM_TOBLOB), 1, 1},
+#line 240 "ose_symtab.gperf"
+    {"/toblob", OSE_SYMTAB_VALUE(ose_builtin_toBlob), 1, 1},
+    {""}, {""}, {""}, {""}, {""},
+#line 162 "ose_symtab.gperf"
+    {"/gather", OSE_SYMTAB_VALUE(ose_builtin_gather), -1, -1},
+#line 154 "ose_symtab.gperf"
+    {"/trim/string/start", OSE_SYMTAB_VALUE(ose_builtin_trimStringStart), 1, 1},
+#line 233 "ose_symtab.gperf"
+    {"/copycontextbundle", OSE_SYMTAB_VALUE(ose_builtin_copyContextBundle), -1, -1},
 #line 201 "ose_symtab.gperf"
-    {"/quote", OSE_SYMTAB_VALUE(ose_builtin_quote)},
-#line 145 "ose_symtab.gperf"
-    {"/gather", OSE_SYMTAB_VALUE(ose_builtin_gather)},
+    {"/is/type/string", OSE_SYMTAB_VALUE(ose_builtin_isStringType), 1, 1},
+#line 153 "ose_symtab.gperf"
+    {"/trim/string/end", OSE_SYMTAB_VALUE(ose_builtin_trimStringEnd), 1, 1},
+#line 76 "ose_symtab.gperf"
+    {"/over", OSE_SYMTAB_VALUE(ose_builtin_over), 2, 3, ose_builtin_overUnchecked},
+    {""}, {""},
+#line 101 "ose_symtab.gperf"
+    {"/push", OSE_SYMTAB_VALUE(ose_builtin_push), 2, 1},
     {""}, {""},
+#line 217 "ose_symtab.gperf"
+    {"/copy/bundle", OSE_SYMTAB_VALUE(ose_builtin_copyBundle), -1, -1},
+#line 215 "ose_symtab.gperf"
+    {"/if", OSE_SYMTAB_VALUE(ose_builtin_if), -1, -1},
 #line 173 "ose_symtab.gperf"
-    {"/is/type/string", OSE_SYMTAB_VALUE(ose_builtin_isStringType)},
+    {"/diff", OSE_SYMTAB_VALUE(ose_builtin_diff), -1, -1},
+#line 92 "ose_symtab.gperf"
+    {"/clear", OSE_SYMTAB_VALUE(ose_builtin_clear), -1, -1},
+#line 104 "ose_symtab.gperf"
+    {"/unpack/drop", OSE_SYMTAB_VALUE(ose_builtin_unpackDrop), -1, -1},
+#line 220 "ose_symtab.gperf"
+    {"/move/elem", OSE_SYMTAB_VALUE(ose_builtin_moveElem), -1, -1},
     {""}, {""},
-#line 135 "ose_symtab.gperf"
-    {"/swap/bytes/n", OSE_SYMTAB_VALUE(ose_builtin_swapNBytes)},
-#line 195 "ose_symtab.gperf"
-    {"/map", OSE_SYMTAB_VALUE(ose_builtin_map)},
+#line 98 "ose_symtab.gperf"
+    {"/pop/all/drop", OSE_SYMTAB_VALUE(ose_builtin_popAllDrop), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 79 "ose_symtab.gperf"
+    {"/pick/match", OSE_SYMTAB_VALUE(ose_builtin_pickMatch), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 186 "ose_symtab.gperf"
+    {"/div", OSE_SYMTAB_VALUE(ose_builtin_div), 2, 1},
     {""}, {""},
-#line 128 "ose_symtab.gperf"
-    {"/item/toblob", OSE_SYMTAB_VALUE(ose_builtin_itemToBlob)},
+#line 138 "ose_symtab.gperf"
+    {"/decat/string/fromstart", OSE_SYMTAB_VALUE(ose_builtin_decatenateStringFromStart), -1, -1},
+#line 73 "ose_symtab.gperf"
+    {"/dup", OSE_SYMTAB_VALUE(ose_builtin_dup), 1, 2, ose_builtin_dupUnchecked},
+    {""},
 #line 137 "ose_symtab.gperf"
-    {"/trim/string/start", OSE_SYMTAB_VALUE(ose_builtin_trimStringStart)},
+    {"/decat/string/fromend", OSE_SYMTAB_VALUE(ose_builtin_decatenateStringFromEnd), -1, -1},
+    {""}, {""}, {""},
+#line 127 "ose_symtab.gperf"
+    {"/blob/toelem", OSE_SYMTAB_VALUE(ose_builtin_blobToElem), 1, 1},
+    {""}, {""}, {""},
+#line 195 "ose_symtab.gperf"
+    {"/or", OSE_SYMTAB_VALUE(ose_builtin_or), 2, 1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 72 "ose_symtab.gperf"
+    {"/drop", OSE_SYMTAB_VALUE(ose_builtin_drop), 1, 0, ose_builtin_dropUnchecked},
+    {""}, {""}, {""},
+#line 90 "ose_symtab.gperf"
+    {"/bundle/frombottom", OSE_SYMTAB_VALUE(ose_builtin_bundleFromBottom), -1, -1},
+    {""}, {""}, {""},
+#line 190 "ose_symtab.gperf"
+    {"/eql", OSE_SYMTAB_VALUE(ose_builtin_eql), 2, 1},
+#line 171 "ose_symtab.gperf"
+    {"/dict/put", OSE_SYMTAB_VALUE(ose_builtin_dictPut), -1, -1},
     {""}, {""},
-#line 136 "ose_symtab.gperf"
-    {"/trim/string/end", OSE_SYMTAB_VALUE(ose_builtin_trimStringEnd)},
-#line 222 "ose_symtab.gperf"
-    {"/b", OSE_SYMTAB_VALUE(OSEVM_TOBLOB)},
+#line 149 "ose_symtab.gperf"
+    {"/swap/order/blob/64", OSE_SYMTAB_VALUE(ose_builtin_swapBlobByteOrder64), -1, -1},
+    {""},
+#line 91 "ose_symtab.gperf"
+    {"/bundle/fromtop", OSE_SYMTAB_VALUE(ose_builtin_bundleFromTop), -1, -1},
+    {""},
+#line 234 "ose_symtab.gperf"
+    {"/appendtocontextbundle", OSE_SYMTAB_VALUE(ose_builtin_appendToContextBundle), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""}, {""},
+#line 170 "ose_symtab.gperf"
+    {"/dict/get", OSE_SYMTAB_VALUE(ose_builtin_dictGet), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""},
+#line 218 "ose_symtab.gperf"
+    {"/append/bundle", OSE_SYMTAB_VALUE(ose_builtin_appendBundle), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""},
+#line 139 "ose_symtab.gperf"
+    {"/elem/toblob", OSE_SYMTAB_VALUE(ose_builtin_elemToBlob), 1, 1},
+    {""},
+#line 185 "ose_symtab.gperf"
+    {"/mul", OSE_SYMTAB_VALUE(ose_builtin_mul), 2, 1},
+    {""},
+#line 200 "ose_symtab.gperf"
+    {"/is/type/known", OSE_SYMTAB_VALUE(ose_builtin_isKnownTypetag), 1, 1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""}, {""}, {""}, {""},
-#line 116 "ose_symtab.gperf"
-    {"/blob/totype", OSE_SYMTAB_VALUE(ose_builtin_blobToType)},
+#line 97 "ose_symtab.gperf"
+    {"/pop/all", OSE_SYMTAB_VALUE(ose_builtin_popAll), -1, -1},
+    {""}, {""}, {""}, {""}, {""},
+#line 105 "ose_symtab.gperf"
+    {"/unpack/bundle", OSE_SYMTAB_VALUE(ose_builtin_unpackBundle), -1, -1},
+    {""}, {""}, {""},
+#line 99 "ose_symtab.gperf"
+    {"/pop/all/bundle", OSE_SYMTAB_VALUE(ose_builtin_popAllBundle), -1, -1},
+#line 106 "ose_symtab.gperf"
+    {"/unpack/drop/bundle", OSE_SYMTAB_VALUE(ose_builtin_unpackDropBundle), -1, -1},
+#line 204 "ose_symtab.gperf"
+    {"/is/type/numeric", OSE_SYMTAB_VALUE(ose_builtin_isNumericType), 1, 1},
+#line 199 "ose_symtab.gperf"
+    {"/is/addresschar", OSE_SYMTAB_VALUE(ose_builtin_isAddressChar), 1, 1},
+    {""},
+#line 100 "ose_symtab.gperf"
+    {"/pop/all/drop/bundle", OSE_SYMTAB_VALUE(ose_builtin_popAllDropBundle), -1, -1},
+    {""}, {""}, {""}, {""},
+#line 206 "ose_symtab.gperf"
+    {"/is/type/bool", OSE_SYMTAB_VALUE(ose_builtin_isBoolType), 1, 1},
+#line 232 "ose_symtab.gperf"
+    {"/quote", OSE_SYMTAB_VALUE(ose_builtin_quote), 0, 0},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""}, {""},
-#line 158 "ose_symtab.gperf"
-    {"/div", OSE_SYMTAB_VALUE(ose_builtin_div)},
-#line 65 "ose_symtab.gperf"
-    {"/over", OSE_SYMTAB_VALUE(ose_builtin_over)},
-    {""}, {""}, {""}, {""},
+#line 231 "ose_symtab.gperf"
+    {"/funcall", OSE_SYMTAB_VALUE(ose_builtin_funcall), -1, -1},
+    {""},
+#line 236 "ose_symtab.gperf"
+    {"/moveelemtocontextbundle", OSE_SYMTAB_VALUE(ose_builtin_moveElemToContextBundle), -1, -1},
+#line 226 "ose_symtab.gperf"
+    {"/version", OSE_SYMTAB_VALUE(ose_builtin_version), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 128 "ose_symtab.gperf"
+    {"/blob/totype", OSE_SYMTAB_VALUE(ose_builtin_blobToType), -1, -1},
+    {""}, {""}, {""}, {""}, {""},
 #line 89 "ose_symtab.gperf"
-    {"/push", OSE_SYMTAB_VALUE(ose_builtin_push)},
+    {"/bundle/all", OSE_SYMTAB_VALUE(ose_builtin_bundleAll), -1, -1},
+    {""},
+#line 157 "ose_symtab.gperf"
+    {"/replace", OSE_SYMTAB_VALUE(ose_builtin_replace), -1, -1},
     {""}, {""}, {""}, {""}, {""},
-#line 68 "ose_symtab.gperf"
-    {"/pick/match", OSE_SYMTAB_VALUE(ose_builtin_pickMatch)},
+#line 136 "ose_symtab.gperf"
+    {"/decat/blob/fromstart", OSE_SYMTAB_VALUE(ose_builtin_decatenateBlobFromStart), -1, -1},
 #line 219 "ose_symtab.gperf"
-    {"/i", OSE_SYMTAB_VALUE(OSEVM_TOINT32)},
+    {"/replace/bundle", OSE_SYMTAB_VALUE(ose_builtin_replaceBundle), -1, -1},
+    {""},
+#line 135 "ose_symtab.gperf"
+    {"/decat/blob/fromend", OSE_SYMTAB_VALUE(ose_builtin_decatenateBlobFromEnd), -1, -1},
     {""}, {""}, {""},
-#line 138 "ose_symtab.gperf"
-    {"/match", OSE_SYMTAB_VALUE(ose_builtin_match)},
-#line 115 "ose_symtab.gperf"
-    {"/blob/toelem", OSE_SYMTAB_VALUE(ose_builtin_blobToElem)},
-#line 187 "ose_symtab.gperf"
-    {"/if", OSE_SYMTAB_VALUE(ose_builtin_if)},
-#line 157 "ose_symtab.gperf"
-    {"/mul", OSE_SYMTAB_VALUE(ose_builtin_mul)},
-#line 186 "ose_symtab.gperf"
-    {"/exec", OSE_SYMTAB_VALUE(ose_builtin_exec)},
+#line 235 "ose_symtab.gperf"
+    {"/replacecontextbundle", OSE_SYMTAB_VALUE(ose_builtin_replaceContextBundle), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+#line 241 "ose_symtab.gperf"
+    {"/appendbyte", OSE_SYMTAB_VALUE(ose_builtin_appendByte), -1, -1},
     {""},
-#line 185 "ose_symtab.gperf"
-    {"/exec1c", OSE_SYMTAB_VALUE(ose_builtin_exec1c)},
-    {""}, {""}, {""}, {""},
-#line 91 "ose_symtab.gperf"
-    {"/unpack", OSE_SYMTAB_VALUE(ose_builtin_unpack)},
-    {""}, {""}, {""}, {""}, {""}, {""},
-#line 208 "ose_symtab.gperf"
-    {"/tostring", OSE_SYMTAB_VALUE(ose_builtin_toString)},
-#line 74 "ose_symtab.gperf"
-    {"/tuck", OSE_SYMTAB_VALUE(ose_builtin_tuck)},
-    {""}, {""}, {""}, {""},
-#line 171 "ose_symtab.gperf"
-    {"/is/addresschar", OSE_SYMTAB_VALUE(ose_builtin_isAddressChar)},
+#line 178 "ose_symtab.gperf"
+    {"/make/bundle", OSE_SYMTAB_VALUE(ose_builtin_pushBundle), 0, 1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""},
+#line 224 "ose_symtab.gperf"
+    {"/map/parallel", OSE_SYMTAB_VALUE(ose_builtin_mapParallel), -1, -1},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""},
-#line 199 "ose_symtab.gperf"
-    {"/lookupinenv", OSE_SYMTAB_VALUE(ose_builtin_lookupInEnv)},
-    {""}, {""}, {""}, {""}, {""}, {""},
 #line 172 "ose_symtab.gperf"
-    {"/is/type/known", OSE_SYMTAB_VALUE(ose_builtin_isKnownTypetag)},
-    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
-#line 197 "ose_symtab.gperf"
-    {"/version", OSE_SYMTAB_VALUE(ose_builtin_version)},
-    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
-#line 150 "ose_symtab.gperf"
-    {"/make/bundle", OSE_SYMTAB_VALUE(ose_builtin_pushBundle)},
-    {""},
-#line 93 "ose_symtab.gperf"
-    {"/unpack/bundle", OSE_SYMTAB_VALUE(ose_builtin_unpackBundle)},
-    {""}, {""}, {""}, {""},
-#line 94 "ose_symtab.gperf"
-    {"/unpack/drop/bundle", OSE_SYMTAB_VALUE(ose_builtin_unpackDropBundle)},
+    {"/dict/delete", OSE_SYMTAB_VALUE(ose_builtin_dictDelete), -1, -1},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
-#line 92 "ose_symtab.gperf"
-    {"/unpack/drop", OSE_SYMTAB_VALUE(ose_builtin_unpackDrop)},
+#line 179 "ose_symtab.gperf"
+    {"/push/blob", OSE_SYMTAB_VALUE(ose_builtin_makeBlob), 1, 1},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
-    {""}, {""}, {""}, {""}, {""},
-#line 176 "ose_symtab.gperf"
-    {"/is/type/numeric", OSE_SYMTAB_VALUE(ose_builtin_isNumericType)},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
-#line 78 "ose_symtab.gperf"
-    {"/bundle/all", OSE_SYMTAB_VALUE(ose_builtin_bundleAll)},
+    {""},
+#line 164 "ose_symtab.gperf"
+    {"/peephole", OSE_SYMTAB_VALUE(ose_builtin_peephole), -1, -1},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
     {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
-    {""}, {""}, {""}, {""}, {""},
-#line 80 "ose_symtab.gperf"
-    {"/bundle/fromtop", OSE_SYMTAB_VALUE(ose_builtin_bundleFromTop)},
-    {""}, {""}, {""}, {""}, {""}, {""}, {""},
-#line 79 "ose_symtab.gperf"
-    {"/bundle/frombottom", OSE_SYMTAB_VALUE(ose_builtin_bundleFromBottom)}
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+    {""}, {""},
+#line 151 "ose_symtab.gperf"
+    {"/decompress/blob", OSE_SYMTAB_VALUE(ose_builtin_decompressBlob), 1, 1}
   };
 
 const struct _ose_symtab_rec *
@@ -517,17 +640,110 @@ _ose_symtab_lookup (str, len)
     }
   return 0;
 }
-#line 225 "ose_symtab.gperf"
+#line 256 "ose_symtab.gperf"
+
+
+/*
+ * Runtime registry for functions that aren't known at compile time,
+ * such as those provided by libraries loaded with ose_loadLib. This
+ * is an open-addressed table with linear probing. Names are not
+ * copied, and must remain valid for as long as they are registered.
+ *
+ * The table isn't locked. Lookups read it from every VM, including
+ * the worker VMs of /map/parallel and VMs run by the parallel route
+ * functions, so all registration has to be done before any VM is run
+ * on another thread.
+ */
+static struct _ose_symtab_registry_rec {
+	const char *name;
+	uint32_t hash;
+	void (*f)(ose_bundle);
+} _ose_symtab_registry[OSE_SYMTAB_REGISTRY_SIZE];
+static int _ose_symtab_registry_count;
 
+static uint32_t _ose_symtab_registry_hash(const char * const str)
+{
+	/* FNV-1a */
+	uint32_t h = 2166136261u;
+	const unsigned char *p = (const unsigned char *)str;
+	while(*p){
+		h ^= *p++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static struct _ose_symtab_registry_rec *
+_ose_symtab_registry_find(const char * const str, uint32_t h)
+{
+	uint32_t i = h & (OSE_SYMTAB_REGISTRY_SIZE - 1);
+	int n = 0;
+	while(n++ < OSE_SYMTAB_REGISTRY_SIZE){
+		struct _ose_symtab_registry_rec *r = _ose_symtab_registry + i;
+		if(!r->name
+		   || (r->hash == h && !strcmp(r->name, str))){
+			return r;
+		}
+		i = (i + 1) & (OSE_SYMTAB_REGISTRY_SIZE - 1);
+	}
+	return NULL;
+}
+
+int ose_symtab_register(const char * const str, void (*f)(ose_bundle))
+{
+	const uint32_t h = _ose_symtab_registry_hash(str);
+	struct _ose_symtab_registry_rec *r = _ose_symtab_registry_find(str, h);
+	if(!r){
+		return -1;
+	}
+	if(!r->name){
+		if(_ose_symtab_registry_count
+		   >= OSE_SYMTAB_REGISTRY_SIZE - 1){
+			/* keep one slot empty so that lookups terminate */
+			return -1;
+		}
+		_ose_symtab_registry_count++;
+		r->name = str;
+		r->hash = h;
+	}
+	r->f = f;
+	return 0;
+}
 
 void (*ose_symtab_lookup_fn(const char * const str))(ose_bundle)
 {
 	const struct _ose_symtab_rec *r = _ose_symtab_lookup(str, strlen(str));
 	if(r){
 		return r->f;
-	}else{
-		return NULL;
+	}else if(_ose_symtab_registry_count){
+		const struct _ose_symtab_registry_rec *rr =
+			_ose_symtab_registry_find(str,
+						  _ose_symtab_registry_hash(str));
+		if(rr && rr->name){
+			return rr->f;
+		}
 	}
+	return NULL;
+}
+
+int ose_symtab_lookup_effect(const char * const str, int *in, int *out)
+{
+	const struct _ose_symtab_rec *r = _ose_symtab_lookup(str, strlen(str));
+	if(r && r->in >= 0){
+		*in = r->in;
+		*out = r->out;
+		return 0;
+	}
+	return -1;
+}
+
+void (*ose_symtab_lookup_unchecked(const char * const str))(ose_bundle)
+{
+	const struct _ose_symtab_rec *r = _ose_symtab_lookup(str, strlen(str));
+	if(r){
+		return r->uf;
+	}
+	return NULL;
 }
 
 #ifdef OSE_SYMTAB_FNSYMS
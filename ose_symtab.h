@@ -26,7 +26,22 @@ SOFTWARE.
 extern "C" {
 #endif
 
+#ifndef OSE_SYMTAB_REGISTRY_SIZE
+/* must be a power of 2 */
+#define OSE_SYMTAB_REGISTRY_SIZE 256
+#endif
+
 void (*ose_symtab_lookup_fn(const char * const str))(ose_bundle);
+/* returns 0 on success, -1 if the registry is full. The registry
+   isn't locked, so this must not be called while VMs are running on
+   other threads. */
+int ose_symtab_register(const char * const str, void (*f)(ose_bundle));
+/* returns 0 and the stack effect of a builtin, or -1 if it isn't
+   known, or the function was registered at runtime */
+int ose_symtab_lookup_effect(const char * const str, int *in, int *out);
+/* the variant of a builtin that doesn't check that the stack has the
+   elements it needs, or NULL if there isn't one */
+void (*ose_symtab_lookup_unchecked(const char * const str))(ose_bundle);
 #ifdef OSE_SYMTAB_FNSYMS
 char *ose_symtab_lookup_fnsym(const char * const str);
 #endif
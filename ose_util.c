@@ -29,6 +29,10 @@
 #include "ose_util.h"
 #include "ose_match.h"
 
+/* nonzero iff one of the four bytes of w is 0 */
+#define OSE_WORD_HASZERO(w)                                 \
+    (((w) - (uint32_t)0x01010101UL) & ~(w) & (uint32_t)0x80808080UL)
+
 int32_t ose_pstrlen(const char * const s)
 {
     ose_assert(s);
@@ -101,7 +105,7 @@ bool ose_isKnownTypetag(const char typetag)
         return true;
 #endif
 #ifdef OSE_PROVIDE_TYPE_TRUE
-    case true:
+    case OSETT_TRUE:
         return true;
 #endif
 #ifdef OSE_PROVIDE_TYPE_FALSE
@@ -943,6 +947,78 @@ int32_t ose_getFirstOffsetForMatch(ose_constbundle bundle,
     }
 }
 
+#ifdef OSE_DEBUG
+/* true if the bytes after the terminator, up to the end of its
+   word, are all 0 */
+static bool isNullPadded(const char * const s)
+{
+    const int32_t n = strlen(s);
+    int32_t i;
+    for(i = n; i < ose_pnbytes(n); i++)
+    {
+        if(s[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+bool ose_paddedStringsEqual(const char * const s1,
+                            const char * const s2)
+{
+    ose_assert(s1);
+    ose_assert(s2);
+    ose_assert(isNullPadded(s1));
+    ose_assert(isNullPadded(s2));
+    {
+        int32_t i = 0;
+        while(1)
+        {
+            uint32_t w1, w2;
+            memcpy(&w1, s1 + i, 4);
+            memcpy(&w2, s2 + i, 4);
+            if(w1 != w2)
+            {
+                return false;
+            }
+            /* both strings end in this word */
+            if(OSE_WORD_HASZERO(w1))
+            {
+                return true;
+            }
+            i += 4;
+        }
+    }
+}
+
+int32_t ose_getFirstOffsetForPaddedMatch(ose_constbundle bundle,
+                                         const char * const addr)
+{
+    ose_assert(ose_getBundlePtr(bundle));
+    ose_assert(ose_isBundle(bundle));
+    ose_assert(addr);
+    ose_assert(isNullPadded(addr));
+    {
+        const char * const b = ose_getBundlePtr(bundle);
+        int32_t o = OSE_BUNDLE_HEADER_LEN;
+        const int32_t s = ose_readSize(bundle);
+        ose_assert(s >= OSE_BUNDLE_HEADER_LEN);
+        while(o < s)
+        {
+            const int32_t ss = ose_readInt32(bundle, o);
+            ose_assert(ss > 0);
+            if(ose_paddedStringsEqual(addr, b + o + 4))
+            {
+                return o;
+            }
+            o += ss + 4;
+        }
+        return 0;
+    }
+}
+
 int32_t ose_getFirstOffsetForPMatch(ose_constbundle bundle,
                                     const char * const addr)
 {
@@ -1509,6 +1585,240 @@ int32_t ose_writeMessage(ose_bundle bundle,
     return ms;
 }
 
+/*
+  Bulk byte order conversion.
+
+  The loops below are written so that gcc and clang recognise the
+  shift-and-mask expression as a byte swap and vectorise the loop
+  (pshufb / vrev) at -O2 and above, while remaining portable C89.
+*/
+#define OSE_BSWAP32(w)                                  \
+    ((((w) & (uint32_t)0x000000ffUL) << 24)             \
+     | (((w) & (uint32_t)0x0000ff00UL) << 8)            \
+     | (((w) & (uint32_t)0x00ff0000UL) >> 8)            \
+     | (((w) & (uint32_t)0xff000000UL) >> 24))
+
+void ose_swapByteOrder32(char * const ptr, const int32_t n)
+{
+    ose_assert(ptr || n == 0);
+    ose_assert(n >= 0);
+    if(ose_htonl(1) == 1)
+    {
+        return;
+    }
+    {
+        int32_t i;
+        for(i = 0; i < n; i++)
+        {
+            uint32_t w;
+            memcpy(&w, ptr + (i * 4), 4);
+            w = OSE_BSWAP32(w);
+            memcpy(ptr + (i * 4), &w, 4);
+        }
+    }
+}
+
+void ose_swapByteOrder64(char * const ptr, const int32_t n)
+{
+    ose_assert(ptr || n == 0);
+    ose_assert(n >= 0);
+    if(ose_htonl(1) == 1)
+    {
+        return;
+    }
+    {
+        int32_t i;
+        for(i = 0; i < n; i++)
+        {
+            uint32_t w[2], t;
+            memcpy(w, ptr + (i * 8), 8);
+            t = OSE_BSWAP32(w[0]);
+            w[0] = OSE_BSWAP32(w[1]);
+            w[1] = t;
+            memcpy(ptr + (i * 8), w, 8);
+        }
+    }
+}
+
+/*
+  Packet validation.
+
+  These functions walk an untrusted OSC packet once, from front to
+  back, and never read outside of [p, p + n). Strings are scanned a
+  word at a time, so only the word holding the terminator needs to
+  be looked at bytewise.
+*/
+
+static int32_t readUnalignedInt32(const char * const p)
+{
+    int32_t i;
+    memcpy(&i, p, 4);
+    return ose_ntohl(i);
+}
+
+/* returns the padded length of the string, or -1 */
+static int32_t validateString(const char * const p, const int32_t n)
+{
+    int32_t i;
+    for(i = 0; i + 4 <= n; i += 4)
+    {
+        uint32_t w;
+        memcpy(&w, p + i, 4);
+        if(OSE_WORD_HASZERO(w))
+        {
+            int32_t j = i;
+            while(p[j])
+            {
+                j++;
+            }
+            for( ; j < i + 4; j++)
+            {
+                if(p[j])
+                {
+                    return -1;
+                }
+            }
+            return i + 4;
+        }
+    }
+    return -1;
+}
+
+static bool validateBundle(const char * const p, const int32_t n);
+
+static bool validateMessage(const char * const p, const int32_t n)
+{
+    int32_t ao, tl, po, i;
+    const char *tt;
+    if(n < OSE_ADDRESS_MIN_PLEN || n % 4)
+    {
+        return false;
+    }
+    ao = validateString(p, n);
+    if(ao < 0 || ao >= n || p[ao] != OSETT_ID)
+    {
+        return false;
+    }
+    tl = validateString(p + ao, n - ao);
+    if(tl < 0)
+    {
+        return false;
+    }
+    tt = p + ao + 1;
+    po = ao + tl;
+    for(i = 0; tt[i]; i++)
+    {
+        const char c = tt[i];
+        int32_t s;
+        if(!ose_isKnownTypetag(c) || c == OSETT_ID)
+        {
+            return false;
+        }
+        switch(c)
+        {
+        case OSETT_STRING:
+#ifdef OSE_PROVIDE_TYPE_SYMBOL
+        case OSETT_SYMBOL:
+#endif
+            s = validateString(p + po, n - po);
+            if(s < 0)
+            {
+                return false;
+            }
+            break;
+        case OSETT_BLOB:
+        {
+            int32_t bs, j;
+            if(n - po < 4)
+            {
+                return false;
+            }
+            bs = readUnalignedInt32(p + po);
+            if(bs < 0 || bs > n - po - 4)
+            {
+                return false;
+            }
+            s = 4 + bs + ose_getBlobPaddingForNBytes(bs);
+            if(s > n - po)
+            {
+                return false;
+            }
+            for(j = 4 + bs; j < s; j++)
+            {
+                if(p[po + j])
+                {
+                    return false;
+                }
+            }
+        }
+            break;
+        default:
+            s = ose_getTypedDatumSize(c, NULL);
+            if(s > n - po)
+            {
+                return false;
+            }
+        }
+        po += s;
+    }
+    return po == n;
+}
+
+static bool validateBundle(const char * const p, const int32_t n)
+{
+    int32_t o = OSE_BUNDLE_HEADER_LEN;
+    if(n < OSE_BUNDLE_HEADER_LEN
+       || n % 4
+       || memcmp(p, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+    {
+        return false;
+    }
+    while(o < n)
+    {
+        int32_t s;
+        if(n - o < 4)
+        {
+            return false;
+        }
+        s = readUnalignedInt32(p + o);
+        if(s <= 0 || s % 4 || s > n - o - 4)
+        {
+            return false;
+        }
+        if(s >= OSE_BUNDLE_ID_LEN
+           && !memcmp(p + o + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+        {
+            if(!validateBundle(p + o + 4, s))
+            {
+                return false;
+            }
+        }
+        else if(!validateMessage(p + o + 4, s))
+        {
+            return false;
+        }
+        o += s + 4;
+    }
+    return true;
+}
+
+bool ose_validatePacket(const char * const packet, const int32_t size)
+{
+    if(!packet || size <= 0)
+    {
+        return false;
+    }
+    if(size >= OSE_BUNDLE_ID_LEN
+       && !memcmp(packet, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+    {
+        return validateBundle(packet, size);
+    }
+    else
+    {
+        return validateMessage(packet, size);
+    }
+}
+
 struct ose_SLIPBuf ose_initSLIPBuf(unsigned char *buf,
                                    int32_t buflen)
 {
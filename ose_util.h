@@ -276,6 +276,39 @@ int32_t ose_getBundleElemPayloadOffset(ose_constbundle bundle,
 int32_t ose_getFirstOffsetForMatch(ose_constbundle bundle,
                                    const char * const addr);
 
+/**
+   @brief Test two NULL-padded strings for equality a word at a time.
+
+   Both strings must be padded with NULL bytes to a multiple of 4
+   bytes, as all strings inside of a bundle are. The comparison
+   stops at the word containing the terminator, so neither string is
+   read past its padding.
+
+   @param s1 The first string.
+   @param s2 The second string.
+   @returns #true if the strings are identical, #false otherwise.
+ */
+bool ose_paddedStringsEqual(const char * const s1,
+                            const char * const s2);
+
+/**
+   	@brief Get the offset of the first element whose address
+   	is identical to addr.
+
+	This is equivalent to #ose_getFirstOffsetForMatch, but addr
+	must be NULL-padded (for example, a string that lives in a
+	bundle), which allows the addresses to be compared a word at a
+	time.
+
+	@param bundle Bundle containing elements to test.
+	@param addr NULL-padded address to test against the elements of
+	the bundle.
+	@returns The offset in bytes of the first match, or 0 if no
+	match was found.
+ */
+int32_t ose_getFirstOffsetForPaddedMatch(ose_constbundle bundle,
+                                         const char * const addr);
+
 /**
    	@brief Get the offset of the first element whose address
    	matches addr, using OSC pattern matching syntax.
@@ -515,6 +548,63 @@ int32_t ose_vwriteMessage(ose_bundle bundle,
                           int32_t n,
                           va_list ap);
 
+
+
+
+
+/**
+   @brief Convert an array of 32-bit values between network and
+   host byte order in place.
+
+   The conversion is its own inverse, so the same function is used
+   in both directions. On big-endian hosts it does nothing. The
+   pointer does not need to be aligned.
+
+   @param ptr Pointer to the first value.
+   @param n The number of 4-byte values to convert.
+*/
+void ose_swapByteOrder32(char * const ptr, int32_t n);
+
+
+
+
+
+/**
+   @brief Convert an array of 64-bit values between network and
+   host byte order in place.
+
+   @see #ose_swapByteOrder32
+
+   @param ptr Pointer to the first value.
+   @param n The number of 8-byte values to convert.
+*/
+void ose_swapByteOrder64(char * const ptr, int32_t n);
+
+
+
+
+
+/**
+   @brief Validate an OSC packet received from an untrusted source.
+
+   The packet is checked in a single linear pass: element sizes are
+   positive, multiples of 4, and fit inside their enclosing bundle;
+   addresses and typetag strings are NULL-terminated and
+   NULL-padded; every typetag is known; blob sizes fit and their
+   padding is zeroed; and the payload of every message ends exactly
+   where its size says it does. Nested bundles are validated
+   recursively. No byte outside of the packet is ever read.
+
+   A packet that passes can be handed to the rest of the library,
+   whose release-build functions perform no checks of their own.
+
+   @param packet A pointer to the packet (a message or a bundle,
+   without a leading size field).
+   @param size The size of the packet in bytes.
+   @returns #true if the packet is well formed, #false otherwise.
+*/
+bool ose_validatePacket(const char * const packet, int32_t size);
+
 #define OSE_SLIP_END 0300
 #define OSE_SLIP_ESC 0333
 #define OSE_SLIP_ESC_END 0334
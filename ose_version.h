@@ -0,0 +1,2 @@
+#define OSE_VERSION "3defd0d-dirty"
+#define OSE_DATE_COMPILED "Sun Oct 18 12:05:11 UTC 2026"
@@ -651,58 +651,43 @@ ose_bundle osevm_init(ose_bundle bundle)
     ose_bundle vm_c = ose_enter(bundle, OSEVM_ADDR_CONTROL);
     ose_bundle vm_d = ose_enter(bundle, OSEVM_ADDR_DUMP);
     ose_bundle vm_o = ose_enter(bundle, OSEVM_ADDR_OUTPUT);
-    ose_pushMessage(vm_cache,
-                    OSE_ADDRESS_ANONVAL,
-                    OSE_ADDRESS_ANONVAL_LEN,
-                    30,
-                    OSETT_INT32,
-                    7,
-                    OSETT_INT32,
-                    0,
-                    OSETT_INT32,
-                    ose_getBundlePtr(vm_i) - ose_getBundlePtr(bundle),
-                    OSETT_INT32,
-                    ose_getBundlePtr(vm_s) - ose_getBundlePtr(bundle),
-                    OSETT_INT32,
-                    ose_getBundlePtr(vm_e) - ose_getBundlePtr(bundle),
-                    OSETT_INT32,
-                    ose_getBundlePtr(vm_c) - ose_getBundlePtr(bundle),
-                    OSETT_INT32,
-                    ose_getBundlePtr(vm_d) - ose_getBundlePtr(bundle),
-                    OSETT_INT32,
-                    ose_getBundlePtr(vm_o) - ose_getBundlePtr(bundle),
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0, OSETT_INT32, 0, OSETT_INT32, 0,
-                    OSETT_INT32, 0);
+    {
+        /* the cache is a message of OSEVM_CACHE_SIZE ints, which
+           start out as 0. It's built in place, since it exactly
+           fills its context. */
+        const int32_t s = OSE_ADDRESS_ANONVAL_SIZE
+            + OSEVM_CACHE_TT_SIZE + OSEVM_CACHE_SIZE * 4;
+        const int32_t o = ose_readSize(vm_cache);
+        char *b;
+        ose_addToSize(vm_cache, s + 4);
+        b = ose_getBundlePtr(vm_cache);
+        memset(b + o, 0, s + 4);
+        ose_writeInt32(vm_cache, o, s);
+        memcpy(b + o + 4, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_LEN);
+        b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE] = OSETT_ID;
+        memset(b + o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 1,
+               OSETT_INT32, OSEVM_CACHE_SIZE);
+    }
+    ose_writeInt32(bundle, OSEVM_CACHE_POINTER, 7);
+    ose_writeInt32(bundle, OSEVM_CACHE_OFFSET_INPUT,
+                   ose_getBundlePtr(vm_i) - ose_getBundlePtr(bundle));
+    ose_writeInt32(bundle, OSEVM_CACHE_OFFSET_STACK,
+                   ose_getBundlePtr(vm_s) - ose_getBundlePtr(bundle));
+    ose_writeInt32(bundle, OSEVM_CACHE_OFFSET_ENV,
+                   ose_getBundlePtr(vm_e) - ose_getBundlePtr(bundle));
+    ose_writeInt32(bundle, OSEVM_CACHE_OFFSET_CONTROL,
+                   ose_getBundlePtr(vm_c) - ose_getBundlePtr(bundle));
+    ose_writeInt32(bundle, OSEVM_CACHE_OFFSET_DUMP,
+                   ose_getBundlePtr(vm_d) - ose_getBundlePtr(bundle));
+    ose_writeInt32(bundle, OSEVM_CACHE_OFFSET_OUTPUT,
+                   ose_getBundlePtr(vm_o) - ose_getBundlePtr(bundle));
     return bundle;
 }
 
-static void applyControl(ose_bundle osevm, char *address)
+/* applies the control word str */
+static void applyWord(ose_bundle osevm, const char * const str)
 {
     ose_bundle vm_s = OSEVM_STACK(osevm);
-    ose_bundle vm_c = OSEVM_CONTROL(osevm);
-
-    if(ose_peekType(vm_c) == OSETT_MESSAGE)
-    {
-        char t = ose_peekMessageArgType(vm_c);
-        if(!ose_isStringType(t))
-        {
-            ose_copyElem(vm_c, vm_s);
-            return;
-        }
-    }
-    else
-    {
-        ose_copyElem(vm_c, vm_s);
-        return;
-    }
-
-    const char * const str = ose_peekString(vm_c);
     route_init(str, a);
 
     if(route_pfx(a, OSEVM_TOK_AT, 1))
@@ -783,6 +768,28 @@ static void applyControl(ose_bundle osevm, char *address)
     }
 }
 
+static void applyControl(ose_bundle osevm, char *address)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    ose_bundle vm_c = OSEVM_CONTROL(osevm);
+
+    if(ose_peekType(vm_c) == OSETT_MESSAGE)
+    {
+        char t = ose_peekMessageArgType(vm_c);
+        if(!ose_isStringType(t))
+        {
+            ose_copyElem(vm_c, vm_s);
+            return;
+        }
+    }
+    else
+    {
+        ose_copyElem(vm_c, vm_s);
+        return;
+    }
+    applyWord(osevm, ose_peekString(vm_c));
+}
+
 static void popAllControl(ose_bundle osevm)
 {
     ose_bundle vm_c = OSEVM_CONTROL(osevm);
@@ -869,14 +876,68 @@ char osevm_step(ose_bundle osevm)
     }
 }
 
-void osevm_run(ose_bundle osevm)
+#ifdef OSE_CONF_PROFILE
+static uint64_t readCache64(ose_bundle osevm, int32_t o)
+{
+    return ((uint64_t)(uint32_t)ose_readInt32(osevm, o) << 32)
+        | (uint32_t)ose_readInt32(osevm, o + 4);
+}
+
+static void writeCache64(ose_bundle osevm, int32_t o, uint64_t v)
+{
+    ose_writeInt32(osevm, o, (int32_t)(v >> 32));
+    ose_writeInt32(osevm, o + 4, (int32_t)(v & 0xffffffff));
+}
+
+/* adds the time a run has accumulated to the VM's total */
+static void addApplyTime(ose_bundle osevm,
+                         const struct ose_timestat * const t)
+{
+    writeCache64(osevm, OSEVM_CACHE_APPLY_TICKS,
+                 readCache64(osevm, OSEVM_CACHE_APPLY_TICKS) + t->ticks);
+    writeCache64(osevm, OSEVM_CACHE_APPLY_COUNT,
+                 readCache64(osevm, OSEVM_CACHE_APPLY_COUNT) + t->count);
+}
+
+void osevm_getApplyTime(ose_bundle osevm, struct ose_timestat *stat)
+{
+    stat->ticks = readCache64(osevm, OSEVM_CACHE_APPLY_TICKS);
+    stat->count = readCache64(osevm, OSEVM_CACHE_APPLY_COUNT);
+}
+#endif
+
+/* called after the control element on top has been applied: checks
+   the status, raising an exception if it failed, and drops it */
+static void endControl(ose_bundle osevm)
 {
-    ose_bundle vm_i = OSEVM_INPUT(osevm);
     ose_bundle vm_s = OSEVM_STACK(osevm);
     ose_bundle vm_c = OSEVM_CONTROL(osevm);
+    /* check status and drop into */
+    /* debugger if necessary */
+    enum ose_errno e = ose_errno_get(osevm);
+    if(e)
+    {
+        ose_errno_set(osevm, OSE_ERR_NONE);
+        ose_pushInt32(vm_s, e);
+        ose_pushString(vm_c, "/!/exception");
+        ose_pushString(vm_c, "");
+    }
+    if(ose_bundleHasAtLeastNElems(vm_c, 1))
+    {
+        ose_drop(vm_c);
+    }
+}
+
+/* runs until input and control are empty, and the dump has been
+   returned down to depth n, or until the VM is suspended */
+static void run(ose_bundle osevm, int32_t n)
+{
+    ose_bundle vm_i = OSEVM_INPUT(osevm);
+    ose_bundle vm_c = OSEVM_CONTROL(osevm);
     ose_bundle vm_d = OSEVM_DUMP(osevm);
-    int32_t n = ose_getBundleElemCount(vm_d);
-    OSEVM_PREINPUT(osevm);
+#ifdef OSE_CONF_PROFILE
+    struct ose_timestat applytime = {0, 0};
+#endif
     while(1)
     {
         while(1)
@@ -900,20 +961,18 @@ void osevm_run(ose_bundle osevm)
                 {
                     break;
                 }
-                applyControl(osevm, ose_peekAddress(vm_c));
-                /* check status and drop into */
-                /* debugger if necessary */
-                enum ose_errno e = ose_errno_get(osevm);
-                if(e)
+                OSE_TIMED(applytime)
                 {
-                    ose_errno_set(osevm, OSE_ERR_NONE);
-                    ose_pushInt32(vm_s, e);
-                    ose_pushString(vm_c, "/!/exception");
-                    ose_pushString(vm_c, "");
+                    applyControl(osevm, ose_peekAddress(vm_c));
                 }
-                if(ose_bundleHasAtLeastNElems(vm_c, 1))
+                endControl(osevm);
+                if(OSEVM_IS_SUSPENDED(osevm))
                 {
-                    ose_drop(vm_c);
+                    ose_writeInt32(osevm, OSEVM_CACHE_RESUME_DEPTH, n);
+#ifdef OSE_CONF_PROFILE
+                    addApplyTime(osevm, &applytime);
+#endif
+                    return;
                 }
             }
             OSEVM_POSTCONTROL(osevm);
@@ -929,9 +988,92 @@ void osevm_run(ose_bundle osevm)
             break;
         }
     }
+#ifdef OSE_CONF_PROFILE
+    addApplyTime(osevm, &applytime);
+#endif
     OSEVM_POSTINPUT(osevm);
 }
 
+void osevm_run(ose_bundle osevm)
+{
+    ose_bundle vm_d = OSEVM_DUMP(osevm);
+    int32_t n;
+    if(OSEVM_IS_SUSPENDED(osevm))
+    {
+        osevm_resume(osevm);
+        return;
+    }
+    n = ose_getBundleElemCount(vm_d);
+    OSEVM_PREINPUT(osevm);
+    run(osevm, n);
+}
+
+void osevm_suspend(ose_bundle osevm)
+{
+    OSEVM_SET_FLAG_SUSPEND(osevm);
+}
+
+bool osevm_isSuspended(ose_bundle osevm)
+{
+    return OSEVM_IS_SUSPENDED(osevm) ? true : false;
+}
+
+/* moves the results of a packet, bundled up on the stack, to the
+   output, if they fit */
+static bool moveBatchOutput(ose_bundle osevm)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    ose_bundle vm_o = OSEVM_OUTPUT(osevm);
+    if(ose_spaceAvailable(vm_o)
+       < ose_readInt32(vm_s, OSE_BUNDLE_HEADER_LEN) + 4)
+    {
+        return false;
+    }
+    ose_moveElem(vm_s, vm_o);
+    return true;
+}
+
+/* moves the results of a packet of a batch to the output as a
+   bundle */
+static bool batchOutput(ose_bundle osevm)
+{
+    ose_bundleAll(OSEVM_STACK(osevm));
+    return moveBatchOutput(osevm);
+}
+
+bool osevm_resume(ose_bundle osevm)
+{
+    if(!OSEVM_IS_SUSPENDED(osevm))
+    {
+        if(OSEVM_GET_FLAGS(osevm) & OSEVM_FLAG_BATCH)
+        {
+            /* the results of a packet of a batch are still waiting
+               for room in the output */
+            if(!moveBatchOutput(osevm))
+            {
+                return false;
+            }
+            OSEVM_UNSET_FLAG_BATCH(osevm);
+            return true;
+        }
+        osevm_run(osevm);
+        return true;
+    }
+    OSEVM_UNSET_FLAG_SUSPEND(osevm);
+    run(osevm, ose_readInt32(osevm, OSEVM_CACHE_RESUME_DEPTH));
+    if(!OSEVM_IS_SUSPENDED(osevm)
+       && (OSEVM_GET_FLAGS(osevm) & OSEVM_FLAG_BATCH))
+    {
+        /* the packet of a batch that suspended is finished */
+        if(!batchOutput(osevm))
+        {
+            return false;
+        }
+        OSEVM_UNSET_FLAG_BATCH(osevm);
+    }
+    return true;
+}
+
 void osevm_inputMessages(ose_bundle osevm,
                          int32_t size, const char * const bundle)
 {
@@ -954,6 +1096,714 @@ void osevm_inputMessage(ose_bundle osevm,
     //ose_popAllDrop(vm_i);
 }
 
+bool osevm_inputPacket(ose_bundle osevm,
+                       int32_t size, const char * const packet)
+{
+    ose_bundle vm_i = OSEVM_INPUT(osevm);
+    const int32_t hs = 4 + OSE_ADDRESS_ANONVAL_SIZE + 4;
+    int32_t need;
+    bool isbundle;
+    if(!ose_validatePacket(packet, size))
+    {
+        return false;
+    }
+    isbundle = !strncmp(packet, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN);
+    /* the packet is pushed as a blob, and ose_blobToElem then
+       swaps the empty message it leaves behind out of the way,
+       which needs room for a copy of it */
+    need = hs + 4 + size + hs;
+    if(isbundle && need < 4 + size + size - OSE_BUNDLE_HEADER_LEN)
+    {
+        /* ose_popAllDrop copies the elements of the bundle out of
+           the way before putting them back in reverse order */
+        need = 4 + size + size - OSE_BUNDLE_HEADER_LEN;
+    }
+    if(ose_spaceAvailable(vm_i) < need)
+    {
+        return false;
+    }
+    /* the packet is well formed from here on, so the unchecked
+       paths below are safe even in release builds */
+    if(isbundle)
+    {
+        osevm_inputMessages(osevm, size, packet);
+    }
+    else
+    {
+        osevm_inputMessage(osevm, size, packet);
+    }
+    return true;
+}
+
+/* how each word of a batch program is applied */
+#define BATCH_GENERIC 0
+#define BATCH_LITERAL 1
+#define BATCH_BUILTIN 2
+
+static const ose_fn batch_funcall = OSEVM_FUNCALL;
+static const ose_fn batch_lookup = OSEVM_LOOKUP;
+
+/* decides how the word at offset o in control can be applied
+   without going through applyControl. Builtins are only called
+   directly if the lookup hasn't been replaced by a hook, and the
+   env doesn't shadow them. */
+static char batchWord(ose_bundle osevm, int32_t o, ose_fn *fn)
+{
+    ose_bundle vm_e = OSEVM_ENV(osevm);
+    ose_bundle vm_c = OSEVM_CONTROL(osevm);
+    const char * const b = ose_getBundlePtr(vm_c);
+    if(ose_getBundleElemType(vm_c, o) != OSETT_MESSAGE)
+    {
+        return BATCH_LITERAL;
+    }
+    const int32_t to = o + 4 + ose_getPaddedStringLen(vm_c, o + 4);
+    if(to >= o + 4 + ose_readInt32(vm_c, o)
+       || !b[to + 1] || b[to + 2])
+    {
+        /* no items, or more than one */
+        return BATCH_GENERIC;
+    }
+    if(!ose_isStringType(b[to + 1]))
+    {
+        return BATCH_LITERAL;
+    }
+    const char * const str = b + to + 4;
+    if(batch_funcall != ose_builtin_funcall
+       || batch_lookup != ose_builtin_lookupInEnv
+       || strncmp(str, "/!/", 3) || !str[3]
+       || ose_getFirstOffsetForMatch(vm_e, str + 2)
+       >= OSE_BUNDLE_HEADER_LEN)
+    {
+        return BATCH_GENERIC;
+    }
+    *fn = ose_symtab_lookup_fn(str + 2);
+    return *fn ? BATCH_BUILTIN : BATCH_GENERIC;
+}
+
+/* pushes the elements of the packet whose size is at p onto the
+   stack, or the packet itself if it's a message */
+static bool batchPushPacket(ose_bundle vm_s, const char * const p)
+{
+    const int32_t s = ose_ntohl(*((int32_t *)p));
+    const int32_t ss = ose_readSize(vm_s);
+    const char *src = p;
+    int32_t n = s + 4;
+    if(s >= OSE_BUNDLE_HEADER_LEN
+       && !strncmp(p + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+    {
+        src = p + 4 + OSE_BUNDLE_HEADER_LEN;
+        n = s - OSE_BUNDLE_HEADER_LEN;
+    }
+    if(ose_spaceAvailable(vm_s) < n)
+    {
+        return false;
+    }
+    ose_addToSize(vm_s, n);
+    memcpy(ose_getBundlePtr(vm_s) + ss, src, n);
+    return true;
+}
+
+int32_t osevm_runBatch(ose_bundle osevm,
+                       int32_t progsize, const char * const prog,
+                       int32_t batchsize, const char * const batch)
+{
+    ose_bundle vm_i = OSEVM_INPUT(osevm);
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    ose_bundle vm_e = OSEVM_ENV(osevm);
+    ose_bundle vm_c = OSEVM_CONTROL(osevm);
+    ose_bundle vm_d = OSEVM_DUMP(osevm);
+    ose_fn fns[OSEVM_BATCH_MAXWORDS];
+    int32_t ends[OSEVM_BATCH_MAXWORDS];
+    char kinds[OSEVM_BATCH_MAXWORDS];
+    int32_t nwords = 0, count = 0, n = 0, o;
+#ifdef OSE_CONF_PROFILE
+    struct ose_timestat applytime = {0, 0};
+#endif
+
+    if(OSEVM_IS_SUSPENDED(osevm)
+       || (OSEVM_GET_FLAGS(osevm) & OSEVM_FLAG_BATCH)
+       || !ose_bundleIsEmpty(vm_i)
+       || !ose_bundleIsEmpty(vm_c)
+       || !ose_validatePacket(batch, batchsize)
+       || strncmp(batch, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN)
+       || !osevm_inputPacket(osevm, progsize, prog))
+    {
+        return 0;
+    }
+
+    /* unpack the whole program into control, in the order that
+       running it would, and keep a copy of it in the dump, below
+       anything the program does there */
+    while(!ose_bundleIsEmpty(vm_i))
+    {
+        ose_moveElem(vm_i, vm_s);
+        ++n;
+    }
+    while(n > 0)
+    {
+        ose_moveElem(vm_s, vm_c);
+        popAllControl(osevm);
+        --n;
+    }
+    if(ose_spaceAvailable(vm_d) < ose_readSize(vm_c) + 4)
+    {
+        ose_clear(vm_c);
+        return 0;
+    }
+    const int32_t depth = ose_getBundleElemCount(vm_d);
+    ose_copyBundle(vm_c, vm_d);
+    const int32_t io = ose_getLastBundleElemOffset(vm_d);
+    const int32_t envsize = ose_readSize(vm_e);
+
+    /* decode the words once. The first word is on top, so the
+       control is in step with word i as long as that word is on
+       top of it. */
+    for(o = OSE_BUNDLE_HEADER_LEN;
+        o < ose_readSize(vm_c);
+        o += ose_readInt32(vm_c, o) + 4)
+    {
+        ++nwords;
+    }
+    n = nwords;
+    if(nwords > OSEVM_BATCH_MAXWORDS)
+    {
+        nwords = OSEVM_BATCH_MAXWORDS;
+    }
+    for(o = OSE_BUNDLE_HEADER_LEN;
+        o < ose_readSize(vm_c);
+        o += ose_readInt32(vm_c, o) + 4)
+    {
+        if(--n < nwords)
+        {
+            ends[n] = o + ose_readInt32(vm_c, o) + 4;
+            kinds[n] = batchWord(osevm, o, fns + n);
+        }
+    }
+    ose_clear(vm_c);
+
+    o = OSE_BUNDLE_HEADER_LEN;
+    while(o < batchsize)
+    {
+        const int32_t s = ose_ntohl(*((int32_t *)(batch + o)));
+        int32_t i;
+        OSEVM_PREINPUT(osevm);
+        ose_clear(vm_s);
+        if(!batchPushPacket(vm_s, batch + o))
+        {
+            break;
+        }
+        {
+            const int32_t is = ose_readInt32(vm_d, io);
+            ose_addToSize(vm_c, is - OSE_BUNDLE_HEADER_LEN);
+            memcpy(ose_getBundlePtr(vm_c) + OSE_BUNDLE_HEADER_LEN,
+                   ose_getBundlePtr(vm_d) + io + 4
+                   + OSE_BUNDLE_HEADER_LEN,
+                   is - OSE_BUNDLE_HEADER_LEN);
+        }
+        for(i = 0; i < nwords; i++)
+        {
+            const int32_t ws = ose_readSize(vm_c);
+            const int32_t wo = ose_getLastBundleElemOffset(vm_c);
+            if(ws != ends[i]
+               || memcmp(ose_getBundlePtr(vm_c) + wo,
+                         ose_getBundlePtr(vm_d) + io + 4 + wo,
+                         ws - wo))
+            {
+                /* the program has changed what's left to do */
+                break;
+            }
+            OSE_TIMED(applytime)
+            {
+                if(kinds[i] == BATCH_LITERAL)
+                {
+                    ose_copyElem(vm_c, vm_s);
+                }
+                else if(kinds[i] == BATCH_BUILTIN
+                        && ose_readSize(vm_e) == envsize)
+                {
+                    fns[i](osevm);
+                }
+                else
+                {
+                    applyControl(osevm, ose_peekAddress(vm_c));
+                }
+            }
+            endControl(osevm);
+            if(OSEVM_IS_SUSPENDED(osevm))
+            {
+                break;
+            }
+        }
+        if(!OSEVM_IS_SUSPENDED(osevm))
+        {
+            if(ose_bundleIsEmpty(vm_c))
+            {
+                OSEVM_POSTCONTROL(osevm);
+            }
+            /* finish whatever couldn't be done from the decoded
+               words */
+            run(osevm, depth + 1);
+        }
+        if(OSEVM_IS_SUSPENDED(osevm))
+        {
+            /* osevm_resume moves the results of this packet to
+               the output when it's finished */
+            ose_dropAtOffset(vm_d, io);
+            ose_writeInt32(osevm, OSEVM_CACHE_RESUME_DEPTH, depth);
+            OSEVM_SET_FLAG_BATCH(osevm);
+#ifdef OSE_CONF_PROFILE
+            addApplyTime(osevm, &applytime);
+#endif
+            return count;
+        }
+        if(!batchOutput(osevm))
+        {
+            break;
+        }
+        ++count;
+        o += s + 4;
+    }
+    ose_dropAtOffset(vm_d, io);
+#ifdef OSE_CONF_PROFILE
+    addApplyTime(osevm, &applytime);
+#endif
+    return count;
+}
+
+/* the stack effect of the control word str: the number of elements
+   it needs from the top of the stack, and the number it leaves in
+   their place. Returns false if that can't be known until it
+   runs. */
+static bool wordEffect(ose_bundle osevm, const char * const str,
+                       int *in, int *out)
+{
+    ose_bundle vm_e = OSEVM_ENV(osevm);
+    char tok[4];
+    int n = 2;
+    route_init(str, a);
+    if(route_pfx(a, OSEVM_TOK_HASH, 1))
+    {
+        *in = 0;
+        *out = 0;
+        return true;
+    }
+    else if(route_pfx(a, OSEVM_TOK_BANG, 1))
+    {
+        /* a call has the effect of the builtin it calls, as long
+           as the lookup hasn't been replaced by a hook, and the env
+           doesn't shadow it */
+        return batch_funcall == ose_builtin_funcall
+            && batch_lookup == ose_builtin_lookupInEnv
+            && str[3]
+            && ose_getFirstOffsetForMatch(vm_e, str + 2)
+            < OSE_BUNDLE_HEADER_LEN
+            && !ose_symtab_lookup_effect(str + 2, in, out);
+    }
+    else if(route_pfx(a, OSEVM_TOK_LTLT, 2))
+    {
+        n = 3;
+    }
+    else if(!route_pfx(a, OSEVM_TOK_AT, 1)
+            && !route_pfx(a, OSEVM_TOK_QUOTE, 1)
+            && !route_pfx(a, OSEVM_TOK_DOLLAR, 1)
+            && !route_pfx(a, OSEVM_TOK_GT, 1)
+            && !route_pfx(a, OSEVM_TOK_LT, 1)
+            && !route_pfx(a, OSEVM_TOK_DASH, 1)
+            && !route_pfx(a, OSEVM_TOK_i, 1)
+            && !route_pfx(a, OSEVM_TOK_f, 1)
+            && !route_pfx(a, OSEVM_TOK_s, 1)
+            && !route_pfx(a, OSEVM_TOK_b, 1))
+    {
+        /* anything else is pushed */
+        *in = 0;
+        *out = 1;
+        return true;
+    }
+    /* the rest of the word is pushed, and the function the token
+       stands for is applied to it */
+    memcpy(tok, str, n);
+    tok[n] = '\0';
+    if(ose_symtab_lookup_effect(tok, in, out))
+    {
+        return false;
+    }
+    if(*in > 0)
+    {
+        --*in;
+    }
+    else
+    {
+        ++*out;
+    }
+    return true;
+}
+
+/* the offset in the cache of the record for name, and the hash of
+   name */
+static int32_t needRecord(const char * const name, int32_t *hash)
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    const char *p = name;
+    while(*p)
+    {
+        h ^= (unsigned char)*p++;
+        h *= 16777619u;
+    }
+    *hash = (int32_t)h;
+    return OSEVM_CACHE_NEED + 16 * (h % OSEVM_CACHE_NEED_NRECORDS);
+}
+
+void osevm_recordNeed(ose_bundle osevm,
+                      const char * const name,
+                      int32_t size,
+                      int32_t hash,
+                      int32_t need)
+{
+    int32_t namehash;
+    const int32_t o = needRecord(name, &namehash);
+    if(need < 0)
+    {
+        if((int32_t)ose_readInt32(osevm, o) == namehash)
+        {
+            ose_writeInt32(osevm, o + 4, 0);
+        }
+        return;
+    }
+    ose_writeInt32(osevm, o, namehash);
+    ose_writeInt32(osevm, o + 4, size);
+    ose_writeInt32(osevm, o + 8, hash);
+    ose_writeInt32(osevm, o + 12, need);
+}
+
+int32_t osevm_lookupNeed(ose_bundle osevm,
+                         const char * const name,
+                         int32_t size,
+                         int32_t hash)
+{
+    int32_t namehash;
+    const int32_t o = needRecord(name, &namehash);
+    if(size <= 0
+       || (int32_t)ose_readInt32(osevm, o) != namehash
+       || (int32_t)ose_readInt32(osevm, o + 4) != size
+       || (int32_t)ose_readInt32(osevm, o + 8) != hash)
+    {
+        return -1;
+    }
+    return ose_readInt32(osevm, o + 12);
+}
+
+static void addEffect(int32_t *depth, int32_t *need, int in, int out)
+{
+    if(in - *depth > *need)
+    {
+        *need = in - *depth;
+    }
+    *depth += out - in;
+}
+
+int32_t osevm_verifyBody(ose_bundle osevm,
+                         ose_constbundle bundle,
+                         int32_t offset)
+{
+    ose_assert(ose_getBundleElemType(bundle, offset) == OSETT_BUNDLE);
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t end = offset + 4 + ose_readInt32(bundle, offset);
+    int32_t o = offset + 4 + OSE_BUNDLE_HEADER_LEN;
+    int32_t depth = 0, need = 0;
+    int in, out;
+    while(o < end)
+    {
+        const int32_t s = ose_readInt32(bundle, o);
+        if(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE)
+        {
+            addEffect(&depth, &need, 0, 1);
+        }
+        else
+        {
+            /* popAllControl turns a message into a word for each of
+               its items, followed by one for its address */
+            const int32_t to = o + 4 + ose_getPaddedStringLen(bundle,
+                                                              o + 4);
+            if(to < o + 4 + s)
+            {
+                int32_t po = to + ose_getPaddedStringLen(bundle, to);
+                int32_t i;
+                for(i = 1; b[to + i]; i++)
+                {
+                    const char t = b[to + i];
+                    if(!ose_isStringType(t))
+                    {
+                        addEffect(&depth, &need, 0, 1);
+                    }
+                    else if(wordEffect(osevm, b + po, &in, &out))
+                    {
+                        addEffect(&depth, &need, in, out);
+                    }
+                    else
+                    {
+                        return -1;
+                    }
+                    po += ose_getPayloadItemSize(bundle, t, po);
+                }
+            }
+            if(strncmp(b + o + 4,
+                       OSE_ADDRESS_ANONVAL,
+                       OSE_ADDRESS_ANONVAL_SIZE))
+            {
+                if(!wordEffect(osevm, b + o + 4, &in, &out))
+                {
+                    return -1;
+                }
+                addEffect(&depth, &need, in, out);
+            }
+        }
+        o += s + 4;
+    }
+    return need;
+}
+
+/* pushes the item of type t and size n at p onto the stack as a
+   message of its own, as popAllControl and applyControl would */
+static void pushItem(ose_bundle vm_s, const char t,
+                     const char * const p, const int32_t n)
+{
+    const int32_t o = ose_readSize(vm_s);
+    const int32_t s = OSE_ADDRESS_ANONVAL_SIZE + 4 + n;
+    ose_addToSize(vm_s, s + 4);
+    char *b = ose_getBundlePtr(vm_s);
+    *((int32_t *)(b + o)) = ose_htonl(s);
+    memcpy(b + o + 4, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_SIZE);
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE] = OSETT_ID;
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 1] = t;
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 2] = '\0';
+    b[o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 3] = '\0';
+    memcpy(b + o + 4 + OSE_ADDRESS_ANONVAL_SIZE + 4, p, n);
+}
+
+/* a word of a verified body. Without apply, looks up the builtin a
+   call is to, and returns false if it can't be called directly.
+   With apply, applies the word. */
+static bool verifiedWord(ose_bundle osevm, const char * const str,
+                         ose_fn *fns, int32_t *nfns, const bool apply)
+{
+    if(strncmp(str, "/!/", 3))
+    {
+        if(apply)
+        {
+            applyWord(osevm, str);
+        }
+        return true;
+    }
+    if(apply)
+    {
+        fns[(*nfns)++](osevm);
+        return true;
+    }
+    if(*nfns >= OSEVM_BATCH_MAXWORDS
+       || ose_getFirstOffsetForMatch(OSEVM_ENV(osevm), str + 2)
+       >= OSE_BUNDLE_HEADER_LEN)
+    {
+        return false;
+    }
+    fns[*nfns] = ose_symtab_lookup_unchecked(str + 2);
+    if(!fns[*nfns])
+    {
+        fns[*nfns] = ose_symtab_lookup_fn(str + 2);
+    }
+    return fns[(*nfns)++] != NULL;
+}
+
+/* walks the words of the verified body at offset in bundle in the
+   order popAllControl would put them in, either to look up the
+   builtins it calls, or to apply them, stopping at an error */
+static bool verifiedWords(ose_bundle osevm,
+                          ose_constbundle bundle,
+                          int32_t offset,
+                          ose_fn *fns,
+                          const bool apply)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    const char * const b = ose_getBundlePtr(bundle);
+    const int32_t end = offset + 4 + ose_readInt32(bundle, offset);
+    int32_t o = offset + 4 + OSE_BUNDLE_HEADER_LEN;
+    int32_t nfns = 0;
+    while(o < end)
+    {
+        const int32_t s = ose_readInt32(bundle, o);
+        if(ose_getBundleElemType(bundle, o) == OSETT_BUNDLE)
+        {
+            if(apply)
+            {
+                const int32_t so = ose_readSize(vm_s);
+                ose_addToSize(vm_s, s + 4);
+                memcpy(ose_getBundlePtr(vm_s) + so, b + o, s + 4);
+            }
+        }
+        else
+        {
+            const int32_t to = o + 4 + ose_getPaddedStringLen(bundle,
+                                                              o + 4);
+            if(to < o + 4 + s)
+            {
+                int32_t po = to + ose_getPaddedStringLen(bundle, to);
+                int32_t i;
+                for(i = 1; b[to + i]; i++)
+                {
+                    const char t = b[to + i];
+                    const int32_t ps = ose_getPayloadItemSize(bundle,
+                                                              t, po);
+                    if(!ose_isStringType(t))
+                    {
+                        if(apply)
+                        {
+                            pushItem(vm_s, t, b + po, ps);
+                        }
+                    }
+                    else if(!verifiedWord(osevm, b + po,
+                                          fns, &nfns, apply))
+                    {
+                        return false;
+                    }
+                    if(apply && ose_errno_get(osevm))
+                    {
+                        return true;
+                    }
+                    po += ps;
+                }
+            }
+            if(strncmp(b + o + 4,
+                       OSE_ADDRESS_ANONVAL,
+                       OSE_ADDRESS_ANONVAL_SIZE)
+               && !verifiedWord(osevm, b + o + 4, fns, &nfns, apply))
+            {
+                return false;
+            }
+        }
+        if(apply && ose_errno_get(osevm))
+        {
+            return true;
+        }
+        o += s + 4;
+    }
+    return true;
+}
+
+bool osevm_applyVerifiedBody(ose_bundle osevm, int32_t offset)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    ose_bundle vm_c = OSEVM_CONTROL(osevm);
+    ose_fn fns[OSEVM_BATCH_MAXWORDS];
+    const int32_t mo = ose_getLastBundleElemOffset(vm_s);
+    const int32_t co = ose_readSize(vm_c);
+    if(batch_funcall != ose_builtin_funcall
+       || batch_lookup != ose_builtin_lookupInEnv
+       || ose_spaceAvailable(vm_c) < ose_readInt32(vm_s, mo) + 4
+       || !verifiedWords(osevm, vm_s, offset, fns, false))
+    {
+        return false;
+    }
+    /* the words are applied from control, out of the way of the
+       stack. None of them can touch control. */
+    ose_moveElem(vm_s, vm_c);
+    verifiedWords(osevm, vm_c, co + offset - mo, fns, true);
+    ose_drop(vm_c);
+    return true;
+}
+
+bool osevm_loopVerifiedBody(ose_bundle osevm, int32_t n)
+{
+    ose_bundle vm_s = OSEVM_STACK(osevm);
+    ose_bundle vm_c = OSEVM_CONTROL(osevm);
+    ose_fn fns[OSEVM_BATCH_MAXWORDS];
+    const char * const b = ose_getBundlePtr(vm_s);
+    const int32_t fo = ose_getLastBundleElemOffset(vm_s);
+    const int32_t co = ose_readSize(vm_c);
+    int32_t lo = -1, bo = fo, need, o, i;
+    if(batch_funcall != ose_builtin_funcall
+       || batch_lookup != ose_builtin_lookupInEnv)
+    {
+        return false;
+    }
+    if(n < 0)
+    {
+        /* the list is the message below the function, and the
+           function can also be a body in a blob, as it is when
+           it's been looked up */
+        int32_t tto;
+        for(o = OSE_BUNDLE_HEADER_LEN;
+            o < fo;
+            o += ose_readInt32(vm_s, o) + 4)
+        {
+            lo = o;
+        }
+        if(lo < 0 || ose_getBundleElemType(vm_s, lo) != OSETT_MESSAGE)
+        {
+            return false;
+        }
+        tto = lo + 4 + ose_getPaddedStringLen(vm_s, lo + 4);
+        n = tto < lo + 4 + ose_readInt32(vm_s, lo)
+            ? (int32_t)strlen(b + tto) - 1 : 0;
+        if(ose_getBundleElemType(vm_s, fo) != OSETT_BUNDLE)
+        {
+            tto = fo + 4 + ose_getPaddedStringLen(vm_s, fo + 4);
+            bo = tto + ose_getPaddedStringLen(vm_s, tto);
+            if(tto >= fo + 4 + ose_readInt32(vm_s, fo)
+               || b[tto + 1] != OSETT_BLOB
+               || ose_readInt32(vm_s, bo) < OSE_BUNDLE_HEADER_LEN
+               || strncmp(b + bo + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+            {
+                return false;
+            }
+        }
+    }
+    else if(ose_getBundleElemType(vm_s, fo) != OSETT_BUNDLE)
+    {
+        return false;
+    }
+    need = osevm_verifyBody(osevm, vm_s, bo);
+    if(need < 0
+       || ose_spaceAvailable(vm_c)
+       < ose_readSize(vm_s) - (lo < 0 ? fo : lo)
+       || !verifiedWords(osevm, vm_s, bo, fns, false))
+    {
+        return false;
+    }
+    /* the body, and the list above it, are kept in control, out of
+       the way of the stack, for the whole loop */
+    bo += co - fo;
+    ose_moveElem(vm_s, vm_c);
+    if(lo >= 0)
+    {
+        ose_moveElem(vm_s, vm_c);
+    }
+    for(i = 0; i < n; i++)
+    {
+        if(lo >= 0)
+        {
+            ose_pop(vm_c);
+            ose_moveElem(vm_c, vm_s);
+        }
+        if(!ose_bundleHasAtLeastNElems(vm_s, need))
+        {
+            ose_errno_set(osevm, OSE_ERR_ELEM_COUNT);
+            break;
+        }
+        verifiedWords(osevm, vm_c, bo, fns, true);
+        if(ose_errno_get(osevm))
+        {
+            break;
+        }
+    }
+    if(lo >= 0)
+    {
+        ose_swap(vm_c);
+        ose_moveElem(vm_c, vm_s);
+    }
+    ose_moveElem(vm_c, vm_s);
+    return true;
+}
+
 #ifdef OSEVM_HAVE_SIZES
 int32_t osevm_computeSizeReqs(int n, ...)
 {
@@ -40,13 +40,15 @@ extern "C" {
 #define OSEVM_ADDR_CACHE    "/_0"
 
 /* number of 32-bit ints available in the cache message */
-#define OSEVM_CACHE_SIZE 30
+#define OSEVM_CACHE_SIZE 62
+/* the padded typetag string of the cache message */
+#define OSEVM_CACHE_TT_SIZE ((OSEVM_CACHE_SIZE + 2 + 3) & ~3)
 #define OSEVM_CACHE_MSG_SIZE OSE_CONTEXT_MESSAGE_OVERHEAD	\
-	+ 4 + 4 + 32 + (OSEVM_CACHE_SIZE * 4)
+	+ 4 + 4 + OSEVM_CACHE_TT_SIZE + (OSEVM_CACHE_SIZE * 4)
 #define OSEVM_CACHE_OFFSET_0 OSE_BUNDLE_HEADER_LEN	\
 	+ OSE_CONTEXT_BUNDLE_OFFSET			\
 	+ OSE_BUNDLE_HEADER_LEN				\
-	+ 4 + 4 + 32 /* size, address, typetags */
+	+ 4 + 4 + OSEVM_CACHE_TT_SIZE /* size, address, typetags */
 #define OSEVM_CACHE_OFFSET_1 	OSEVM_CACHE_OFFSET_0 + 4
 #define OSEVM_CACHE_OFFSET_2 	OSEVM_CACHE_OFFSET_1 + 4
 #define OSEVM_CACHE_OFFSET_3 	OSEVM_CACHE_OFFSET_2 + 4
@@ -71,6 +73,26 @@ extern "C" {
 #define OSEVM_CACHE_OFFSET_CONTROL 	OSEVM_CACHE_OFFSET_5
 #define OSEVM_CACHE_OFFSET_DUMP 	OSEVM_CACHE_OFFSET_6
 #define OSEVM_CACHE_OFFSET_OUTPUT 	OSEVM_CACHE_OFFSET_7
+/* dump depth that a suspended run returns to when it's resumed */
+#define OSEVM_CACHE_RESUME_DEPTH 	OSEVM_CACHE_OFFSET_8
+/* ticks spent applying control elements, and how many were applied,
+   as 64-bit values, high word first, when profiling */
+#define OSEVM_CACHE_APPLY_TICKS 	OSEVM_CACHE_OFFSET_9
+#define OSEVM_CACHE_APPLY_COUNT 	OSEVM_CACHE_OFFSET_11
+/* records of the stack effects of the function bodies that have
+   been assigned, four ints each: the hash of the name the body was
+   assigned to, the size and hash of the body, and the number of
+   elements it needs. A record goes in the slot picked by the hash of
+   the name, and a size of 0 marks an empty one. */
+#define OSEVM_CACHE_NEED 		OSEVM_CACHE_OFFSET_13
+#define OSEVM_CACHE_NEED_NRECORDS 8
+
+/**
+   @brief The number of cache slots, starting from 0, that the VM
+   uses itself. #OSEVM_GET_CACHE_VALUE and #OSEVM_SET_CACHE_VALUE
+   only accept indices from this one up to #OSEVM_CACHE_SIZE.
+*/
+#define OSEVM_CACHE_NRESERVED (13 + 4 * OSEVM_CACHE_NEED_NRECORDS)
 
 #ifdef OSEVM_HAVE_SIZES
 
@@ -179,11 +201,33 @@ ose_bundle osevm_init(ose_bundle bundle,
 	OSEVM_SET_FLAGS(osevm,                                              \
                     OSEVM_GET_FLAGS(osevm) & ~(0UL | OSEVM_FLAG_COMPILE))
 
+#define OSEVM_FLAG_SUSPEND 2
+#define OSEVM_IS_SUSPENDED(osevm)                       \
+    (OSEVM_GET_FLAGS(osevm) & OSEVM_FLAG_SUSPEND)
+#define OSEVM_SET_FLAG_SUSPEND(osevm)                               \
+	OSEVM_SET_FLAGS(osevm,                                          \
+                    OSEVM_GET_FLAGS(osevm) | OSEVM_FLAG_SUSPEND)
+#define OSEVM_UNSET_FLAG_SUSPEND(osevm)                                 \
+	OSEVM_SET_FLAGS(osevm,                                              \
+                    OSEVM_GET_FLAGS(osevm) & ~(0UL | OSEVM_FLAG_SUSPEND))
+
+/* the suspended run is a packet of a batch, whose results are moved
+   to the output when it's resumed and finishes */
+#define OSEVM_FLAG_BATCH 4
+#define OSEVM_SET_FLAG_BATCH(osevm)                                 \
+	OSEVM_SET_FLAGS(osevm,                                          \
+                    OSEVM_GET_FLAGS(osevm) | OSEVM_FLAG_BATCH)
+#define OSEVM_UNSET_FLAG_BATCH(osevm)                                   \
+	OSEVM_SET_FLAGS(osevm,                                              \
+                    OSEVM_GET_FLAGS(osevm) & ~(0UL | OSEVM_FLAG_BATCH))
+
 #define OSEVM_GET_CACHE_VALUE(osevm, idx)                       \
-	(ose_assert((idx) < OSEVM_CACHE_SIZE),                      \
+	(ose_assert((idx) >= OSEVM_CACHE_NRESERVED                  \
+                && (idx) < OSEVM_CACHE_SIZE),                   \
 	 ose_readInt32(osevm, OSEVM_CACHE_OFFSET_0 + (4 * (idx))))
 #define OSEVM_SET_CACHE_VALUE(osevm, idx, val)                          \
-	(ose_assert((idx) < OSEVM_CACHE_SIZE),                              \
+	(ose_assert((idx) >= OSEVM_CACHE_NRESERVED                          \
+                && (idx) < OSEVM_CACHE_SIZE),                           \
 	 ose_writeInt32(osevm, OSEVM_CACHE_OFFSET_0 + (4 * (idx)), val))
 
 /************************************************************
@@ -356,8 +400,196 @@ void osevm_inputMessages(ose_bundle osevm,
 			 int32_t size, const char * const bundle);
 void osevm_inputMessage(ose_bundle osevm,
 			int32_t size, const char * const message);
+bool osevm_inputPacket(ose_bundle osevm,
+                       int32_t size, const char * const packet);
 void osevm_run(ose_bundle bundle);
 char osevm_step(ose_bundle osevm);
+
+/**
+   @brief Ask the VM to stop after the control element that is
+   currently being applied.
+
+   This is meant to be called by a builtin that has to wait for
+   something, such as I/O, before the program can go on. Once the
+   builtin returns, #osevm_run returns without running the hooks
+   that follow a run, and leaves the input, stack, env, control, and
+   dump exactly as they are, so that the VM can be put aside and
+   picked up later with #osevm_resume, or from another thread.
+*/
+void osevm_suspend(ose_bundle osevm);
+
+/**
+   @brief Returns true if the last call to #osevm_run or
+   #osevm_resume returned because the VM was suspended, rather than
+   because it ran out of things to do.
+*/
+bool osevm_isSuspended(ose_bundle osevm);
+
+/**
+   @brief Continue running a suspended VM from where it stopped.
+
+   The run picks up with the next control element, and returns
+   from any functions it was in when it was suspended, just as the
+   original call to #osevm_run would have. Calling this on a VM
+   that isn't suspended is the same as calling #osevm_run.
+
+   If the VM was suspended by a packet run by #osevm_runBatch, the
+   results of the packet are moved to the output when it finishes.
+   If they don't fit, they're left on the stack in a bundle of their
+   own, and the VM stays marked as part way through a batch, so
+   #osevm_runBatch won't run another one. Once there's room in the
+   output, another call to this function moves them there.
+
+   @returns false if the results of a packet of a batch didn't fit
+   in the output, and true otherwise.
+*/
+bool osevm_resume(ose_bundle osevm);
+
+/**
+   @brief The number of words of a program run by #osevm_runBatch
+   that are decoded up front. Words past these are run as usual.
+*/
+#ifdef OSE_CONF_VM_BATCH_MAXWORDS
+#define OSEVM_BATCH_MAXWORDS OSE_CONF_VM_BATCH_MAXWORDS
+#else
+#define OSEVM_BATCH_MAXWORDS 64
+#endif
+
+/**
+   @brief The largest number of worker VMs /map/parallel splits a
+   list between.
+*/
+#ifdef OSE_CONF_VM_MAP_CHUNKS
+#define OSEVM_MAP_CHUNKS OSE_CONF_VM_MAP_CHUNKS
+#else
+#define OSEVM_MAP_CHUNKS 8
+#endif
+
+/**
+   @brief Run the same program over each packet of a batch.
+
+   @p batch is a bundle whose elements are the packets. For each
+   one, the stack is cleared, the packet is unpacked onto it (or
+   pushed, if it's a message), and the program in @p prog is run,
+   after which the stack is bundled up and moved to the output.
+
+   The program is unpacked and its words decoded once for the whole
+   batch, rather than once per packet: literals are pushed, and
+   builtins that aren't shadowed by the env are called, without
+   being looked up again. Once a packet leaves the program's
+   straight line, by calling a function, or pushing onto the
+   control, for example, the rest of it is run by the VM as usual,
+   so the result is the same as running the program with
+   #osevm_run. The input and control must be empty, as they are
+   when #osevm_run returns.
+
+   If the program suspends the VM, the batch stops. The packet it
+   was running can be finished with #osevm_resume, which moves its
+   results to the output, and the rest of the batch, from the packet
+   after it, can then be run with another call. Until the results
+   have been moved, this function runs nothing and returns 0.
+
+   @returns The number of packets whose results were moved to the
+   output. This is less than the number in the batch if the VM was
+   suspended, or if a packet or result didn't fit.
+*/
+int32_t osevm_runBatch(ose_bundle osevm,
+                       int32_t progsize, const char * const prog,
+                       int32_t batchsize, const char * const batch);
+
+/**
+   @brief Record, in the cache of @p osevm, that the function body of
+   size @p size and hash @p hash that was assigned to @p name needs
+   @p need elements from the stack. A negative @p need forgets what
+   was recorded for @p name.
+
+   The records are kept out of the env, so that they don't show up
+   in it, and there's room for #OSEVM_CACHE_NEED_NRECORDS of them.
+   One can push out another, in which case the body it was for is
+   applied the usual way.
+*/
+void osevm_recordNeed(ose_bundle osevm,
+                      const char * const name,
+                      int32_t size,
+                      int32_t hash,
+                      int32_t need);
+
+/**
+   @brief Look up the number of elements that the function body of
+   size @p size and hash @p hash, assigned to @p name, needs.
+
+   @returns The number recorded by #osevm_recordNeed, or -1 if there
+   isn't one for that body under that name.
+*/
+int32_t osevm_lookupNeed(ose_bundle osevm,
+                         const char * const name,
+                         int32_t size,
+                         int32_t hash);
+
+/**
+   @brief Work out how many elements the function body at @p offset
+   in @p bundle needs from the stack, from the stack effects
+   declared for the builtins in the symbol table.
+
+   The effect of a call is only known if it's to a builtin that the
+   env doesn't shadow at the time of the call to this function.
+
+   @returns The number of elements, or -1 if the body makes a call,
+   or uses a builtin, whose effect depends on what's on the stack.
+*/
+int32_t osevm_verifyBody(ose_bundle osevm,
+                         ose_constbundle bundle,
+                         int32_t offset);
+
+/**
+   @brief Apply the verified function body at @p offset of the
+   message on top of the stack, which the stack must have enough
+   elements for, without a frame.
+
+   The words of the body are applied in the current frame, and the
+   calls in it go straight to the builtins, or to the variants of
+   them that don't check the stack, since it was checked once, by
+   the caller.
+
+   @returns false, having done nothing, if any of the calls is to a
+   builtin that the env now shadows, or if the body doesn't fit in
+   control, where its words are applied from.
+*/
+bool osevm_applyVerifiedBody(ose_bundle osevm, int32_t offset);
+
+/**
+   @brief Apply the function body on top of the stack over and over
+   in the current frame, with the calls in it looked up once, rather
+   than copying it into control and pushing a frame for it each time.
+
+   If @p n is negative, the element below the body is a message, and
+   the last of its items is moved onto the stack before each
+   application, until there are none left, as /map does. The body
+   can then also be in a blob, as it is when it's been looked up.
+   Otherwise, the body is applied @p n times, as /dotimes does.
+   Either way, the body, and then the emptied message, are left on
+   top of the stack. The loop stops at the first error.
+
+   Since osevm_verifyBody has to be able to work out the effect of
+   the body, it can't touch anything other than the stack, so the
+   results are the same as they would be if each application had a
+   frame of its own.
+
+   @returns false, having done nothing, if the body can't be
+   verified, or doesn't fit in control.
+*/
+bool osevm_loopVerifiedBody(ose_bundle osevm, int32_t n);
+
+#ifdef OSE_CONF_PROFILE
+/**
+   @brief Get the ticks that @p osevm has spent applying control
+   elements, and how many it has applied, when profiling is enabled
+   with OSE_CONF_PROFILE. Each VM keeps its own, in its cache, so
+   VMs on different threads don't share them.
+*/
+void osevm_getApplyTime(ose_bundle osevm, struct ose_timestat *stat);
+#endif
+
 #ifdef OSEVM_HAVE_SIZES
 int32_t osevm_computeSizeReqs(int n, ...);
 #else
@@ -0,0 +1,3 @@
+#define OSE_LITTLE_ENDIAN 1
+#define OSE_BIG_ENDIAN 2
+#define OSE_ENDIAN OSE_LITTLE_ENDIAN
@@ -41,6 +41,13 @@ void ose_loadLib(ose_bundle osevm, const char * const name)
     ose_bundle vm_s = OSEVM_STACK(osevm);
     void *h = dlopen(name, RTLD_LAZY);
     ose_rassert(h != NULL, 1);
+    void (*ose_register)(int (*)(const char * const,
+                                 void (*)(ose_bundle))) = NULL;
+    *(void**)(&ose_register) = dlsym(h, "ose_register");
+    if(ose_register)
+    {
+        ose_register(ose_symtab_register);
+    }
     void (*ose_main)(ose_bundle) = NULL;
     *(void**)(&ose_main) = dlsym(h, "ose_main");
     ose_rassert(ose_main != NULL, 1);
@@ -28,6 +28,16 @@
 extern "C" {
 #endif
 
+/* Loads a library and calls its ose_main. If the library also
+   exports
+
+   void ose_register(int (*reg)(const char * const,
+                                void (*)(ose_bundle)));
+
+   it's called first, with ose_symtab_register, so that the library
+   can register its functions to be looked up like builtins without
+   having to link against the symtab itself. Like any registration,
+   this must not be done while VMs are running on other threads. */
 void ose_loadLib(ose_bundle osevm, const char * const name);
 void ose_readFileLines(ose_bundle bundle, const char * const name);
 void ose_readFile(ose_bundle bundle, const char * const name);
@@ -0,0 +1,273 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <time.h>
+
+#include "ose.h"
+#include "ose_util.h"
+#include "ose_stackops.h"
+#include "ose_vm.h"
+#include "ose_replay.h"
+
+#define OSE_REPLAY_MAGIC 0x6f736552
+#define OSE_REPLAY_VERSION 1
+#define OSE_REPLAY_HEADER_LEN 8
+#define OSE_REPLAY_RECORD_HEADER_LEN 12
+
+static uint64_t nanos(ose_hptimer t)
+{
+    return ose_timeToMonotonicNanos(t, ose_now(t));
+}
+
+static void writeInt32(char *p, int32_t i)
+{
+    i = ose_htonl(i);
+    memcpy(p, &i, 4);
+}
+
+static int32_t readInt32(const char *p)
+{
+    int32_t i;
+    memcpy(&i, p, 4);
+    return ose_ntohl(i);
+}
+
+int ose_recorder_open(struct ose_recorder *r, const char * const path)
+{
+    char header[OSE_REPLAY_HEADER_LEN];
+    r->fp = fopen(path, "wb");
+    if(!r->fp)
+    {
+        return -1;
+    }
+    writeInt32(header, OSE_REPLAY_MAGIC);
+    writeInt32(header + 4, OSE_REPLAY_VERSION);
+    if(fwrite(header, OSE_REPLAY_HEADER_LEN, 1, r->fp) != 1)
+    {
+        fclose(r->fp);
+        r->fp = NULL;
+        return -1;
+    }
+    r->timer = ose_initTimer();
+    return 0;
+}
+
+void ose_recorder_close(struct ose_recorder *r)
+{
+    if(r->fp)
+    {
+        fclose(r->fp);
+        r->fp = NULL;
+    }
+}
+
+int ose_recorder_record(struct ose_recorder *r,
+                        int32_t size,
+                        const char * const packet)
+{
+    char header[OSE_REPLAY_RECORD_HEADER_LEN];
+    const uint64_t t = nanos(r->timer);
+    if(!r->fp || size < 0)
+    {
+        return -1;
+    }
+    writeInt32(header, (int32_t)(t >> 32));
+    writeInt32(header + 4, (int32_t)(t & 0xffffffff));
+    writeInt32(header + 8, size);
+    if(fwrite(header, OSE_REPLAY_RECORD_HEADER_LEN, 1, r->fp) != 1
+       || fwrite(packet, 1, size, r->fp) != (size_t)size)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+bool ose_recorder_inputPacket(struct ose_recorder *r,
+                              ose_bundle osevm,
+                              int32_t size,
+                              const char * const packet)
+{
+    if(ose_recorder_record(r, size, packet))
+    {
+        return false;
+    }
+    return osevm_inputPacket(osevm, size, packet);
+}
+
+static void addLatency(struct ose_replay_stats *stats, uint64_t ns)
+{
+    int32_t bin = 0;
+    uint64_t t = ns >> 1;
+    while(t && bin < OSE_REPLAY_NBINS - 1)
+    {
+        t >>= 1;
+        bin++;
+    }
+    stats->bins[bin]++;
+    if(stats->npackets == 0 || ns < stats->min)
+    {
+        stats->min = ns;
+    }
+    if(ns > stats->max)
+    {
+        stats->max = ns;
+    }
+    stats->total += ns;
+    stats->npackets++;
+}
+
+static void waitUntil(ose_hptimer timer, uint64_t t)
+{
+    uint64_t now = nanos(timer);
+    while(now < t)
+    {
+        struct timespec ts;
+        ts.tv_sec = (t - now) / 1000000000;
+        ts.tv_nsec = (t - now) % 1000000000;
+        nanosleep(&ts, NULL);
+        now = nanos(timer);
+    }
+}
+
+int ose_replay(const char * const path,
+               ose_bundle osevm,
+               bool realtime,
+               char *buf,
+               int32_t bufsize,
+               ose_fn output,
+               struct ose_replay_stats *stats)
+{
+    char header[OSE_REPLAY_RECORD_HEADER_LEN];
+    ose_hptimer timer;
+    FILE *fp = fopen(path, "rb");
+    memset(stats, 0, sizeof(struct ose_replay_stats));
+    if(!fp)
+    {
+        return -1;
+    }
+    if(fread(header, OSE_REPLAY_HEADER_LEN, 1, fp) != 1
+       || readInt32(header) != OSE_REPLAY_MAGIC
+       || readInt32(header + 4) != OSE_REPLAY_VERSION)
+    {
+        fclose(fp);
+        return -1;
+    }
+    timer = ose_initTimer();
+    while(fread(header, OSE_REPLAY_RECORD_HEADER_LEN, 1, fp) == 1)
+    {
+        const uint64_t t = ((uint64_t)(uint32_t)readInt32(header) << 32)
+            | (uint32_t)readInt32(header + 4);
+        const int32_t size = readInt32(header + 8);
+        uint64_t start;
+        if(size < 0)
+        {
+            break;
+        }
+        if(size > bufsize)
+        {
+            if(fseek(fp, size, SEEK_CUR))
+            {
+                break;
+            }
+            stats->ndropped++;
+            continue;
+        }
+        if(fread(buf, 1, size, fp) != (size_t)size)
+        {
+            break;
+        }
+        if(realtime)
+        {
+            waitUntil(timer, t);
+        }
+        start = nanos(timer);
+        if(!osevm_inputPacket(osevm, size, buf))
+        {
+            stats->ndropped++;
+            continue;
+        }
+        osevm_run(osevm);
+        addLatency(stats, nanos(timer) - start);
+        if(output)
+        {
+            output(osevm);
+        }
+        ose_clear(OSEVM_OUTPUT(osevm));
+        ose_clear(OSEVM_STACK(osevm));
+    }
+    fclose(fp);
+    return 0;
+}
+
+uint64_t ose_replay_percentile(const struct ose_replay_stats *stats,
+                               double p)
+{
+    const double n = p * stats->npackets;
+    uint64_t count = 0;
+    int32_t i;
+    for(i = 0; i < OSE_REPLAY_NBINS; i++)
+    {
+        count += stats->bins[i];
+        if(count && count >= n)
+        {
+            break;
+        }
+    }
+    if(i >= OSE_REPLAY_NBINS - 1)
+    {
+        return stats->max;
+    }
+    return ((uint64_t)2 << i) < stats->max
+        ? ((uint64_t)2 << i) : stats->max;
+}
+
+void ose_replay_printStats(const struct ose_replay_stats *stats,
+                           FILE *fp)
+{
+    int32_t i;
+    fprintf(fp, "packets: %d, dropped: %d\n",
+            stats->npackets, stats->ndropped);
+    if(!stats->npackets)
+    {
+        return;
+    }
+    fprintf(fp, "min: %llu ns, mean: %llu ns, max: %llu ns\n",
+            (unsigned long long)stats->min,
+            (unsigned long long)(stats->total / stats->npackets),
+            (unsigned long long)stats->max);
+    fprintf(fp, "p50: %llu ns, p90: %llu ns, p99: %llu ns\n",
+            (unsigned long long)ose_replay_percentile(stats, 0.5),
+            (unsigned long long)ose_replay_percentile(stats, 0.9),
+            (unsigned long long)ose_replay_percentile(stats, 0.99));
+    for(i = 0; i < OSE_REPLAY_NBINS; i++)
+    {
+        if(stats->bins[i])
+        {
+            fprintf(fp, "%12llu ns: %d\n",
+                    (unsigned long long)((uint64_t)1 << i),
+                    (int)stats->bins[i]);
+        }
+    }
+}
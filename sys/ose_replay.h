@@ -0,0 +1,148 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/** @file ose_replay.h
+    @brief Record the packets fed to a VM, and play them back.
+
+    A recorder appends each packet it's given to a log file,
+    together with the time it arrived, measured with #ose_now from
+    when the recorder was opened. The log is a short header
+    followed by one record per packet: the time in nanoseconds as
+    two big-endian 32-bit words, the big-endian size of the packet,
+    and the packet itself.
+
+    #ose_replay feeds a log back into a VM with #osevm_inputPacket
+    and runs the VM after each packet, either as fast as it can or
+    at the pace the packets were recorded at, and collects a
+    histogram of how long each packet took to run.
+*/
+
+#ifndef OSE_REPLAY_H
+#define OSE_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "ose.h"
+#include "ose_time.h"
+
+struct ose_recorder
+{
+    FILE *fp;
+    ose_hptimer timer;
+};
+
+/**
+   @brief Create or truncate the log at @p path.
+
+   @returns 0 on success, -1 on failure.
+*/
+int ose_recorder_open(struct ose_recorder *r, const char * const path);
+void ose_recorder_close(struct ose_recorder *r);
+
+/**
+   @brief Append a packet to the log.
+
+   @returns 0 on success, -1 on failure.
+*/
+int ose_recorder_record(struct ose_recorder *r,
+                        int32_t size,
+                        const char * const packet);
+
+/**
+   @brief Record a packet, and then pass it to
+   #osevm_inputPacket. A packet that can't be recorded isn't input
+   either, so that the log holds everything the VM was given.
+
+   @returns false if the packet couldn't be recorded, and otherwise
+   the result of #osevm_inputPacket.
+*/
+bool ose_recorder_inputPacket(struct ose_recorder *r,
+                              ose_bundle osevm,
+                              int32_t size,
+                              const char * const packet);
+
+/* bin i counts latencies from 2^i up to 2^(i + 1) nanoseconds, and
+   bin 0 also counts those under a nanosecond */
+#define OSE_REPLAY_NBINS 48
+
+struct ose_replay_stats
+{
+    uint64_t bins[OSE_REPLAY_NBINS];
+    /* packets run, and packets that were too big for the buffer,
+       malformed, or didn't fit in the input */
+    int32_t npackets;
+    int32_t ndropped;
+    uint64_t min;
+    uint64_t max;
+    uint64_t total;
+};
+
+/**
+   @brief Play the log at @p path into @p osevm.
+
+   Each packet is read into the @p bufsize bytes of @p buf, input
+   with #osevm_inputPacket, and run with #osevm_run, and the time
+   that took is added to @p stats. If @p realtime is true, each
+   packet is held back until as long after the start of the
+   replay as it was after the start of the recording.
+
+   After each packet has run, @p output, if it isn't NULL, is
+   called with the VM to take what it needs from the output and
+   the stack, which are then cleared, so that every packet starts
+   from the same place and the VM doesn't fill up over a long log.
+   The time that takes isn't counted.
+
+   @returns 0 on success, or -1 if the log couldn't be opened or
+   isn't a log.
+*/
+int ose_replay(const char * const path,
+               ose_bundle osevm,
+               bool realtime,
+               char *buf,
+               int32_t bufsize,
+               ose_fn output,
+               struct ose_replay_stats *stats);
+
+/**
+   @brief Returns an upper bound on the latency, in nanoseconds,
+   of the fraction @p p of the packets in @p stats, such as 0.99
+   for the 99th percentile.
+*/
+uint64_t ose_replay_percentile(const struct ose_replay_stats *stats,
+                               double p);
+
+/**
+   @brief Print a summary of @p stats and its histogram to @p fp.
+*/
+void ose_replay_printStats(const struct ose_replay_stats *stats,
+                           FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,254 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ose.h"
+#include "ose_context.h"
+#include "ose_util.h"
+#include "ose_stackops.h"
+#include "ose_assert.h"
+#include "ose_shm.h"
+
+#define OSE_SHMCHAN_MAGIC 0x6f736543
+#define OSE_SHMCHAN_LINE 64
+
+/*
+  The counters only ever increase. The writer owns head and the
+  reader owns tail, and each is on its own cache line.
+*/
+struct ose_shmchan_header
+{
+    int32_t magic;
+    int32_t nslots;
+    int32_t slotsize;
+    int32_t bundleoffset;
+    char pad1[OSE_SHMCHAN_LINE - 16];
+    uint32_t head;
+    char pad2[OSE_SHMCHAN_LINE - 4];
+    uint32_t tail;
+    char pad3[OSE_SHMCHAN_LINE - 4];
+};
+
+#define ose_shmchan_header(c)                   \
+    ((struct ose_shmchan_header *)((c)->base))
+
+static ose_bundle getSlot(struct ose_shmchan *c, uint32_t i)
+{
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    char *slot = c->base + sizeof(struct ose_shmchan_header)
+        + (i % h->nslots) * h->slotsize;
+    return ose_makeBundle(slot + h->bundleoffset);
+}
+
+int ose_shmchan_create(struct ose_shmchan *c,
+                       const char * const name,
+                       int32_t nslots,
+                       int32_t slotsize)
+{
+    ose_assert(c);
+    ose_assert(nslots > 0);
+    slotsize = (slotsize + OSE_SHMCHAN_LINE - 1)
+        & ~(OSE_SHMCHAN_LINE - 1);
+    const int32_t size = sizeof(struct ose_shmchan_header)
+        + nslots * slotsize;
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    if(ftruncate(fd, size))
+    {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    char *base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -1;
+    }
+    c->base = base;
+    c->size = size;
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    h->nslots = nslots;
+    h->slotsize = slotsize;
+    /* every slot is aligned the same way, so the bundle is at the
+       same offset in all of them */
+    for(int32_t i = 0; i < nslots; i++)
+    {
+        char *slot = base + sizeof(struct ose_shmchan_header)
+            + i * slotsize;
+        ose_bundle b = ose_newBundleFromCBytes(slotsize, slot);
+        h->bundleoffset = ose_getBundlePtr(b) - slot;
+    }
+    __atomic_store_n(&h->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->tail, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->magic, OSE_SHMCHAN_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int ose_shmchan_open(struct ose_shmchan *c, const char * const name)
+{
+    ose_assert(c);
+    int fd = shm_open(name, O_RDWR, 0600);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    struct stat st;
+    if(fstat(fd, &st) || st.st_size < (off_t)sizeof(struct ose_shmchan_header))
+    {
+        close(fd);
+        return -1;
+    }
+    char *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED)
+    {
+        return -1;
+    }
+    c->base = base;
+    c->size = st.st_size;
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    if(__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) != OSE_SHMCHAN_MAGIC)
+    {
+        ose_shmchan_close(c);
+        return -1;
+    }
+    /* don't trust the header to describe slots that aren't mapped */
+    if(h->nslots <= 0 || h->slotsize <= 0
+       || h->bundleoffset < 0 || h->bundleoffset >= h->slotsize
+       || (int64_t)h->nslots * h->slotsize
+       > (int64_t)c->size - (int64_t)sizeof(struct ose_shmchan_header))
+    {
+        ose_shmchan_close(c);
+        return -1;
+    }
+    return 0;
+}
+
+void ose_shmchan_close(struct ose_shmchan *c)
+{
+    if(c->base)
+    {
+        munmap(c->base, c->size);
+        c->base = NULL;
+        c->size = 0;
+    }
+}
+
+int ose_shmchan_unlink(const char * const name)
+{
+    return shm_unlink(name);
+}
+
+bool ose_shmchan_beginWrite(struct ose_shmchan *c, ose_bundle *bundle)
+{
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    const uint32_t head = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+    const uint32_t tail = __atomic_load_n(&h->tail, __ATOMIC_ACQUIRE);
+    if(head - tail >= (uint32_t)h->nslots)
+    {
+        return false;
+    }
+    *bundle = getSlot(c, head);
+    ose_clear(*bundle);
+    return true;
+}
+
+void ose_shmchan_endWrite(struct ose_shmchan *c)
+{
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    const uint32_t head = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool ose_shmchan_beginRead(struct ose_shmchan *c, ose_bundle *bundle)
+{
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    const uint32_t tail = __atomic_load_n(&h->tail, __ATOMIC_RELAXED);
+    const uint32_t head = __atomic_load_n(&h->head, __ATOMIC_ACQUIRE);
+    if(head == tail)
+    {
+        return false;
+    }
+    *bundle = getSlot(c, tail);
+    return true;
+}
+
+void ose_shmchan_endRead(struct ose_shmchan *c)
+{
+    struct ose_shmchan_header *h = ose_shmchan_header(c);
+    const uint32_t tail = __atomic_load_n(&h->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+bool ose_shmchan_send(struct ose_shmchan *c, ose_constbundle src)
+{
+    ose_bundle b;
+    const int32_t n = ose_readSize(src) - OSE_BUNDLE_HEADER_LEN;
+    if(!ose_shmchan_beginWrite(c, &b))
+    {
+        return false;
+    }
+    if(ose_spaceAvailable(b) < n)
+    {
+        return false;
+    }
+    ose_incSize(b, n);
+    memcpy(ose_getBundlePtr(b) + OSE_BUNDLE_HEADER_LEN,
+           ose_getBundlePtr(src) + OSE_BUNDLE_HEADER_LEN, n);
+    ose_shmchan_endWrite(c);
+    return true;
+}
+
+bool ose_shmchan_receive(struct ose_shmchan *c, ose_bundle dest)
+{
+    ose_bundle b;
+    if(!ose_shmchan_beginRead(c, &b))
+    {
+        return false;
+    }
+    const int32_t n = ose_readSize(b) - OSE_BUNDLE_HEADER_LEN;
+    if(ose_spaceAvailable(dest) < n)
+    {
+        return false;
+    }
+    const int32_t o = ose_readSize(dest);
+    ose_incSize(dest, n);
+    memcpy(ose_getBundlePtr(dest) + o,
+           ose_getBundlePtr(b) + OSE_BUNDLE_HEADER_LEN, n);
+    ose_shmchan_endRead(c);
+    return true;
+}
@@ -0,0 +1,112 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/** @file ose_shm.h
+    @brief Bundle channels in POSIX shared memory.
+
+    A channel is a ring of fixed-size context bundles in a shared
+    memory segment, with the number of bundles written and read kept
+    in the header of the segment. Since bundles contain only
+    offsets, a process can use a bundle in the segment where it
+    was written by another process, without copying it and without
+    a system call per packet. A channel has one writer and one
+    reader.
+*/
+
+#ifndef OSE_SHM_H
+#define OSE_SHM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "ose.h"
+
+struct ose_shmchan
+{
+    char *base;
+    int32_t size;
+};
+
+/**
+   @brief Create a channel named @p name (see shm_open(3)) with
+   @p nslots bundles of @p slotsize bytes each.
+
+   @returns 0 on success, -1 on failure.
+*/
+int ose_shmchan_create(struct ose_shmchan *c,
+                       const char * const name,
+                       int32_t nslots,
+                       int32_t slotsize);
+
+/**
+   @brief Open a channel created by another process.
+
+   @returns 0 on success, -1 on failure, including when the shared
+   memory is smaller than the slots its header describes.
+*/
+int ose_shmchan_open(struct ose_shmchan *c, const char * const name);
+void ose_shmchan_close(struct ose_shmchan *c);
+int ose_shmchan_unlink(const char * const name);
+
+/**
+   @brief Get the next empty bundle to write into. The bundle is
+   passed to the reader by #ose_shmchan_endWrite.
+
+   @returns false if the ring is full.
+*/
+bool ose_shmchan_beginWrite(struct ose_shmchan *c, ose_bundle *bundle);
+void ose_shmchan_endWrite(struct ose_shmchan *c);
+
+/**
+   @brief Get the oldest bundle that hasn't been read yet. The
+   bundle stays valid, and is not reused by the writer, until
+   #ose_shmchan_endRead is called.
+
+   @returns false if there is nothing to read.
+*/
+bool ose_shmchan_beginRead(struct ose_shmchan *c, ose_bundle *bundle);
+void ose_shmchan_endRead(struct ose_shmchan *c);
+
+/**
+   @brief Copy the elements of @p src into the next bundle in the
+   ring.
+
+   @returns false if the ring is full or the elements don't fit.
+*/
+bool ose_shmchan_send(struct ose_shmchan *c, ose_constbundle src);
+
+/**
+   @brief Append the elements of the oldest unread bundle in the
+   ring to @p dest.
+
+   @returns false if there was nothing to read or it doesn't fit.
+*/
+bool ose_shmchan_receive(struct ose_shmchan *c, ose_bundle dest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
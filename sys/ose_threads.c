@@ -0,0 +1,180 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <pthread.h>
+
+#include "ose.h"
+#include "ose_stackops.h"
+#include "ose_threads.h"
+
+/* ranges are this many times smaller than an even split, so that
+   threads that finish early can take more */
+#define OSE_THREADS_CHUNKS_PER_THREAD 4
+
+static struct
+{
+    pthread_t threads[OSE_THREADS_MAX];
+    int32_t nthreads;
+    pthread_mutex_t call;
+    pthread_mutex_t lock;
+    pthread_cond_t go;
+    pthread_cond_t done;
+    uint32_t generation;
+    int32_t pending;
+    bool quit;
+    ose_parallelfn fn;
+    void *context;
+    int32_t n;
+    int32_t chunk;
+    int32_t next;
+} pool = {
+    .call = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .go = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+static __thread bool inloop;
+
+static void runChunks(void)
+{
+    for(;;)
+    {
+        const int32_t start = __atomic_fetch_add(&pool.next, pool.chunk,
+                                                 __ATOMIC_RELAXED);
+        if(start >= pool.n)
+        {
+            break;
+        }
+        const int32_t end = pool.n - start < pool.chunk
+            ? pool.n
+            : start + pool.chunk;
+        pool.fn(pool.context, start, end);
+    }
+}
+
+/* arg is the generation when the thread was created, so that a
+   loop started before the thread first takes the lock isn't missed */
+static void *worker(void *arg)
+{
+    uint32_t generation = (uint32_t)(uintptr_t)arg;
+    inloop = true;
+    pthread_mutex_lock(&pool.lock);
+    for(;;)
+    {
+        while(pool.generation == generation && !pool.quit)
+        {
+            pthread_cond_wait(&pool.go, &pool.lock);
+        }
+        if(pool.quit)
+        {
+            break;
+        }
+        generation = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+        runChunks();
+        pthread_mutex_lock(&pool.lock);
+        if(--pool.pending == 0)
+        {
+            pthread_cond_signal(&pool.done);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+int ose_threads_init(int32_t nthreads)
+{
+    if(pool.nthreads || nthreads < 1 || nthreads > OSE_THREADS_MAX + 1)
+    {
+        return -1;
+    }
+    pool.quit = false;
+    for(int32_t i = 0; i < nthreads - 1; i++)
+    {
+        if(pthread_create(pool.threads + i, NULL, worker,
+                          (void *)(uintptr_t)pool.generation))
+        {
+            ose_threads_destroy();
+            return -1;
+        }
+        pool.nthreads++;
+    }
+    ose_setParallelFor(ose_threads_parallelFor);
+    return 0;
+}
+
+void ose_threads_destroy(void)
+{
+    ose_setParallelFor(NULL);
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = true;
+    pthread_cond_broadcast(&pool.go);
+    pthread_mutex_unlock(&pool.lock);
+    for(int32_t i = 0; i < pool.nthreads; i++)
+    {
+        pthread_join(pool.threads[i], NULL);
+    }
+    pool.nthreads = 0;
+}
+
+void ose_threads_parallelFor(int32_t n, ose_parallelfn fn, void *context)
+{
+    if(n <= 0)
+    {
+        return;
+    }
+    if(!pool.nthreads || n < 2 || inloop
+       || pthread_mutex_trylock(&pool.call))
+    {
+        fn(context, 0, n);
+        return;
+    }
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.context = context;
+    pool.n = n;
+    pool.chunk = n / ((pool.nthreads + 1)
+                      * OSE_THREADS_CHUNKS_PER_THREAD);
+    if(pool.chunk < 1)
+    {
+        pool.chunk = 1;
+    }
+    pool.next = 0;
+    pool.pending = pool.nthreads;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.go);
+    pthread_mutex_unlock(&pool.lock);
+
+    inloop = true;
+    runChunks();
+    inloop = false;
+
+    pthread_mutex_lock(&pool.lock);
+    while(pool.pending)
+    {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.call);
+}
@@ -0,0 +1,67 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/** @file ose_threads.h
+    @brief A pool of threads for the parallel loops of libose.
+
+    #ose_threads_init starts the threads and installs
+    #ose_threads_parallelFor with #ose_setParallelFor, so that
+    functions like #ose_routeParallel spread their work across
+    them. The calling thread takes part in every loop, and a loop
+    started while another one is running, or from inside one, is
+    run in the calling thread.
+*/
+
+#ifndef OSE_THREADS_H
+#define OSE_THREADS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ose.h"
+#include "ose_stackops.h"
+
+#define OSE_THREADS_MAX 64
+
+/**
+   @brief Start the pool, with @p nthreads threads including the
+   caller, and install it.
+
+   @returns 0 on success, -1 on failure.
+*/
+int ose_threads_init(int32_t nthreads);
+
+/**
+   @brief Stop the threads, and restore the default
+   #ose_parallelfor.
+*/
+void ose_threads_destroy(void);
+
+void ose_threads_parallelFor(int32_t n, ose_parallelfn fn, void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
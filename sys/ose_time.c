@@ -59,26 +59,99 @@ uint64_t ose_timeToMonotonicNanos(ose_hptimer t, uint64_t tt)
 #ifdef _POSIX_VERSION
 #include <time.h>
 
+#if defined(OSE_TIME_HAVE_TSC)
+/* nanoseconds of CLOCK_MONOTONIC, which the time stamp counter is
+   calibrated against */
+static uint64_t monotonicNanos(void)
+{
+	struct timespec ts;
+	memset(&ts, 0, sizeof(struct timespec));
+	int r = clock_gettime(CLOCK_MONOTONIC, &ts);
+	(void)r;
+	ose_assert(r == 0);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* reads the monotonic clock, and the tick count halfway through
+   the read. The read that took the fewest ticks out of a few is
+   used, so that one that was interrupted doesn't skew the
+   calibration. */
+static void sampleTicks(uint64_t *n, uint64_t *tk)
+{
+	uint64_t best = UINT64_MAX;
+	int i;
+	for(i = 0; i < 8; i++)
+	{
+		const uint64_t a = ose_ticks();
+		const uint64_t nn = monotonicNanos();
+		const uint64_t b = ose_ticks();
+		if(b - a < best)
+		{
+			best = b - a;
+			*n = nn;
+			*tk = a + (b - a) / 2;
+		}
+	}
+}
+#endif
+
+#if defined(OSE_TIME_HAVE_TSC) || defined(OSE_TIME_HAVE_CNTVCT)
+/* sets mult and shift so that dt ticks convert to dn nanoseconds,
+   keeping as many bits of the ratio as fit in mult */
+static void setRatio(ose_hptimer *t, uint64_t dn, uint64_t dt)
+{
+	uint32_t shift = 32;
+	uint64_t mult = (dn << shift) / dt;
+	while(mult > 0xffffffffull && shift > 0)
+	{
+		--shift;
+		mult = (dn << shift) / dt;
+	}
+	t->mult = (uint32_t)mult;
+	t->shift = shift;
+}
+#endif
+
 ose_hptimer ose_initTimer(void)
 {
 	ose_hptimer t = {0};
-	t.bias = ose_now(t);
+#if defined(OSE_TIME_HAVE_TSC)
+	{
+		/* count ticks over about 5 ms of the monotonic clock */
+		uint64_t n0, t0, n1, t1;
+		sampleTicks(&n0, &t0);
+		do
+		{
+			sampleTicks(&n1, &t1);
+		} while(n1 - n0 < 5000000);
+		setRatio(&t, n1 - n0, t1 - t0);
+	}
+#elif defined(OSE_TIME_HAVE_CNTVCT)
+	{
+		uint64_t f;
+		__asm__ __volatile__ ("mrs %0, cntfrq_el0" : "=r" (f));
+		setRatio(&t, 1000000000ull, f);
+	}
+#else
+	t.mult = 1;
+	t.shift = 0;
+#endif
+	t.bias = ose_ticks();
 	return t;
 }
 
 uint64_t ose_now(ose_hptimer t)
 {
-	struct timespec ts;
-	memset(&ts, 0, sizeof(struct timespec));
-	int r = clock_gettime(CLOCK_MONOTONIC, &ts);
-	ose_assert(r == 0);
-	uint64_t tt = (ts.tv_sec * 1e9 + ts.tv_nsec) - t.bias;
-	return tt;
+	return ose_ticks() - t.bias;
 }
 
 uint64_t ose_timeToMonotonicNanos(ose_hptimer t, uint64_t tt)
 {
-	return tt;
+	/* (tt * mult) >> shift, in two halves so that it doesn't
+	   overflow as long as the result fits */
+	const uint64_t high = (tt >> 32) * t.mult;
+	const uint64_t low = (tt & 0xffffffffull) * t.mult;
+	return (high << (32 - t.shift)) + (low >> t.shift);
 }
 
 #endif // posix
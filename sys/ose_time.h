@@ -24,10 +24,27 @@
 #ifndef OSE_TIME_H
 #define OSE_TIME_H
 
+#include <inttypes.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#define OSE_TIME_INLINE static __inline__
+#else
+#define OSE_TIME_INLINE static
+#endif
+
+/* counters that can be read directly, without a system call */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__APPLE__)
+#if defined(__x86_64__)
+#define OSE_TIME_HAVE_TSC
+#elif defined(__aarch64__)
+#define OSE_TIME_HAVE_CNTVCT
+#endif
+#endif
+
 #define OSE_HAVE_HPTIMER
 
 #ifdef __APPLE__
@@ -44,10 +61,14 @@ typedef struct ose_hptimer_
     && defined(__STDC_VERSION__) && __STDC_VERSION__ > 199901L
 #include <unistd.h>
 #ifdef _POSIX_VERSION
+#include <time.h>
 
+/* ticks are converted to nanoseconds as (ticks * mult) >> shift */
 typedef struct ose_hptimer_
 {
     uint64_t bias;
+    uint32_t mult;
+    uint32_t shift;
 } ose_hptimer;
 #endif
 
@@ -58,10 +79,95 @@ typedef struct ose_hptimer_ {} ose_hptimer;
 
 #endif
 
+/**
+   @brief Read the clock that #ose_now uses, in ticks, without
+   subtracting the bias of a timer.
+
+   This is the time stamp counter on x86-64, which is assumed to be
+   invariant, as it is on every x86-64 processor of the last decade
+   or so, the virtual counter on ARM64, mach_absolute_time on
+   Apple platforms, and CLOCK_MONOTONIC in nanoseconds on other
+   POSIX platforms. Where there's no clock at all, it returns 0.
+*/
+OSE_TIME_INLINE uint64_t ose_ticks(void)
+{
+#if defined(OSE_TIME_HAVE_TSC)
+    uint32_t lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(OSE_TIME_HAVE_CNTVCT)
+    uint64_t v;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (v));
+    return v;
+#elif defined(__APPLE__)
+    return mach_absolute_time();
+#elif defined(OSE_HAVE_HPTIMER)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+/**
+   @brief Create a timer. On x86-64, this calibrates the time stamp
+   counter against CLOCK_MONOTONIC, which takes about 5 ms.
+*/
 ose_hptimer ose_initTimer(void);
+
+/**
+   @brief The number of ticks since @p t was created.
+*/
 uint64_t ose_now(ose_hptimer t);
+
+/**
+   @brief Convert ticks from #ose_now or #ose_ticks to nanoseconds,
+   using integer arithmetic only.
+*/
 uint64_t ose_timeToMonotonicNanos(ose_hptimer t, uint64_t tt);
 
+/**
+   @brief Ticks and number of passes accumulated by #OSE_TIMED.
+*/
+struct ose_timestat
+{
+    uint64_t ticks;
+    uint64_t count;
+};
+
+/**
+   @brief Time the statement or block that follows, adding the
+   ticks it took, and one pass, to @p stat, a struct ose_timestat.
+
+   @code{.c}
+   OSE_TIMED(applytime)
+   {
+       applyControl(osevm, address);
+   }
+   @endcode
+
+   Leaving the block with break, goto, or return skips the
+   accounting. The stat isn't synchronized, so each thread should
+   have its own.
+
+   Unless OSE_CONF_PROFILE is defined, and the compiler supports
+   C99, this expands to nothing, and the block is run as it is.
+*/
+#ifndef OSE_TIMED
+#if defined(OSE_CONF_PROFILE)                                   \
+    && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define OSE_TIMED(stat)                                             \
+    for(uint64_t ose_timed_t0_ = ose_ticks(), ose_timed_n_ = 1;     \
+        ose_timed_n_;                                               \
+        ose_timed_n_ = 0,                                           \
+            (stat).ticks += ose_ticks() - ose_timed_t0_,            \
+            (stat).count++)
+#else
+#define OSE_TIMED(stat)
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,261 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "ose.h"
+#include "ose_context.h"
+#include "ose_util.h"
+#include "ose_stackops.h"
+#include "ose_assert.h"
+#include "ose_vm.h"
+#include "ose_udp.h"
+
+static int makeAddr(struct sockaddr_in *sa,
+                    const char * const addr,
+                    uint16_t port)
+{
+    memset(sa, 0, sizeof(struct sockaddr_in));
+    sa->sin_family = AF_INET;
+    sa->sin_port = htons(port);
+    if(!addr)
+    {
+        sa->sin_addr.s_addr = htonl(INADDR_ANY);
+        return 0;
+    }
+    return inet_pton(AF_INET, addr, &(sa->sin_addr)) == 1 ? 0 : -1;
+}
+
+int ose_udp_open(struct ose_udp *u,
+                 const char * const addr,
+                 uint16_t port,
+                 int32_t maxpacketsize)
+{
+    struct sockaddr_in sa;
+    memset(u, 0, sizeof(struct ose_udp));
+    u->fd = -1;
+    if(maxpacketsize <= 0 || makeAddr(&sa, addr, port))
+    {
+        return -1;
+    }
+    u->maxpacketsize = (maxpacketsize + 3) & ~3;
+    u->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(u->fd < 0)
+    {
+        return -1;
+    }
+    if(bind(u->fd, (struct sockaddr *)&sa, sizeof(sa)))
+    {
+        close(u->fd);
+        u->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void ose_udp_close(struct ose_udp *u)
+{
+    if(u->fd >= 0)
+    {
+        close(u->fd);
+        u->fd = -1;
+    }
+}
+
+int ose_udp_setDestination(struct ose_udp *u,
+                           const char * const addr,
+                           uint16_t port)
+{
+    struct sockaddr_in sa;
+    if(!addr || makeAddr(&sa, addr, port))
+    {
+        return -1;
+    }
+    memcpy(&(u->dest), &sa, sizeof(sa));
+    u->destlen = sizeof(sa);
+    return 0;
+}
+
+/*
+  The datagrams are received into slots of the input's free space,
+  the first into the highest slot, so that after they've been
+  moved down to close the gaps between them, the last one received
+  is at the bottom and the first is on top. A bundle's messages
+  are written in reverse order, as #ose_popAllDrop would leave
+  them, which needs a copy of the bundle, so the slot above the
+  others is used as scratch space.
+*/
+int32_t ose_udp_receive(struct ose_udp *u,
+                        ose_bundle osevm,
+                        int32_t max,
+                        bool wait)
+{
+    struct mmsghdr msgs[OSE_UDP_MAX_BATCH];
+    struct iovec iovs[OSE_UDP_MAX_BATCH];
+    ose_bundle vm_i = OSEVM_INPUT(osevm);
+    char *b = ose_getBundlePtr(vm_i);
+    const int32_t s = ose_readSize(vm_i);
+    const int32_t slot = 4 + u->maxpacketsize;
+    int32_t k = ose_spaceAvailable(vm_i) / slot - 1;
+    char *scratch;
+    int32_t scratchused = 0;
+    int32_t w = s, n = 0;
+    int r, j;
+    if(k > max)
+    {
+        k = max;
+    }
+    if(k > OSE_UDP_MAX_BATCH)
+    {
+        k = OSE_UDP_MAX_BATCH;
+    }
+    if(k < 1)
+    {
+        return 0;
+    }
+    scratch = b + s + k * slot;
+    for(j = 0; j < k; j++)
+    {
+        iovs[j].iov_base = b + s + (k - 1 - j) * slot + 4;
+        iovs[j].iov_len = u->maxpacketsize;
+        memset(&(msgs[j].msg_hdr), 0, sizeof(struct msghdr));
+        msgs[j].msg_hdr.msg_iov = iovs + j;
+        msgs[j].msg_hdr.msg_iovlen = 1;
+    }
+    r = recvmmsg(u->fd, msgs, k,
+                 wait ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+    if(r < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    for(j = r - 1; j >= 0; j--)
+    {
+        const int32_t a = s + (k - 1 - j) * slot;
+        const int32_t size = msgs[j].msg_len;
+        const bool valid = !(msgs[j].msg_hdr.msg_flags & MSG_TRUNC)
+            && ose_validatePacket(b + a + 4, size);
+        if(valid
+           && !strncmp(b + a + 4, OSE_BUNDLE_ID, OSE_BUNDLE_ID_LEN))
+        {
+            const int32_t cs = size - OSE_BUNDLE_HEADER_LEN;
+            int32_t o = OSE_BUNDLE_HEADER_LEN;
+            int32_t ww = w + cs;
+            memcpy(scratch, b + a + 4, size);
+            if(size > scratchused)
+            {
+                scratchused = size;
+            }
+            while(o < size)
+            {
+                const int32_t ss = ose_ntohl(*((int32_t *)(scratch + o)));
+                ww -= ss + 4;
+                memcpy(b + ww, scratch + o, ss + 4);
+                o += ss + 4;
+            }
+            w += cs;
+            n++;
+        }
+        else if(valid)
+        {
+            memmove(b + w + 4, b + a + 4, size);
+            *((int32_t *)(b + w)) = ose_htonl(size);
+            w += size + 4;
+            n++;
+        }
+        /* clear whatever is left of the slot above the elements */
+        {
+            const int32_t lo = w > a ? w : a;
+            if(a + 4 + size > lo)
+            {
+                memset(b + lo, 0, a + 4 + size - lo);
+            }
+        }
+    }
+    memset(scratch, 0, scratchused);
+    ose_addToSize(vm_i, w - s);
+    return n;
+}
+
+int32_t ose_udp_flush(struct ose_udp *u, ose_bundle osevm)
+{
+    struct mmsghdr msgs[OSE_UDP_MAX_BATCH];
+    struct iovec iovs[OSE_UDP_MAX_BATCH];
+    int32_t ends[OSE_UDP_MAX_BATCH];
+    ose_bundle vm_o = OSEVM_OUTPUT(osevm);
+    char *b = ose_getBundlePtr(vm_o);
+    const int32_t s = ose_readSize(vm_o);
+    int32_t o = OSE_BUNDLE_HEADER_LEN;
+    /* the end of the elements that have been sent */
+    int32_t sent = OSE_BUNDLE_HEADER_LEN;
+    int32_t nsent = 0;
+    bool failed = false;
+    while(o < s && !failed)
+    {
+        int32_t k = 0, i = 0;
+        while(o < s && k < OSE_UDP_MAX_BATCH)
+        {
+            const int32_t ss = ose_readInt32(vm_o, o);
+            iovs[k].iov_base = b + o + 4;
+            iovs[k].iov_len = ss;
+            memset(&(msgs[k].msg_hdr), 0, sizeof(struct msghdr));
+            msgs[k].msg_hdr.msg_name = &(u->dest);
+            msgs[k].msg_hdr.msg_namelen = u->destlen;
+            msgs[k].msg_hdr.msg_iov = iovs + k;
+            msgs[k].msg_hdr.msg_iovlen = 1;
+            o += ss + 4;
+            ends[k] = o;
+            k++;
+        }
+        while(i < k)
+        {
+            const int r = sendmmsg(u->fd, msgs + i, k - i, 0);
+            if(r <= 0)
+            {
+                failed = true;
+                break;
+            }
+            i += r;
+        }
+        if(i > 0)
+        {
+            sent = ends[i - 1];
+        }
+        nsent += i;
+    }
+    /* remove what was sent, and keep the rest for the next flush */
+    if(sent > OSE_BUNDLE_HEADER_LEN)
+    {
+        const int32_t n = sent - OSE_BUNDLE_HEADER_LEN;
+        memmove(b + OSE_BUNDLE_HEADER_LEN, b + sent, s - sent);
+        memset(b + s - n, 0, n);
+        ose_decSize(vm_o, n);
+    }
+    return failed ? -1 : nsent;
+}
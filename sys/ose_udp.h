@@ -0,0 +1,118 @@
+/*
+  Copyright (c) 2019-21 John MacCallum Permission is hereby granted,
+  free of charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/** @file ose_udp.h
+    @brief Batched UDP input and output for a VM, using recvmmsg(2)
+    and sendmmsg(2).
+
+    #ose_udp_receive receives up to #OSE_UDP_MAX_BATCH datagrams
+    with one system call, straight into the free space of the VM's
+    input, and then frames them there as elements, so that running
+    the VM has the same result as inputting and running each of
+    them in turn. #ose_udp_flush sends every element of
+    the VM's output as a datagram, in batches, without copying
+    them.
+
+    This uses Linux-specific system calls.
+*/
+
+#ifndef OSE_UDP_H
+#define OSE_UDP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <sys/socket.h>
+#include "ose.h"
+
+#define OSE_UDP_MAX_BATCH 64
+
+struct ose_udp
+{
+    int fd;
+    /* largest datagram that will be received; longer ones are
+       dropped */
+    int32_t maxpacketsize;
+    struct sockaddr_storage dest;
+    socklen_t destlen;
+};
+
+/**
+   @brief Open a UDP socket bound to @p port on the IPv4 address
+   @p addr, or on every address if @p addr is NULL.
+
+   @returns 0 on success, -1 on failure.
+*/
+int ose_udp_open(struct ose_udp *u,
+                 const char * const addr,
+                 uint16_t port,
+                 int32_t maxpacketsize);
+void ose_udp_close(struct ose_udp *u);
+
+/**
+   @brief Set the IPv4 address and port that #ose_udp_flush sends
+   to.
+
+   @returns 0 on success, -1 if @p addr isn't an address.
+*/
+int ose_udp_setDestination(struct ose_udp *u,
+                           const char * const addr,
+                           uint16_t port);
+
+/**
+   @brief Receive up to @p max datagrams into the input of
+   @p osevm.
+
+   The datagrams are pushed onto the input in the order they
+   arrived, so they will be run in that order. Malformed and
+   truncated datagrams are dropped. Fewer datagrams are received
+   than asked for if the input doesn't have room for @p max of
+   the largest size, plus one more for scratch space. If @p wait
+   is true, this blocks until at least one datagram arrives.
+
+   @returns The number of packets added to the input, or -1 on
+   error.
+*/
+int32_t ose_udp_receive(struct ose_udp *u,
+                        ose_bundle osevm,
+                        int32_t max,
+                        bool wait);
+
+/**
+   @brief Send each element of the output of @p osevm as a
+   datagram to the destination, and remove the ones that were sent
+   from the output.
+
+   @returns The number of datagrams sent, or -1 if an error stopped
+   the flush before all of them were sent. The ones that weren't
+   are left in the output, in order, to be sent by the next flush.
+*/
+int32_t ose_udp_flush(struct ose_udp *u, ose_bundle osevm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,3 +1,6 @@
+/* sigsetjmp */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,14 +22,16 @@
 #define ANSI_COLOR_CYAN    "\x1b[36m"
 #define ANSI_COLOR_RESET   "\x1b[0m"
 
-jmp_buf env;
+/* the signal mask is saved, so that SIGABRT is unblocked again
+   after jumping out of the handler */
+sigjmp_buf env;
 const int32_t ASSERTION_FAILED = 0x66666666;
 const int32_t ASSERTION_PASSED = 0x33333333;
 
 void sighandler(int signo)
 {
 	if(signo == SIGABRT){
-		longjmp(env, ASSERTION_FAILED);
+		siglongjmp(env, ASSERTION_FAILED);
 	}
 }
 
@@ -261,7 +266,12 @@ char false256[256];
 
 void init(void)
 {
-	signal(SIGABRT, sighandler);
+	/* signal() may reset the handler after the first abort */
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = sighandler;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGABRT, &sa, NULL);
 	memset(true256, OSETT_TRUE, 256);
 	memset(false256, OSETT_FALSE, 256);
 	srand(time(NULL));
@@ -27,7 +27,7 @@ void printb(char *b)
 	{								\
 		testctr++;						\
 		int32_t r = ASSERTION_FAILED;				\
-		if(!setjmp(env)){					\
+		if(!sigsetjmp(env, 1)){				\
 			r = test;					\
 		}							\
 		if(r != expected_result){				\
@@ -80,12 +80,13 @@ void printb(char *b)
 		ose_bundle bundle = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf); \
 		if(b){							\
 			int32_t sizeofb = sizeof(b);			\
-			int32_t size1 = ose_readInt32(bundle, -4);	\
-			int32_t size2 = ose_readInt32(bundle, size1);	\
-			ose_writeInt32(bundle, size1, 0);		\
 			char *p = ose_getBundlePtr(bundle);		\
+			int32_t size1 = ose_readSize(bundle);		\
+			int32_t size2 = ose_ntohl(*((int32_t *)(p + size1))); \
+			*((int32_t *)(p + size1)) = 0;			\
 			memcpy(p - 4, b, sizeofb);			\
-			ose_writeInt32(bundle, sizeofb - 5, size2 - (sizeofb - 20)); \
+			*((int32_t *)(p + sizeofb - 5))			\
+				= ose_htonl(size2 - (sizeofb - 20));	\
 		}else{							\
 		}							\
 		if(verbose){						\
@@ -1,6 +1,8 @@
 #include "common.h"
 #include "ut_common.h"
 #include "../ose_stackops.h"
+#include "../ose_errno.h"
+#include "../ose_lz.h"
 
 void ut_ose_pushInt32(void)
 {
@@ -1047,14 +1049,90 @@ void ut_ose_clearPayload(void)
 void ut_ose_pop(void)
 {
 
+}
+/* /foo 1 2 three */
+static void pushFoo(ose_bundle bundle)
+{
+	ose_pushMessage(bundle, "/foo", 4, 3,
+			OSETT_INT32, 1,
+			OSETT_INT32, 2,
+			OSETT_STRING, "three");
+}
+/* a bundle of two anonymous messages, 1 and 2 */
+static void pushOneTwo(ose_bundle bundle)
+{
+	ose_pushBundle(bundle);
+	ose_pushInt32(bundle, 1);
+	ose_push(bundle);
+	ose_pushInt32(bundle, 2);
+	ose_push(bundle);
+}
+static int32_t countElems(ose_bundle bundle)
+{
+	ose_countElems(bundle);
+	return ose_popInt32(bundle);
 }
 void ut_ose_popAll(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_popAll(bundle),
+					   strcmp(ose_peekAddress(bundle), "/foo")),
+					  0,
+					  "address comes last");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_popAll(bundle),
+					   countElems(bundle)),
+					  4,
+					  "one element per item, plus the address");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_popAll(bundle),
+					   ose_drop(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "items in reverse order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_popAll(bundle),
+					   ose_peekType(bundle)),
+					  OSETT_BUNDLE,
+					  "empty bundle comes last");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_popAll(bundle),
+					   ose_drop(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "elements in reverse order");
 }
 void ut_ose_popAllDrop(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_popAllDrop(bundle),
+					   countElems(bundle)),
+					  3,
+					  "one element per item");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_popAllDrop(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "items in reverse order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_popAllDrop(bundle),
+					   countElems(bundle)),
+					  2,
+					  "one element per element");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_popAllDrop(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "elements in reverse order");
 }
 void ut_ose_popAllBundle(void)
 {
@@ -1067,14 +1145,312 @@ void ut_ose_popAllDropBundle(void)
 void ut_ose_push(void)
 {
 
+}
+/* an int, a float, a string, or a blob, depending on i */
+static void pushMixedItem(ose_bundle bundle, int32_t i)
+{
+	switch(i % 4){
+	case 0:
+		ose_pushInt32(bundle, i);
+		break;
+	case 1:
+		ose_pushFloat(bundle, i);
+		break;
+	case 2:
+		ose_pushString(bundle, "item");
+		break;
+	case 3:
+		ose_pushBlob(bundle, 3, "\x01\x02\x03");
+		break;
+	}
+}
+static int32_t compareBundles(ose_bundle a, ose_bundle b)
+{
+	if(ose_readSize(a) != ose_readSize(b)){
+		return -1;
+	}
+	return memcmp(ose_getBundlePtr(a),
+		      ose_getBundlePtr(b),
+		      ose_readSize(a));
+}
+/* builds /foo with n mixed items as an open message, seals it, and
+   compares it with the same message built with ose_push, both
+   pushed on top of pushFoo if below is true */
+static int32_t openMessageMatchesPush(ose_bundle bundle,
+				      int32_t n,
+				      bool below)
+{
+	char buf[MAX_BNDLSIZE];
+	ose_bundle ref = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf);
+	int32_t i;
+	if(below){
+		pushFoo(bundle);
+		pushFoo(ref);
+	}
+	ose_pushMessage(ref, "/foo", 4, 0);
+	for(i = 0; i < n; i++){
+		pushMixedItem(ref, i);
+		ose_push(ref);
+	}
+	ose_pushOpenMessage(bundle, "/foo", 4, 0);
+	for(i = 0; i < n; i++){
+		pushMixedItem(bundle, i);
+		ose_pushToOpenMessage(bundle);
+	}
+	ose_sealMessage(bundle);
+	return compareBundles(bundle, ref);
+}
+/* /foo 1 "three" <blob 1 2 3> 2.5, as an open message */
+static void pushOpenFoo(ose_bundle bundle)
+{
+	ose_pushOpenMessage(bundle, "/foo", 4, 0);
+	ose_pushInt32(bundle, 1);
+	ose_pushToOpenMessage(bundle);
+	ose_pushString(bundle, "three");
+	ose_pushToOpenMessage(bundle);
+	ose_pushBlob(bundle, 3, "\x01\x02\x03");
+	ose_pushToOpenMessage(bundle);
+	ose_pushFloat(bundle, 2.5);
+	ose_pushToOpenMessage(bundle);
+}
+/* pops the last two items of pushOpenFoo, and seals the rest */
+static int32_t popTwoAndSeal(ose_bundle bundle)
+{
+	char buf[MAX_BNDLSIZE];
+	ose_bundle ref = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf);
+	ose_pushMessage(ref, "/foo", 4, 2,
+			OSETT_INT32, 1,
+			OSETT_STRING, "three");
+	pushOpenFoo(bundle);
+	ose_popFromOpenMessage(bundle);
+	ose_drop(bundle);
+	ose_popFromOpenMessage(bundle);
+	ose_drop(bundle);
+	ose_sealMessage(bundle);
+	return compareBundles(bundle, ref);
+}
+void ut_ose_pushOpenMessage(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  openMessageMatchesPush(bundle, 1, false),
+					  0,
+					  "one item");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  openMessageMatchesPush(bundle, 4, false),
+					  0,
+					  "one item of each type");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  openMessageMatchesPush(bundle, 41, false),
+					  0,
+					  "enough items to grow the typetags "
+					  "three times");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  openMessageMatchesPush(bundle, 41, true),
+					  0,
+					  "with an element below it");
+}
+void ut_ose_popFromOpenMessage(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOpenFoo(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_peekFloat(bundle) == 2.5),
+					  1,
+					  "fixed size item");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOpenFoo(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_drop(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   memcmp(ose_peekBlob(bundle),
+						  "\0\0\0\x03\x01\x02\x03\0",
+						  8)),
+					  0,
+					  "blob");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOpenFoo(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_drop(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_drop(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   strcmp(ose_peekString(bundle), "three")),
+					  0,
+					  "string");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOpenFoo(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_drop(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_drop(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_drop(bundle),
+					   ose_popFromOpenMessage(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "first item, after the variable "
+					  "length ones");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  popTwoAndSeal(bundle),
+					  0,
+					  "seals to what's left");
+}
+void ut_ose_sealMessage(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  openMessageMatchesPush(bundle, 0, false),
+					  0,
+					  "empty open message");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushOpenMessage(bundle, "/foo",
+							       4, 16),
+					   ose_sealMessage(bundle),
+					   memcmp(ose_getBundlePtr(bundle)
+						  + OSE_BUNDLE_HEADER_LEN,
+						  "\0\0\0\x0c/foo\0\0\0\0,\0\0\0",
+						  16)),
+					  0,
+					  "empty open message with room "
+					  "reserved");
+}
+/* applies fused to bundle, and first then second to a copy of it
+   built by setup, and compares the two */
+static int32_t fusedMatches(ose_bundle bundle,
+			    void (*setup)(ose_bundle),
+			    void (*fused)(ose_bundle),
+			    void (*first)(ose_bundle),
+			    void (*second)(ose_bundle))
+{
+	char buf[MAX_BNDLSIZE];
+	ose_bundle ref = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf);
+	setup(bundle);
+	setup(ref);
+	fused(bundle);
+	first(ref);
+	second(ref);
+	return compareBundles(bundle, ref);
+}
+/* /foo 1 2 three, 5, /foo 1 2 three */
+static void pushFooFiveFoo(ose_bundle bundle)
+{
+	pushFoo(bundle);
+	ose_pushInt32(bundle, 5);
+	pushFoo(bundle);
+}
+/* /foo 1 2 three, then a bundle of 1 and 2 */
+static void pushFooOneTwo(ose_bundle bundle)
+{
+	pushFoo(bundle);
+	pushOneTwo(bundle);
+}
+/* /foo 1 2 three, then the one item message 5 */
+static void pushFooFive(ose_bundle bundle)
+{
+	pushFoo(bundle);
+	ose_pushInt32(bundle, 5);
+}
+void ut_ose_popSwap(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFooFiveFoo,
+						       ose_popSwap,
+						       ose_pop, ose_swap),
+					  0,
+					  "message with several items");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFooFive,
+						       ose_popSwap,
+						       ose_pop, ose_swap),
+					  0,
+					  "message with one item");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFooOneTwo,
+						       ose_popSwap,
+						       ose_pop, ose_swap),
+					  0,
+					  "bundle");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushOneTwo,
+						       ose_popSwap,
+						       ose_pop, ose_swap),
+					  0,
+					  "bundle that is the only element");
 }
 void ut_ose_unpack(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_unpack(bundle),
+					   countElems(bundle)),
+					  4,
+					  "one element per item, plus the address");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_unpack(bundle),
+					   strcmp(ose_peekString(bundle), "three")),
+					  0,
+					  "items in order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_dup(bundle),
+					   ose_unpack(bundle),
+					   ose_push(bundle),
+					   ose_push(bundle),
+					   ose_push(bundle),
+					   ose_eql(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "pushing the items back gives the message");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_unpack(bundle),
+					   ose_peekInt32(bundle)),
+					  2,
+					  "elements in order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_unpack(bundle),
+					   countElems(bundle)),
+					  3,
+					  "elements, plus the empty bundle");
 }
 void ut_ose_unpackDrop(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_unpackDrop(bundle),
+					   countElems(bundle)),
+					  3,
+					  "one element per item");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushFoo(bundle),
+					   ose_unpackDrop(bundle),
+					   strcmp(ose_peekString(bundle), "three")),
+					  0,
+					  "items in order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushOneTwo(bundle),
+					   ose_dup(bundle),
+					   ose_unpackDrop(bundle),
+					   ose_pushInt32(bundle, 2),
+					   ose_bundleFromTop(bundle),
+					   ose_eql(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "bundling the elements gives the bundle");
+#ifdef OSE_PROVIDE_TYPE_DOUBLE
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushMessage(bundle, "/foo", 4, 0),
+					   ose_pushDouble(bundle, 0.25),
+					   ose_push(bundle),
+					   ose_pushInt32(bundle, 1),
+					   ose_push(bundle),
+					   ose_unpackDrop(bundle),
+					   ose_drop(bundle),
+					   ose_peekDouble(bundle) == 0.25),
+					  1,
+					  "extended types are copied intact");
+#endif
 }
 void ut_ose_unpackBundle(void)
 {
@@ -1232,6 +1608,182 @@ void ut_ose_swap8Bytes(void)
 void ut_ose_swapNBytes(void)
 {
 
+}
+#if defined(OSE_PROVIDE_TYPE_DOUBLE) && defined(OSE_PROVIDE_TYPE_INT64)
+/* /foo 1 2.5 "str" 0.125 -2 <blob 1 2 3 4 5> 0x0102030405060708 */
+static void pushSwapItems(ose_bundle bundle)
+{
+	ose_pushMessage(bundle, "/foo", 4, 0);
+	ose_pushInt32(bundle, 1);
+	ose_push(bundle);
+	ose_pushFloat(bundle, 2.5);
+	ose_push(bundle);
+	ose_pushString(bundle, "str");
+	ose_push(bundle);
+	ose_pushDouble(bundle, 0.125);
+	ose_push(bundle);
+	ose_pushInt32(bundle, -2);
+	ose_push(bundle);
+	ose_pushBlob(bundle, 5, "\x01\x02\x03\x04\x05");
+	ose_push(bundle);
+	ose_pushInt64(bundle, 0x0102030405060708LL);
+	ose_push(bundle);
+}
+/* swaps the items of pushSwapItems, and returns 0 if the 4 and
+   8-byte numbers match ose_htonl and ose_htonll of what they were,
+   and everything else is unchanged */
+static int32_t swapItemsMatches(ose_bundle bundle)
+{
+	/* payload offsets of each item, and of the end */
+	static const int32_t offsets[] = {0, 4, 8, 12, 20, 24, 36, 44};
+	static const char * const tt = "ifsdibh";
+	char before[MAX_BNDLSIZE];
+	pushSwapItems(bundle);
+	const int32_t o = ose_getLastBundleElemOffset(bundle);
+	const int32_t po = ose_getBundleElemPayloadOffset(bundle, o);
+	const char * const b = ose_getBundlePtr(bundle);
+	memcpy(before, b, po + offsets[7]);
+	ose_swapItemsByteOrder(bundle);
+	if(memcmp(before, b, po)){
+		return -1;
+	}
+	for(int32_t i = 0; i < 7; i++){
+		const int32_t io = po + offsets[i];
+		const int32_t s = offsets[i + 1] - offsets[i];
+		if(tt[i] == 's' || tt[i] == 'b'){
+			if(memcmp(before + io, b + io, s)){
+				return i + 1;
+			}
+		}else if(s == 4){
+			uint32_t x, y;
+			memcpy(&x, before + io, 4);
+			memcpy(&y, b + io, 4);
+			if(y != ose_htonl(x)){
+				return i + 1;
+			}
+		}else{
+			uint64_t x, y;
+			memcpy(&x, before + io, 8);
+			memcpy(&y, b + io, 8);
+			if(y != ose_htonll(x)){
+				return i + 1;
+			}
+		}
+	}
+	return 0;
+}
+/* swaps the items of pushSwapItems twice, and compares the result
+   with the original */
+static int32_t swapItemsTwice(ose_bundle bundle)
+{
+	char buf[MAX_BNDLSIZE];
+	ose_bundle ref = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf);
+	pushSwapItems(ref);
+	pushSwapItems(bundle);
+	ose_swapItemsByteOrder(bundle);
+	ose_swapItemsByteOrder(bundle);
+	return compareBundles(bundle, ref);
+}
+#endif
+/* swaps a blob of n bytes, 1 to n, in words of width bytes, and
+   returns 0 if each word matches the same word byte reversed */
+static int32_t swapBlobMatches(ose_bundle bundle, int32_t n, int32_t width)
+{
+	char data[64];
+	for(int32_t i = 0; i < n; i++){
+		data[i] = (char)(i + 1);
+	}
+	ose_pushBlob(bundle, n, data);
+	if(width == 4){
+		ose_swapBlobByteOrder32(bundle);
+	}else{
+		ose_swapBlobByteOrder64(bundle);
+	}
+	const char * const p = ose_peekBlob(bundle) + 4;
+	for(int32_t i = 0; i < n; i += width){
+		for(int32_t j = 0; j < width; j++){
+			if(p[i + j] != data[i + width - 1 - j]){
+				return i + j + 1;
+			}
+		}
+	}
+	return 0;
+}
+void ut_ose_swapItemsByteOrder(void)
+{
+#if defined(OSE_PROVIDE_TYPE_DOUBLE) && defined(OSE_PROVIDE_TYPE_INT64)
+	if(ose_htonl(1) == 1){
+		/* nothing to swap on a big-endian host */
+		return;
+	}
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  swapItemsMatches(bundle),
+					  0,
+					  "i f s d i b h, same as swapping "
+					  "each item");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  swapItemsTwice(bundle),
+					  0,
+					  "swapping twice is the identity");
+#endif
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 1),
+					   ose_swapItemsByteOrder(bundle),
+					   ose_peekInt32(bundle)),
+					  ose_htonl(1),
+					  "one int32");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   ose_swapItemsByteOrder(bundle),
+					   0),
+					  ASSERTION_FAILED,
+					  "bundle");
+}
+void ut_ose_swapBlobByteOrder32(void)
+{
+	if(ose_htonl(1) == 1){
+		return;
+	}
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  swapBlobMatches(bundle, 0, 4),
+					  0,
+					  "empty blob");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  swapBlobMatches(bundle, 24, 4),
+					  0,
+					  "6 words");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, 6, NULL),
+					   ose_swapBlobByteOrder32(bundle),
+					   0),
+					  ASSERTION_FAILED,
+					  "size not a multiple of 4");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 1),
+					   ose_swapBlobByteOrder32(bundle),
+					   0),
+					  ASSERTION_FAILED,
+					  "not a blob");
+}
+void ut_ose_swapBlobByteOrder64(void)
+{
+	if(ose_htonl(1) == 1){
+		return;
+	}
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  swapBlobMatches(bundle, 0, 8),
+					  0,
+					  "empty blob");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  swapBlobMatches(bundle, 24, 8),
+					  0,
+					  "3 words");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, 12, NULL),
+					   ose_swapBlobByteOrder64(bundle),
+					   0),
+					  ASSERTION_FAILED,
+					  "size not a multiple of 8");
 }
 void ut_ose_trimBlob(void)
 {
@@ -1250,6 +1802,770 @@ void ut_ose_pmatch(void)
 
 }
 
+/* pushes a message with one int onto the bundle below it */
+static void pushKeyed(ose_bundle bundle, const char * const addr, int32_t v)
+{
+	ose_pushMessage(bundle, addr, strlen(addr), 1, OSETT_INT32, v);
+	ose_push(bundle);
+}
+/* the addresses of the elements of the bundle on top, in order */
+static const char *addresses(ose_bundle bundle)
+{
+	static char buf[256];
+	const char * const b = ose_getBundlePtr(bundle);
+	const int32_t o = ose_getLastBundleElemOffset(bundle);
+	const int32_t s = ose_readInt32(bundle, o);
+	int32_t eo = o + 4 + OSE_BUNDLE_HEADER_LEN;
+	buf[0] = 0;
+	while(eo < o + 4 + s){
+		strcat(buf, b + eo + 4);
+		eo += ose_readInt32(bundle, eo) + 4;
+	}
+	return buf;
+}
+/* a bundle of n elements, /t 20, /s 19, ... for n = 20 */
+static void pushCountdown(ose_bundle bundle, int32_t n)
+{
+	char addr[3] = "/a";
+	int32_t i;
+	ose_pushBundle(bundle);
+	for(i = 0; i < n; i++){
+		addr[1] = 'a' + (n - 1 - i);
+		pushKeyed(bundle, addr, n - i);
+	}
+}
+void ut_ose_sort(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/c", 3),
+					   pushKeyed(bundle, "/a", 1),
+					   pushKeyed(bundle, "/b", 2),
+					   ose_sort(bundle),
+					   strcmp(addresses(bundle), "/a/b/c")),
+					  0,
+					  "smallest first");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/a", 1),
+					   pushKeyed(bundle, "/b", 0),
+					   pushKeyed(bundle, "/c", 1),
+					   pushKeyed(bundle, "/d", 0),
+					   ose_sort(bundle),
+					   strcmp(addresses(bundle), "/b/d/a/c")),
+					  0,
+					  "equal keys keep their order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/a", 0),
+					   pushKeyed(bundle, "/b", -5),
+					   pushKeyed(bundle, "/c", INT32_MIN),
+					   ose_sort(bundle),
+					   strcmp(addresses(bundle), "/c/b/a")),
+					  0,
+					  "negative keys");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/a", 2),
+					   ose_pushMessage(bundle, "/b", 2, 1,
+							   OSETT_FLOAT, 1.5),
+					   ose_push(bundle),
+					   pushKeyed(bundle, "/c", 1),
+					   ose_sort(bundle),
+					   strcmp(addresses(bundle), "/c/b/a")),
+					  0,
+					  "int and float keys");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   ose_pushMessage(bundle, "/a", 2, 1,
+							   OSETT_STRING, "a"),
+					   ose_push(bundle),
+					   pushKeyed(bundle, "/b", 2),
+					   pushKeyed(bundle, "/c", 1),
+					   ose_sort(bundle),
+					   strcmp(addresses(bundle), "/c/b/a")),
+					  0,
+					  "elements with no numeric item come last");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   ose_sort(bundle),
+					   countElems(bundle)),
+					  1,
+					  "empty bundle");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushCountdown(bundle, 20),
+					   ose_sort(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE
+					   && addresses(bundle)[1] == 'a' + 19),
+					  1,
+					  "no room for the index");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushCountdown(bundle, 8),
+					   ose_sort(bundle),
+					   strcmp(addresses(bundle), "/a/b/c/d/e/f/g/h")),
+					  0,
+					  "reversed input");
+}
+void ut_ose_sortByAddress(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/b", 1),
+					   pushKeyed(bundle, "/ab", 2),
+					   pushKeyed(bundle, "/a", 3),
+					   ose_sortByAddress(bundle),
+					   strcmp(addresses(bundle), "/a/ab/b")),
+					  0,
+					  "addresses in order");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/b", 1),
+					   pushKeyed(bundle, "/a", 2),
+					   pushKeyed(bundle, "/b", 3),
+					   ose_sortByAddress(bundle),
+					   ose_popAllDrop(bundle),
+					   ose_drop(bundle),
+					   ose_drop(bundle),
+					   ose_peekInt32(bundle)),
+					  3,
+					  "equal addresses keep their order");
+}
+void ut_ose_sortByItem(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   ose_pushMessage(bundle, "/a", 2, 2,
+							   OSETT_INT32, 1,
+							   OSETT_INT32, 3),
+					   ose_push(bundle),
+					   ose_pushMessage(bundle, "/b", 2, 2,
+							   OSETT_INT32, 2,
+							   OSETT_INT32, 2),
+					   ose_push(bundle),
+					   ose_pushMessage(bundle, "/c", 2, 1,
+							   OSETT_INT32, 0),
+					   ose_push(bundle),
+					   ose_pushInt32(bundle, 1),
+					   ose_sortByItem(bundle),
+					   strcmp(addresses(bundle), "/b/a/c")),
+					  0,
+					  "by the second item, missing ones last");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushCountdown(bundle, 3),
+					   ose_pushInt32(bundle, -1),
+					   ose_sortByItem(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "negative index");
+}
+void ut_ose_topK(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/a", 5),
+					   pushKeyed(bundle, "/b", 1),
+					   pushKeyed(bundle, "/c", 4),
+					   pushKeyed(bundle, "/d", 2),
+					   pushKeyed(bundle, "/e", 3),
+					   ose_pushInt32(bundle, 2),
+					   ose_topK(bundle),
+					   strcmp(addresses(bundle), "/a/c")),
+					  0,
+					  "the k largest, largest first");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushCountdown(bundle, 3),
+					   ose_pushInt32(bundle, 5),
+					   ose_topK(bundle),
+					   strcmp(addresses(bundle), "/c/b/a")),
+					  0,
+					  "k larger than the bundle");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushCountdown(bundle, 3),
+					   ose_pushInt32(bundle, 0),
+					   ose_topK(bundle),
+					   countElems(bundle)),
+					  1,
+					  "k of 0 leaves an empty bundle");
+}
+/* a dictionary of /a 1 and /b 2 */
+static void pushDictAB(ose_bundle bundle)
+{
+	ose_pushBundle(bundle);
+	pushKeyed(bundle, "/a", 1);
+	pushKeyed(bundle, "/b", 2);
+	ose_toDict(bundle);
+}
+static int32_t dictGetInt32(ose_bundle bundle, const char * const addr)
+{
+	ose_pushString(bundle, addr);
+	ose_dictGet(bundle);
+	return ose_popInt32(bundle);
+}
+static void dictPutInt32(ose_bundle bundle, const char * const addr,
+			 int32_t v)
+{
+	ose_pushInt32(bundle, v);
+	ose_pushString(bundle, addr);
+	ose_dictPut(bundle);
+}
+/* puts n entries, enough to grow the index, and returns how many
+   of them can be found again */
+static int32_t dictPutMany(ose_bundle bundle, int32_t n)
+{
+	char addr[8];
+	int32_t i, found = 0;
+	ose_pushBundle(bundle);
+	ose_toDict(bundle);
+	for(i = 0; i < n; i++){
+		snprintf(addr, sizeof(addr), "/k%d", i);
+		dictPutInt32(bundle, addr, i);
+	}
+	for(i = 0; i < n; i++){
+		snprintf(addr, sizeof(addr), "/k%d", i);
+		found += dictGetInt32(bundle, addr) == i;
+	}
+	return found;
+}
+void ut_ose_toDict(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   strcmp(addresses(bundle),
+						  OSE_DICT_INDEX_ADDRESS "/a/b")),
+					  0,
+					  "index comes first");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_toDict(bundle),
+					   strcmp(addresses(bundle),
+						  OSE_DICT_INDEX_ADDRESS "/a/b")),
+					  0,
+					  "rebuilding keeps a single index");
+}
+void ut_ose_dictGet(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   dictGetInt32(bundle, "/b")),
+					  2,
+					  "found");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_pushString(bundle, "/z"),
+					   ose_dictGet(bundle),
+					   memcmp(ose_peekAddress(bundle),
+						  OSE_ADDRESS_ANONVAL,
+						  OSE_ADDRESS_ANONVAL_SIZE)),
+					  0,
+					  "missing");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/a", 1),
+					   dictGetInt32(bundle, "/a")),
+					  1,
+					  "plain bundle");
+}
+void ut_ose_dictPut(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   dictPutInt32(bundle, "/c", 3),
+					   dictGetInt32(bundle, "/c")),
+					  3,
+					  "new entry");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   dictPutInt32(bundle, "/a", 10),
+					   strcmp(addresses(bundle),
+						  OSE_DICT_INDEX_ADDRESS "/a/b")),
+					  0,
+					  "replaced in place");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_pushString(bundle, "a longer value"),
+					   ose_pushString(bundle, "/a"),
+					   ose_dictPut(bundle),
+					   dictGetInt32(bundle, "/b")),
+					  2,
+					  "entries after a larger one are still found");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  dictPutMany(bundle, 20),
+					  20,
+					  "index grows");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   dictPutInt32(bundle, "/a", 1),
+					   strcmp(addresses(bundle), "/a")),
+					  0,
+					  "plain bundle");
+}
+void ut_ose_dictDelete(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_pushString(bundle, "/a"),
+					   ose_dictDelete(bundle),
+					   strcmp(addresses(bundle),
+						  OSE_DICT_INDEX_ADDRESS "/b")),
+					  0,
+					  "removed");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_pushString(bundle, "/a"),
+					   ose_dictDelete(bundle),
+					   dictGetInt32(bundle, "/b")),
+					  2,
+					  "later entries are still found");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_pushString(bundle, "/a"),
+					   ose_dictDelete(bundle),
+					   dictPutInt32(bundle, "/a", 3),
+					   dictGetInt32(bundle, "/a")),
+					  3,
+					  "put after delete");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushDictAB(bundle),
+					   ose_pushString(bundle, "/z"),
+					   ose_dictDelete(bundle),
+					   strcmp(addresses(bundle),
+						  OSE_DICT_INDEX_ADDRESS "/a/b")),
+					  0,
+					  "missing");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBundle(bundle),
+					   pushKeyed(bundle, "/a", 1),
+					   pushKeyed(bundle, "/b", 2),
+					   ose_pushString(bundle, "/a"),
+					   ose_dictDelete(bundle),
+					   strcmp(addresses(bundle), "/b")),
+					  0,
+					  "plain bundle");
+}
+static int32_t topBlobSize(ose_bundle bundle)
+{
+	return ose_ntohl(*((int32_t *)ose_peekBlob(bundle)));
+}
+/* a blob of n bytes that repeat every 8 */
+static void pushRepetitiveBlob(ose_bundle bundle, int32_t n)
+{
+	int32_t i;
+	ose_pushBlob(bundle, n, NULL);
+	char * const p = ose_peekBlob(bundle) + 4;
+	for(i = 0; i < n; i++){
+		p[i] = "abcdefgh"[i % 8];
+	}
+}
+void ut_ose_compressBlob(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushRepetitiveBlob(bundle, 200),
+					   ose_compressBlob(bundle),
+					   topBlobSize(bundle) < 200),
+					  1,
+					  "repetitive data shrinks");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushRepetitiveBlob(bundle, 200),
+					   ose_dup(bundle),
+					   ose_compressBlob(bundle),
+					   ose_decompressBlob(bundle),
+					   ose_eql(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "round trip");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, 64,
+							(const char *)all_chars + 64),
+					   ose_dup(bundle),
+					   ose_compressBlob(bundle),
+					   ose_decompressBlob(bundle),
+					   ose_eql(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "round trip of incompressible data");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, 0, NULL),
+					   ose_dup(bundle),
+					   ose_compressBlob(bundle),
+					   ose_decompressBlob(bundle),
+					   ose_eql(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "round trip of an empty blob");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushRepetitiveBlob(bundle, 600),
+					   ose_compressBlob(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE
+					   && topBlobSize(bundle) == 600),
+					  1,
+					  "no room for the bound");
+}
+void ut_ose_decompressBlob(void)
+{
+	char big[4000];
+	char z[128];
+	memset(big, 0, sizeof(big));
+	const int32_t zn = ose_lz_compress(big, sizeof(big), z, sizeof(z));
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, zn, z),
+					   ose_decompressBlob(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE
+					   && topBlobSize(bundle) == zn),
+					  1,
+					  "no room for the result");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, 8,
+							"\0\0\0\x10\xff\xff\xff\xff"),
+					   ose_decompressBlob(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE
+					   && topBlobSize(bundle) == 8),
+					  1,
+					  "malformed");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushBlob(bundle, 2, "\0\0"),
+					   ose_decompressBlob(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "shorter than the header");
+}
+/* a bundle with a message /x c for each character c of keys,
+   where x is c in lower case */
+static void pushLetters(ose_bundle bundle, const char *keys)
+{
+	char addr[3] = "/a";
+	ose_pushBundle(bundle);
+	for(; *keys; keys++){
+		addr[1] = *keys | 0x20;
+		pushKeyed(bundle, addr, *keys);
+	}
+}
+/* diffs from against to, patches from, and compares the result
+   with to */
+static int32_t diffPatch(ose_bundle bundle,
+			 const char * const from,
+			 const char * const to)
+{
+	pushLetters(bundle, from);
+	pushLetters(bundle, from);
+	pushLetters(bundle, to);
+	ose_diff(bundle);
+	ose_nip(bundle);
+	ose_patch(bundle);
+	pushLetters(bundle, to);
+	ose_eql(bundle);
+	return ose_popInt32(bundle);
+}
+void ut_ose_diff(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "abcd", "abcd"),
+					  1,
+					  "identical");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "abcd", "abxcd"),
+					  1,
+					  "insertion");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "abcd", "acd"),
+					  1,
+					  "deletion");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "abcd", "aBcD"),
+					  1,
+					  "replacement");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "abcd", "dabc"),
+					  1,
+					  "reordering");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "", "abc"),
+					  1,
+					  "from empty");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "abc", ""),
+					  1,
+					  "to empty");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  diffPatch(bundle, "aab", "aba"),
+					  1,
+					  "repeated addresses");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushLetters(bundle, "abcd"),
+					   pushLetters(bundle, "abcd"),
+					   ose_diff(bundle),
+					   strcmp(addresses(bundle), "")),
+					  0,
+					  "identical bundles give an empty patch");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushLetters(bundle, "abcd"),
+					   pushLetters(bundle, "aBcd"),
+					   ose_diff(bundle),
+					   strcmp(addresses(bundle),
+						  "/skip/replace/b")),
+					  0,
+					  "only the replaced element is carried");
+}
+void ut_ose_patch(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushLetters(bundle, "abcd"),
+					   pushLetters(bundle, "abxd"),
+					   ose_diff(bundle),
+					   ose_nip(bundle),
+					   pushLetters(bundle, "ab"),
+					   ose_swap(bundle),
+					   ose_patch(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE
+					   && countElems(bundle) == 2),
+					  1,
+					  "patch doesn't fit");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (pushLetters(bundle, "abcd"),
+					   pushLetters(bundle, "abxd"),
+					   ose_diff(bundle),
+					   ose_nip(bundle),
+					   pushLetters(bundle, "ab"),
+					   ose_swap(bundle),
+					   ose_patch(bundle),
+					   ose_drop(bundle),
+					   strcmp(addresses(bundle), "/a/b")),
+					  0,
+					  "patch doesn't fit, bundle unchanged");
+}
+static int32_t parallelForCalls;
+/* stands in for a thread pool: runs the iterations one at a time,
+   last first, in the calling thread */
+static void serialParallelFor(int32_t n, ose_parallelfn fn, void *context)
+{
+	parallelForCalls++;
+	for(int32_t i = n - 1; i >= 0; i--){
+		fn(context, i, i + 1);
+	}
+}
+/* applies par to bundle with serialParallelFor installed, and seq
+   to a copy of it built by setup, and compares the two */
+static int32_t parallelMatches(ose_bundle bundle,
+			       void (*setup)(ose_bundle),
+			       void (*par)(ose_bundle),
+			       void (*seq)(ose_bundle))
+{
+	char buf[MAX_BNDLSIZE];
+	ose_bundle ref = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf);
+	setup(bundle);
+	setup(ref);
+	parallelForCalls = 0;
+	ose_setParallelFor(serialParallelFor);
+	par(bundle);
+	ose_setParallelFor(NULL);
+	seq(ref);
+	if(!parallelForCalls){
+		/* fell back on the sequential version */
+		return -1;
+	}
+	return compareBundles(bundle, ref);
+}
+/* a bundle of /foo/a 1, /foo/b 2, /bar 3, and /foo/a/c 4 */
+static void pushRoutable(ose_bundle bundle)
+{
+	ose_pushBundle(bundle);
+	ose_pushMessage(bundle, "/foo/a", 6, 1, OSETT_INT32, 1);
+	ose_push(bundle);
+	ose_pushMessage(bundle, "/foo/b", 6, 1, OSETT_INT32, 2);
+	ose_push(bundle);
+	ose_pushMessage(bundle, "/bar", 4, 1, OSETT_INT32, 3);
+	ose_push(bundle);
+	ose_pushMessage(bundle, "/foo/a/c", 8, 1, OSETT_INT32, 4);
+	ose_push(bundle);
+}
+static void pushRouteFoo(ose_bundle bundle)
+{
+	pushRoutable(bundle);
+	ose_pushString(bundle, "/foo");
+}
+static void pushRoutePattern(ose_bundle bundle)
+{
+	pushRoutable(bundle);
+	ose_pushString(bundle, "/foo/*");
+}
+static void pushRouteNothing(ose_bundle bundle)
+{
+	pushRoutable(bundle);
+	ose_pushString(bundle, "/baz");
+}
+static void pushGatherArgs(ose_bundle bundle)
+{
+	pushRoutable(bundle);
+	ose_pushMessage(bundle, OSE_ADDRESS_ANONVAL, OSE_ADDRESS_ANONVAL_LEN,
+			2, OSETT_STRING, "/bar", OSETT_STRING, "/foo/a");
+}
+void ut_ose_routeParallel(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  parallelMatches(bundle, pushRouteFoo,
+							  ose_routeParallel,
+							  ose_route),
+					  0,
+					  "prefix");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  parallelMatches(bundle,
+							  pushRoutePattern,
+							  ose_routeParallel,
+							  ose_route),
+					  0,
+					  "pattern");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  parallelMatches(bundle,
+							  pushRouteNothing,
+							  ose_routeParallel,
+							  ose_route),
+					  0,
+					  "no matches");
+}
+void ut_ose_routeWithDelegationParallel(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  parallelMatches(bundle, pushRouteFoo,
+							  ose_routeWithDelegationParallel,
+							  ose_routeWithDelegation),
+					  0,
+					  "prefix");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  parallelMatches(bundle,
+							  pushRouteNothing,
+							  ose_routeWithDelegationParallel,
+							  ose_routeWithDelegation),
+					  0,
+					  "no matches");
+}
+void ut_ose_gatherParallel(void)
+{
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  parallelMatches(bundle, pushGatherArgs,
+							  ose_gatherParallel,
+							  ose_gather),
+					  0,
+					  "two addresses");
+}
+/* /foo 1 2 three, 3, a bundle of 1 and 2, "four" */
+static void pushFourElems(ose_bundle bundle)
+{
+	pushFoo(bundle);
+	ose_pushInt32(bundle, 3);
+	pushOneTwo(bundle);
+	ose_pushString(bundle, "four");
+}
+/* a bundle of the words first, second, and third, as messages
+   with no items, or as anonymous messages with the word as their
+   only item if anon is true */
+static void pushCode(ose_bundle bundle,
+		     const char * const first,
+		     const char * const second,
+		     const char * const third,
+		     bool anon)
+{
+	const char * const words[] = {first, second, third};
+	ose_pushBundle(bundle);
+	for(int i = 0; i < 3; i++){
+		if(!words[i]){
+			continue;
+		}
+		if(anon){
+			ose_pushString(bundle, words[i]);
+		}else{
+			ose_pushMessage(bundle, words[i], strlen(words[i]), 0);
+		}
+		ose_push(bundle);
+	}
+}
+/* rewrites the code a b c with ose_peephole and compares it with
+   the code x y z */
+static int32_t peepholeGives(ose_bundle bundle,
+			     const char * const a,
+			     const char * const b,
+			     const char * const c,
+			     const char * const x,
+			     const char * const y,
+			     const char * const z,
+			     bool anon)
+{
+	char buf[MAX_BNDLSIZE];
+	ose_bundle ref = ose_newBundleFromCBytes(MAX_BNDLSIZE, buf);
+	pushCode(ref, x, y, z, anon);
+	pushCode(bundle, a, b, c, anon);
+	ose_peephole(bundle);
+	return compareBundles(bundle, ref);
+}
+void ut_ose_peephole(void)
+{
+	/* each superinstruction does what the pair it replaces does */
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFourElems,
+						       ose_nip,
+						       ose_swap, ose_drop),
+					  0,
+					  "nip is swap drop");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFourElems,
+						       ose_2dup,
+						       ose_over, ose_over),
+					  0,
+					  "2dup is over over");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFourElems,
+						       ose_notrot,
+						       ose_rot, ose_rot),
+					  0,
+					  "-rot is rot rot");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  fusedMatches(bundle, pushFooFiveFoo,
+						       ose_popSwap,
+						       ose_pop, ose_swap),
+					  0,
+					  "pop/swap is pop swap");
+
+	/* and the pass puts them in place of the pairs */
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  peepholeGives(bundle,
+							"/!/swap", "/!/drop",
+							"/!/dup",
+							"/!/nip", "/!/dup",
+							NULL, false),
+					  0,
+					  "swap drop");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  peepholeGives(bundle,
+							"/!/dup", "/!/over",
+							"/!/over",
+							"/!/dup", "/!/2dup",
+							NULL, true),
+					  0,
+					  "over over, anonymous");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  peepholeGives(bundle,
+							"/!/rot", "/!/rot",
+							"/!/rot",
+							"/!/-rot", "/!/rot",
+							NULL, false),
+					  0,
+					  "rot rot rot");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  peepholeGives(bundle,
+							"/!/pop", "/!/swap",
+							NULL,
+							"/!/pop/swap", NULL,
+							NULL, true),
+					  0,
+					  "pop swap, anonymous");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  peepholeGives(bundle,
+							"/!/swap", "/!/dup",
+							"/!/drop",
+							"/!/swap", "/!/dup",
+							"/!/drop", false),
+					  0,
+					  "no pairs");
+}
+
 /**************************************************
  * Creatio Ex Nihilo
  **************************************************/
@@ -1267,23 +2583,219 @@ void ut_ose_pushBundle(void)
  **************************************************/
 void ut_ose_add(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 3),
+					   ose_pushInt32(bundle, 4),
+					   ose_add(bundle),
+					   ose_peekInt32(bundle)),
+					  7,
+					  "int32 + int32");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 3),
+					   ose_pushInt32(bundle, 4),
+					   ose_add(bundle),
+					   ose_bundleHasAtLeastNElems(bundle, 2)),
+					  0,
+					  "operands are consumed");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 3),
+					   ose_pushFloat(bundle, 0.5),
+					   ose_add(bundle),
+					   ose_peekMessageArgType(bundle)),
+					  OSETT_FLOAT,
+					  "int32 + float promotes to float");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushFloat(bundle, 0.5),
+					   ose_pushInt32(bundle, 3),
+					   ose_add(bundle),
+					   ose_peekFloat(bundle) == 3.5),
+					  1,
+					  "float + int32 promotes to float");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushString(bundle, "3"),
+					   ose_pushInt32(bundle, 4),
+					   ose_add(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "non-numeric operand");
+#ifdef OSE_PROVIDE_TYPE_DOUBLE
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushFloat(bundle, 0.5),
+					   ose_pushDouble(bundle, 0.25),
+					   ose_add(bundle),
+					   ose_peekMessageArgType(bundle)),
+					  OSETT_DOUBLE,
+					  "float + double promotes to double");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 1),
+					   ose_pushDouble(bundle, 0.25),
+					   ose_add(bundle),
+					   ose_peekDouble(bundle) == 1.25),
+					  1,
+					  "int32 + double");
+#endif
+#ifdef OSE_PROVIDE_TYPE_INT64
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 1),
+					   ose_pushInt64(bundle, 0x100000000LL),
+					   ose_add(bundle),
+					   ose_peekInt64(bundle) == 0x100000001LL),
+					  1,
+					  "int32 + int64 promotes to int64");
+#endif
 }
 void ut_ose_sub(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 3),
+					   ose_pushInt32(bundle, 4),
+					   ose_sub(bundle),
+					   ose_peekInt32(bundle)),
+					  1,
+					  "top minus the one below");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushFloat(bundle, 4),
+					   ose_pushInt32(bundle, 3),
+					   ose_sub(bundle),
+					   ose_peekFloat(bundle) == -1),
+					  1,
+					  "int32 - float");
 }
 void ut_ose_mul(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, -3),
+					   ose_pushInt32(bundle, 4),
+					   ose_mul(bundle),
+					   ose_peekInt32(bundle)),
+					  -12,
+					  "int32 * int32");
+#ifdef OSE_PROVIDE_TYPE_DOUBLE
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushDouble(bundle, 0.5),
+					   ose_pushInt32(bundle, 3),
+					   ose_mul(bundle),
+					   ose_peekDouble(bundle) == 1.5),
+					  1,
+					  "int32 * double");
+#endif
 }
 void ut_ose_div(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 3),
+					   ose_pushInt32(bundle, 12),
+					   ose_div(bundle),
+					   ose_peekInt32(bundle)),
+					  4,
+					  "top divided by the one below");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushFloat(bundle, 4),
+					   ose_pushInt32(bundle, 2),
+					   ose_div(bundle),
+					   ose_peekFloat(bundle) == 0.5),
+					  1,
+					  "int32 / float");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 0),
+					   ose_pushInt32(bundle, 12),
+					   ose_div(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "division by zero sets the error");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 0),
+					   ose_pushInt32(bundle, 12),
+					   ose_div(bundle),
+					   ose_peekInt32(bundle)),
+					  12,
+					  "division by zero leaves the stack");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, -1),
+					   ose_pushInt32(bundle, INT32_MIN),
+					   ose_div(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "INT32_MIN / -1 sets the error");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, -1),
+					   ose_pushInt32(bundle, INT32_MIN + 1),
+					   ose_div(bundle),
+					   ose_peekInt32(bundle)),
+					  INT32_MAX,
+					  "INT32_MIN + 1 / -1");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushFloat(bundle, 0),
+					   ose_pushFloat(bundle, 1),
+					   ose_div(bundle),
+					   ose_errno_get(bundle)),
+					  OSE_ERR_NONE,
+					  "float division by zero is not an error");
+#ifdef OSE_PROVIDE_TYPE_INT64
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt64(bundle, 0),
+					   ose_pushInt32(bundle, 12),
+					   ose_div(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "int64 division by zero sets the error");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt64(bundle, -1),
+					   ose_pushInt64(bundle, INT64_MIN),
+					   ose_div(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "INT64_MIN / -1 sets the error");
+#endif
+#ifdef OSE_PROVIDE_TYPE_DOUBLE
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushDouble(bundle, 4),
+					   ose_pushDouble(bundle, 1),
+					   ose_div(bundle),
+					   ose_peekDouble(bundle) == 0.25),
+					  1,
+					  "double / double");
+#endif
 }
 void ut_ose_mod(void)
 {
-
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 5),
+					   ose_pushInt32(bundle, 12),
+					   ose_mod(bundle),
+					   ose_peekInt32(bundle)),
+					  2,
+					  "top modulo the one below");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, 0),
+					   ose_pushInt32(bundle, 12),
+					   ose_mod(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "modulo zero sets the error");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt32(bundle, -1),
+					   ose_pushInt32(bundle, INT32_MIN),
+					   ose_mod(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "INT32_MIN % -1 sets the error");
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushFloat(bundle, 2),
+					   ose_pushFloat(bundle, 5),
+					   ose_mod(bundle),
+					   ose_peekFloat(bundle) == 1),
+					  1,
+					  "float modulo");
+#ifdef OSE_PROVIDE_TYPE_INT64
+	UNIT_TEST_WITH_INITIALIZED_BUNDLE(NULL,
+					  (ose_pushInt64(bundle, -1),
+					   ose_pushInt64(bundle, INT64_MIN),
+					   ose_mod(bundle),
+					   ose_errno_get(bundle) != OSE_ERR_NONE),
+					  1,
+					  "INT64_MIN % -1 sets the error");
+#endif
 }
 void ut_ose_neg(void)
 {
@@ -1399,13 +2911,17 @@ int main(int ac, char **av)
 	SKIP_UNIT_TEST_FUNCTION(ose_clear, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_clearPayload, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_pop, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_popAll, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_popAllDrop, "");
+	UNIT_TEST_FUNCTION(ose_popAll);
+	UNIT_TEST_FUNCTION(ose_popAllDrop);
 	SKIP_UNIT_TEST_FUNCTION(ose_popAllBundle, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_popAllDropBundle, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_push, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_unpack, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_unpackDrop, "");
+	UNIT_TEST_FUNCTION(ose_pushOpenMessage);
+	UNIT_TEST_FUNCTION(ose_popFromOpenMessage);
+	UNIT_TEST_FUNCTION(ose_sealMessage);
+	UNIT_TEST_FUNCTION(ose_popSwap);
+	UNIT_TEST_FUNCTION(ose_unpack);
+	UNIT_TEST_FUNCTION(ose_unpackDrop);
 	SKIP_UNIT_TEST_FUNCTION(ose_unpackBundle, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_unpackDropBundle, "");
 
@@ -1452,10 +2968,29 @@ int main(int ac, char **av)
 	SKIP_UNIT_TEST_FUNCTION(ose_swap4Bytes, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_swap8Bytes, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_swapNBytes, "");
+	UNIT_TEST_FUNCTION(ose_swapItemsByteOrder);
+	UNIT_TEST_FUNCTION(ose_swapBlobByteOrder32);
+	UNIT_TEST_FUNCTION(ose_swapBlobByteOrder64);
 	SKIP_UNIT_TEST_FUNCTION(ose_trimBlob, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_trimString, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_match, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_pmatch, "");
+	UNIT_TEST_FUNCTION(ose_sort);
+	UNIT_TEST_FUNCTION(ose_sortByAddress);
+	UNIT_TEST_FUNCTION(ose_sortByItem);
+	UNIT_TEST_FUNCTION(ose_topK);
+	UNIT_TEST_FUNCTION(ose_toDict);
+	UNIT_TEST_FUNCTION(ose_dictGet);
+	UNIT_TEST_FUNCTION(ose_dictPut);
+	UNIT_TEST_FUNCTION(ose_dictDelete);
+	UNIT_TEST_FUNCTION(ose_compressBlob);
+	UNIT_TEST_FUNCTION(ose_decompressBlob);
+	UNIT_TEST_FUNCTION(ose_diff);
+	UNIT_TEST_FUNCTION(ose_patch);
+	UNIT_TEST_FUNCTION(ose_routeParallel);
+	UNIT_TEST_FUNCTION(ose_routeWithDelegationParallel);
+	UNIT_TEST_FUNCTION(ose_gatherParallel);
+	UNIT_TEST_FUNCTION(ose_peephole);
 
 	/**************************************************
 	 * Creatio Ex Nihilo
@@ -1466,11 +3001,11 @@ int main(int ac, char **av)
 	/**************************************************
 	 * Arithmetic
 	 **************************************************/
-	SKIP_UNIT_TEST_FUNCTION(ose_add, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_sub, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_mul, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_div, "");
-	SKIP_UNIT_TEST_FUNCTION(ose_mod, "");
+	UNIT_TEST_FUNCTION(ose_add);
+	UNIT_TEST_FUNCTION(ose_sub);
+	UNIT_TEST_FUNCTION(ose_mul);
+	UNIT_TEST_FUNCTION(ose_div);
+	UNIT_TEST_FUNCTION(ose_mod);
 	SKIP_UNIT_TEST_FUNCTION(ose_neg, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_eql, "");
 	SKIP_UNIT_TEST_FUNCTION(ose_lte, "");
@@ -1,5 +1,6 @@
 #include "common.h"
 #include "ut_common.h"
+#include "../ose_vm.h"
 
 void ut_ose_pnbytes(void)
 {
@@ -1629,6 +1630,83 @@ void ut_ose_getFirstOffsetForPMatch(void)
 	
 }
 
+void ut_ose_paddedStringsEqual(void)
+{
+	UNIT_TEST(ose_paddedStringsEqual(NULL, "abc"),
+		  ASSERTION_FAILED,
+		  "NULL pointer");
+	UNIT_TEST(ose_paddedStringsEqual("ab\0c", "ab\0\0"),
+		  ASSERTION_FAILED,
+		  "first string not NULL-padded");
+	UNIT_TEST(ose_paddedStringsEqual("ab\0\0", "ab\0c"),
+		  ASSERTION_FAILED,
+		  "second string not NULL-padded");
+	UNIT_TEST(ose_paddedStringsEqual("\0\0\0", "\0\0\0"),
+		  true,
+		  "empty strings");
+	UNIT_TEST(ose_paddedStringsEqual("abc", "abc"),
+		  true,
+		  "equal, one word");
+	UNIT_TEST(ose_paddedStringsEqual("/foo/bar/baz\0\0\0",
+					 "/foo/bar/baz\0\0\0"),
+		  true,
+		  "equal, 4n characters");
+	UNIT_TEST(ose_paddedStringsEqual("/foo/bar/ba\0", "/foo/bar/ba\0"),
+		  true,
+		  "equal, terminator in the last byte");
+	UNIT_TEST(ose_paddedStringsEqual("abc", "abd"),
+		  false,
+		  "differ in the only word");
+	UNIT_TEST(ose_paddedStringsEqual("/foo/bar/baz\0\0\0",
+					 "/foo/bar/bay\0\0\0"),
+		  false,
+		  "differ in the last word");
+	UNIT_TEST(ose_paddedStringsEqual("/foo/b\0", "/foo/ba"),
+		  false,
+		  "prefix, same number of words");
+	UNIT_TEST(ose_paddedStringsEqual("/foo\0\0\0", "/foo/bar\0\0\0"),
+		  false,
+		  "prefix of 4n characters");
+	UNIT_TEST(ose_paddedStringsEqual("/foo/bar\0\0\0", "/foo\0\0\0"),
+		  false,
+		  "prefix of 4n characters, the other way round");
+	UNIT_TEST(ose_paddedStringsEqual("/fo", "/foo\0\0\0"),
+		  false,
+		  "one character short of 4n");
+}
+
+void ut_ose_getFirstOffsetForPaddedMatch(void)
+{
+	UNIT_TEST_WITH_BUNDLE(S72 H S12 A1 Ti Di S20 A4 Ts Ds4 S12 A3 Tf Df,
+			      ose_getFirstOffsetForPaddedMatch(bundle, "/"),
+			      16,
+			      "first element");
+	UNIT_TEST_WITH_BUNDLE(S72 H S12 A1 Ti Di S20 A4 Ts Ds4 S12 A3 Tf Df,
+			      ose_getFirstOffsetForPaddedMatch(bundle, A4),
+			      32,
+			      "4n characters");
+	UNIT_TEST_WITH_BUNDLE(S72 H S12 A1 Ti Di S20 A4 Ts Ds4 S12 A3 Tf Df,
+			      ose_getFirstOffsetForPaddedMatch(bundle, A3),
+			      56,
+			      "prefix of an earlier element");
+	UNIT_TEST_WITH_BUNDLE(S72 H S12 A1 Ti Di S20 A4 Ts Ds4 S12 A3 Tf Df,
+			      ose_getFirstOffsetForPaddedMatch(bundle, A2),
+			      0,
+			      "prefix of the elements only");
+	UNIT_TEST_WITH_BUNDLE(S72 H S12 A1 Ti Di S20 A4 Ts Ds4 S12 A3 Tf Df,
+			      ose_getFirstOffsetForPaddedMatch(bundle, A5),
+			      0,
+			      "an element is a prefix of it");
+	UNIT_TEST_WITH_BUNDLE(S16 H,
+			      ose_getFirstOffsetForPaddedMatch(bundle, A4),
+			      0,
+			      "empty bundle");
+	UNIT_TEST_WITH_BUNDLE(S72 H S12 A1 Ti Di S20 A4 Ts Ds4 S12 A3 Tf Df,
+			      ose_getFirstOffsetForPaddedMatch(bundle, "/f\0o"),
+			      ASSERTION_FAILED,
+			      "not NULL-padded");
+}
+
 void ut_ose_getTypedDatumSize(void)
 {
 	for(int i = 0; i < 256; i++){
@@ -2212,6 +2290,172 @@ void ut_ose_writeMessage(void)
 			      "address length 4, blob length 0");
 }
 
+/* 1 to n * width, starting one byte past an aligned address */
+static char *fillSwapBuf(char *buf, int32_t n)
+{
+	char *p = align(buf) + 1;
+	for(int32_t i = 0; i < n; i++){
+		p[i] = (char)(i + 1);
+	}
+	return p;
+}
+
+/* 0 if each of the n words at p is ose_htonl of the word at q */
+static int32_t cmpSwapped32(const char *p, const char *q, int32_t n)
+{
+	for(int32_t i = 0; i < n; i++){
+		uint32_t a, b;
+		memcpy(&a, p + i * 4, 4);
+		memcpy(&b, q + i * 4, 4);
+		if(a != ose_htonl(b)){
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+/* 0 if each of the n words at p is ose_htonll of the word at q */
+static int32_t cmpSwapped64(const char *p, const char *q, int32_t n)
+{
+	for(int32_t i = 0; i < n; i++){
+		uint64_t a, b;
+		memcpy(&a, p + i * 8, 8);
+		memcpy(&b, q + i * 8, 8);
+		if(a != ose_htonll(b)){
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+void ut_ose_swapByteOrder32(void)
+{
+	char buf[32], orig[24];
+	char *p = fillSwapBuf(buf, 24);
+	memcpy(orig, p, 24);
+	UNIT_TEST((ose_swapByteOrder32(NULL, 1), 0),
+		  ASSERTION_FAILED,
+		  "NULL pointer");
+	UNIT_TEST((ose_swapByteOrder32(p, 0), memcmp(p, orig, 24)),
+		  0,
+		  "n = 0 leaves it alone");
+	UNIT_TEST((ose_swapByteOrder32(p, 5),
+		   cmpSwapped32(p, orig, 5)),
+		  0,
+		  "unaligned, n = 5, same as ose_htonl");
+	UNIT_TEST(memcmp(p + 20, orig + 20, 4),
+		  0,
+		  "nothing past n is touched");
+	UNIT_TEST((ose_swapByteOrder32(p, 5), memcmp(p, orig, 24)),
+		  0,
+		  "swapping twice is the identity");
+}
+
+void ut_ose_swapByteOrder64(void)
+{
+	char buf[40], orig[32];
+	char *p = fillSwapBuf(buf, 32);
+	memcpy(orig, p, 32);
+	UNIT_TEST((ose_swapByteOrder64(NULL, 1), 0),
+		  ASSERTION_FAILED,
+		  "NULL pointer");
+	UNIT_TEST((ose_swapByteOrder64(p, 0), memcmp(p, orig, 32)),
+		  0,
+		  "n = 0 leaves it alone");
+	UNIT_TEST((ose_swapByteOrder64(p, 3),
+		   cmpSwapped64(p, orig, 3)),
+		  0,
+		  "unaligned, n = 3, same as ose_htonll");
+	UNIT_TEST(memcmp(p + 24, orig + 24, 8),
+		  0,
+		  "nothing past n is touched");
+	UNIT_TEST((ose_swapByteOrder64(p, 3), memcmp(p, orig, 32)),
+		  0,
+		  "swapping twice is the identity");
+}
+
+/* /foo 1 "ab" <blob 1 2 3>, 32 bytes */
+#define VP_MSG "/foo\0\0\0\0" ",isb\0\0\0\0" "\0\0\0\x01" "ab\0\0" \
+	"\0\0\0\x03\x01\x02\x03\0"
+/* /foo 1, 16 bytes */
+#define VP_MSG16 "/foo\0\0\0\0" ",i\0\0" "\0\0\0\x01"
+#define VALIDATE(p) ose_validatePacket(p, sizeof(p) - 1)
+
+void ut_ose_validatePacket(void)
+{
+	UNIT_TEST(VALIDATE(VP_MSG), true, "message");
+	UNIT_TEST(VALIDATE(H S32 VP_MSG), true, "bundle");
+	UNIT_TEST(VALIDATE(H S52 H S32 VP_MSG), true, "nested bundle");
+	UNIT_TEST(VALIDATE(H), true, "empty bundle");
+	UNIT_TEST(ose_validatePacket(NULL, 16), false, "NULL packet");
+
+	UNIT_TEST(ose_validatePacket(VP_MSG, 31), false,
+		  "message size not a multiple of 4");
+	UNIT_TEST(VALIDATE(H "\0\0\0\x0e" VP_MSG16), false,
+		  "element size not a multiple of 4");
+	UNIT_TEST(VALIDATE(H S36 VP_MSG), false,
+		  "element larger than its bundle");
+	UNIT_TEST(VALIDATE(H S36 H S32 VP_MSG16 S16 VP_MSG16), false,
+		  "nested bundle element overruns its parent");
+
+	UNIT_TEST(VALIDATE("/fooabcd"), false,
+		  "unterminated address");
+	UNIT_TEST(VALIDATE("/f\0x" ",\0\0\0"), false,
+		  "address padded with a nonzero byte");
+	UNIT_TEST(VALIDATE("/foo\0\0\0\0" ",iii"), false,
+		  "unterminated typetag string");
+	UNIT_TEST(VALIDATE("/foo\0\0\0\0" ",i\0x" "\0\0\0\x01"), false,
+		  "typetag string padded with a nonzero byte");
+	UNIT_TEST(VALIDATE("/foo\0\0\0\0" ",Q\0\0" "\0\0\0\x01"), false,
+		  "unknown typetag");
+	UNIT_TEST(VALIDATE("/foo\0\0\0\0" ",i\0\0"), false,
+		  "typetag with no data");
+
+	UNIT_TEST(VALIDATE("/foo\0\0\0\0" ",b\0\0"
+			   "\0\0\0\x08\x01\x02\x03\x04"), false,
+		  "blob size past the end");
+	UNIT_TEST(VALIDATE("/foo\0\0\0\0" ",b\0\0"
+			   "\0\0\0\x03\x01\x02\x03\x04"), false,
+		  "blob padded with a nonzero byte");
+}
+
+/* inputs the packet to a new VM whose input has room for exactly
+   room more bytes */
+static int32_t inputPacketWithRoom(int32_t room,
+				   const char * const packet,
+				   int32_t size)
+{
+	static char buf[1 << 16];
+	ose_bundle osevm =
+		osevm_init(ose_newBundleFromCBytes(sizeof(buf), buf),
+			   4096, 4096, 4096, 4096, 4096, 4096);
+	ose_bundle vm_i = OSEVM_INPUT(osevm);
+	/* a blob of n bytes takes up 16 + n, for n a multiple of 4 */
+	ose_pushBlob(vm_i, ose_spaceAvailable(vm_i) - room - 16, NULL);
+	return osevm_inputPacket(osevm, size, packet);
+}
+
+void ut_osevm_inputPacket(void)
+{
+	UNIT_TEST(inputPacketWithRoom(60, VP_MSG, sizeof(VP_MSG) - 1),
+		  true,
+		  "message with just enough room");
+	UNIT_TEST(inputPacketWithRoom(56, VP_MSG, sizeof(VP_MSG) - 1),
+		  false,
+		  "message with 4 bytes too few");
+	UNIT_TEST(inputPacketWithRoom(92, H S32 VP_MSG,
+				      sizeof(H S32 VP_MSG) - 1),
+		  true,
+		  "bundle with just enough room");
+	UNIT_TEST(inputPacketWithRoom(88, H S32 VP_MSG,
+				      sizeof(H S32 VP_MSG) - 1),
+		  false,
+		  "bundle with 4 bytes too few");
+	UNIT_TEST(inputPacketWithRoom(1024, VP_MSG, 31),
+		  false,
+		  "malformed message");
+}
+
 int main(int ac, char **av)
 {
 	init();
@@ -2270,6 +2514,8 @@ int main(int ac, char **av)
 				"test not implemented yet");
 	SKIP_UNIT_TEST_FUNCTION(ose_getFirstOffsetForPMatch,
 				"test not implemented yet");
+	UNIT_TEST_FUNCTION(ose_paddedStringsEqual);
+	UNIT_TEST_FUNCTION(ose_getFirstOffsetForPaddedMatch);
 
 	UNIT_TEST_FUNCTION(ose_getTypedDatumSize);
 	UNIT_TEST_FUNCTION(ose_getPayloadItemSize);
@@ -2280,6 +2526,11 @@ int main(int ac, char **av)
 	SKIP_UNIT_TEST_FUNCTION(ose_vwriteMessage,
 				"wrapper for ose_vwriteMessage");
 	UNIT_TEST_FUNCTION(ose_writeMessage);
+
+	UNIT_TEST_FUNCTION(ose_swapByteOrder32);
+	UNIT_TEST_FUNCTION(ose_swapByteOrder64);
+	UNIT_TEST_FUNCTION(ose_validatePacket);
+	UNIT_TEST_FUNCTION(osevm_inputPacket);
 				
 
 	finalize();